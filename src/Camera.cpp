@@ -1,7 +1,14 @@
 #include "Camera.h"
-#include <GLFW/glfw3.h>
+#include "Physics/PhysicsWorld.h"
 #include <cmath>
 
+// Player body dimensions (width, height, depth) and eye height above the feet
+static const glm::vec3 PLAYER_SIZE(0.6f, 1.8f, 0.6f);
+static const float EYE_HEIGHT = 1.62f;
+
+// Upward speed of a jump (about 1.25 blocks high)
+static const float JUMP_VELOCITY = 8.4f;
+
 // Constructor
 Camera::Camera(float fov, float aspectRatio, float nearPlane, float farPlane)
     : m_position(0.0f, 0.0f, 0.0f),
@@ -17,9 +24,9 @@ Camera::Camera(float fov, float aspectRatio, float nearPlane, float farPlane)
       m_aspectRatio(aspectRatio),
       m_nearPlane(nearPlane),
       m_farPlane(farPlane),
-      m_lastMouseX(0.0),
-      m_lastMouseY(0.0),
-      m_firstMouse(true) {
+      m_physics(nullptr),
+      m_bodyId(0),
+      m_flying(true) {
     
     // Initialize view and projection matrices
     updateCameraVectors();
@@ -31,61 +38,94 @@ Camera::~Camera() {
 }
 
 // Update camera
-void Camera::update(GLFWwindow* window, float deltaTime) {
-    // Process keyboard input
-    float velocity = m_movementSpeed * deltaTime;
+void Camera::update(const CameraInput& input, float deltaTime) {
+    // Process look input
+    m_yaw += input.lookX * m_mouseSensitivity;
+    m_pitch += input.lookY * m_mouseSensitivity;
     
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        m_position += m_front * velocity;
-    }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        m_position -= m_front * velocity;
+    // Constrain pitch
+    if (m_pitch > 89.0f) {
+        m_pitch = 89.0f;
     }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        m_position -= m_right * velocity;
+    if (m_pitch < -89.0f) {
+        m_pitch = -89.0f;
     }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-        m_position += m_right * velocity;
+    
+    // Update camera vectors
+    updateCameraVectors();
+    
+    // Process movement input
+    if (input.toggleFlying) {
+        setFlying(!m_flying);
     }
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-        m_position += m_worldUp * velocity;
+    
+    if (m_physics) {
+        updateBody(input);
+    } else {
+        float velocity = m_movementSpeed * deltaTime;
+        m_position += m_front * (input.forward * velocity);
+        m_position += m_right * (input.strafe * velocity);
+        m_position += m_worldUp * (input.vertical * velocity);
     }
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-        m_position -= m_worldUp * velocity;
+}
+
+// Collide with the world through a physics body
+void Camera::setPhysics(PhysicsWorld* physics) {
+    if (m_physics) {
+        m_physics->destroyBody(m_bodyId);
     }
     
-    // Process mouse input
-    double mouseX, mouseY;
-    glfwGetCursorPos(window, &mouseX, &mouseY);
+    m_physics = physics;
     
-    if (m_firstMouse) {
-        m_lastMouseX = mouseX;
-        m_lastMouseY = mouseY;
-        m_firstMouse = false;
+    if (m_physics) {
+        m_bodyId = m_physics->createBody(m_position - glm::vec3(0.0f, EYE_HEIGHT, 0.0f), PLAYER_SIZE);
+        setFlying(m_flying);
+        syncToBody();
     }
+}
+
+// Move the camera to the eye of its physics body
+void Camera::syncToBody() {
+    if (m_physics) {
+        m_position = m_physics->getBody(m_bodyId).position + glm::vec3(0.0f, EYE_HEIGHT, 0.0f);
+    }
+}
+
+// Set whether the camera flies while driving a body
+void Camera::setFlying(bool flying) {
+    m_flying = flying;
     
-    double xOffset = mouseX - m_lastMouseX;
-    double yOffset = m_lastMouseY - mouseY; // Reversed since y-coordinates range from bottom to top
+    if (m_physics) {
+        PhysicsBody& body = m_physics->getBody(m_bodyId);
+        body.gravityScale = m_flying ? 0.0f : 1.0f;
+        body.velocity = glm::vec3(0.0f);
+    }
+}
+
+// Turn movement input into body velocity
+void Camera::updateBody(const CameraInput& input) {
+    PhysicsBody& body = m_physics->getBody(m_bodyId);
     
-    m_lastMouseX = mouseX;
-    m_lastMouseY = mouseY;
+    // Walk along the ground plane
+    glm::vec3 forward = glm::vec3(m_front.x, 0.0f, m_front.z);
+    if (glm::length(forward) > 0.0f) {
+        forward = glm::normalize(forward);
+    }
+    glm::vec3 right = glm::normalize(glm::cross(forward, m_worldUp));
     
-    xOffset *= m_mouseSensitivity;
-    yOffset *= m_mouseSensitivity;
+    glm::vec3 direction = forward * input.forward + right * input.strafe;
+    if (glm::length(direction) > 0.0f) {
+        direction = glm::normalize(direction);
+    }
     
-    m_yaw += static_cast<float>(xOffset);
-    m_pitch += static_cast<float>(yOffset);
+    body.velocity.x = direction.x * m_movementSpeed;
+    body.velocity.z = direction.z * m_movementSpeed;
     
-    // Constrain pitch
-    if (m_pitch > 89.0f) {
-        m_pitch = 89.0f;
+    if (m_flying) {
+        body.velocity.y = input.vertical * m_movementSpeed;
+    } else if (body.onGround && input.vertical > 0.0f) {
+        body.velocity.y = JUMP_VELOCITY;
     }
-    if (m_pitch < -89.0f) {
-        m_pitch = -89.0f;
-    }
-    
-    // Update camera vectors
-    updateCameraVectors();
 }
 
 // Get view matrix
@@ -115,6 +155,21 @@ void Camera::setRotation(float yaw, float pitch) {
     updateCameraVectors();
 }
 
+// Get camera position and rotation
+CameraPose Camera::getPose() const {
+    CameraPose pose;
+    pose.position = m_position;
+    pose.yaw = m_yaw;
+    pose.pitch = m_pitch;
+    return pose;
+}
+
+// Set camera position and rotation
+void Camera::setPose(const CameraPose& pose) {
+    m_position = pose.position;
+    setRotation(pose.yaw, pose.pitch);
+}
+
 // Update camera vectors
 void Camera::updateCameraVectors() {
     // Calculate the new front vector
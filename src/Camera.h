@@ -2,9 +2,27 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstdint>
 
 // Forward declarations
-struct GLFWwindow;
+class PhysicsWorld;
+
+// Camera position and orientation
+struct CameraPose {
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// Camera input sampled from the window
+struct CameraInput {
+    float forward;      // -1..1 (back / forward)
+    float strafe;       // -1..1 (left / right)
+    float vertical;     // -1..1 (down / up, up jumps when walking)
+    float lookX;        // Mouse movement since the last sample
+    float lookY;
+    bool toggleFlying;  // Fly toggle pressed since the last sample
+};
 
 // Camera class
 class Camera {
@@ -12,8 +30,20 @@ public:
     Camera(float fov, float aspectRatio, float nearPlane, float farPlane);
     ~Camera();
     
-    // Update camera
-    void update(GLFWwindow* window, float deltaTime);
+    // Update camera from input
+    void update(const CameraInput& input, float deltaTime);
+    
+    // Collide with the world through a player-sized body in physics instead of moving freely (null to detach)
+    void setPhysics(PhysicsWorld* physics);
+    
+    // Move the camera to the eye of its physics body (call after stepping physics)
+    void syncToBody();
+    
+    // Check if the camera flies (no gravity) while driving a body
+    bool isFlying() const { return m_flying; }
+    
+    // Set whether the camera flies while driving a body
+    void setFlying(bool flying);
     
     // Get view matrix
     glm::mat4 getViewMatrix() const;
@@ -39,6 +69,12 @@ public:
     // Set camera rotation
     void setRotation(float yaw, float pitch);
     
+    // Get camera position and rotation
+    CameraPose getPose() const;
+    
+    // Set camera position and rotation
+    void setPose(const CameraPose& pose);
+    
     // Get camera yaw
     float getYaw() const { return m_yaw; }
     
@@ -82,10 +118,13 @@ private:
     glm::mat4 m_viewMatrix;
     glm::mat4 m_projectionMatrix;
     
-    // Mouse position
-    double m_lastMouseX;
-    double m_lastMouseY;
-    bool m_firstMouse;
+    // Physics body driven by the camera
+    PhysicsWorld* m_physics;
+    uint32_t m_bodyId;
+    bool m_flying;
+    
+    // Turn movement input into body velocity
+    void updateBody(const CameraInput& input);
     
     // Update camera vectors
     void updateCameraVectors();
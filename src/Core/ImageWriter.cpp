@@ -0,0 +1,25 @@
+#include "ImageWriter.h"
+#include <fstream>
+#include <vector>
+
+// Write pixels as a binary PPM image
+bool ImageWriter::writePpm(const std::string& filename, const uint32_t* pixels, int width, int height, int stride) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; y++) {
+        const uint32_t* source = pixels + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < width; x++) {
+            row[x * 3 + 0] = static_cast<uint8_t>(source[x]);
+            row[x * 3 + 1] = static_cast<uint8_t>(source[x] >> 8);
+            row[x * 3 + 2] = static_cast<uint8_t>(source[x] >> 16);
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return static_cast<bool>(file);
+}
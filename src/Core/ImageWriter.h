@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Image writer class
+//
+// Writes RGBA8 pixels (R in the lowest byte) as binary PPM images, which any
+// image viewer opens without an image library. Alpha is dropped.
+class ImageWriter {
+public:
+    // Write width * height pixels with rows stride pixels apart, returns false on failure
+    static bool writePpm(const std::string& filename, const uint32_t* pixels, int width, int height, int stride);
+};
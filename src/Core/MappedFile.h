@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Mapped file class
+//
+// Maps a whole file read-only into memory, so it can be read in place without
+// copying it through stream buffers. Pages are loaded by the OS on first access
+// and stay shared with the page cache. The mapping is released on close or
+// destruction.
+class MappedFile {
+public:
+    // Constructor
+    MappedFile();
+
+    // Destructor
+    ~MappedFile();
+
+    // Delete copy constructor and assignment operator
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map a file, returns false if it does not exist, is empty or cannot be mapped
+    bool open(const std::string& filename);
+
+    // Unmap the file
+    void close();
+
+    // Check if a file is mapped
+    bool isOpen() const { return m_data != nullptr; }
+
+    // Get mapped bytes (page aligned)
+    const uint8_t* getData() const { return m_data; }
+
+    // Get file size
+    size_t getSize() const { return m_size; }
+
+private:
+    // Mapping
+    const uint8_t* m_data;
+    size_t m_size;
+};
@@ -0,0 +1,53 @@
+#include "MemoryUsage.h"
+#include <cstdio>
+#include <sys/resource.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <unistd.h>
+#endif
+
+// Get current resident memory
+size_t MemoryUsage::getCurrentResident() {
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return static_cast<size_t>(info.resident_size);
+#else
+    // Second field of statm is resident pages
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+
+    long pages = 0;
+    long resident = 0;
+    int read = std::fscanf(file, "%ld %ld", &pages, &resident);
+    std::fclose(file);
+
+    if (read != 2) {
+        return 0;
+    }
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Get peak resident memory
+size_t MemoryUsage::getPeakResident() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+#if defined(__APPLE__)
+    // Bytes on macOS
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // Kilobytes on Linux
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+// Process memory usage
+class MemoryUsage {
+public:
+    // Get current resident memory in bytes (0 if unavailable)
+    static size_t getCurrentResident();
+
+    // Get peak resident memory in bytes (0 if unavailable)
+    static size_t getPeakResident();
+};
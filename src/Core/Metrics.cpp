@@ -0,0 +1,210 @@
+#include "Metrics.h"
+#include "MemoryUsage.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+// Metric types
+enum class MetricType {
+    Counter,
+    Gauge,
+    Histogram
+};
+
+// Registered metric
+struct MetricEntry {
+    std::string name;
+    std::string help;
+    MetricType type;
+    std::unique_ptr<MetricCounter> counter;
+    std::unique_ptr<MetricGauge> gauge;
+    std::unique_ptr<MetricHistogram> histogram;
+};
+
+// Registry of all metrics
+struct MetricRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MetricEntry>> entries;
+};
+
+// Get the registry (created on first use, so metrics can be registered during static initialization)
+static MetricRegistry& getRegistry() {
+    static MetricRegistry registry;
+    return registry;
+}
+
+// Find a metric of the given type or add an empty one, registry must be locked
+static MetricEntry& findOrAddEntry(MetricRegistry& registry, const std::string& name, const std::string& help, MetricType type) {
+    for (const auto& entry : registry.entries) {
+        if (entry->name == name && entry->type == type) {
+            return *entry;
+        }
+    }
+
+    std::unique_ptr<MetricEntry> entry(new MetricEntry());
+    entry->name = name;
+    entry->help = help;
+    entry->type = type;
+    registry.entries.push_back(std::move(entry));
+    return *registry.entries.back();
+}
+
+// Add to an atomic double
+static void atomicAdd(std::atomic<double>& value, double amount) {
+    double current = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(current, current + amount, std::memory_order_relaxed)) {
+    }
+}
+
+// Add to the value
+void MetricGauge::add(double amount) {
+    atomicAdd(m_value, amount);
+}
+
+// Constructor
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds)
+    : m_bounds(bounds),
+      m_buckets(new std::atomic<uint64_t>[bounds.size() + 1]),
+      m_count(0),
+      m_sum(0.0) {
+    for (size_t i = 0; i <= m_bounds.size(); i++) {
+        m_buckets[i] = 0;
+    }
+}
+
+// Record a value
+void MetricHistogram::observe(double value) {
+    size_t bucket = 0;
+    while (bucket < m_bounds.size() && value > m_bounds[bucket]) {
+        bucket++;
+    }
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    atomicAdd(m_sum, value);
+}
+
+// Get or register a counter
+MetricCounter& Metrics::counter(const std::string& name, const std::string& help) {
+    MetricRegistry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    MetricEntry& entry = findOrAddEntry(registry, name, help, MetricType::Counter);
+    if (!entry.counter) {
+        entry.counter.reset(new MetricCounter());
+    }
+    return *entry.counter;
+}
+
+// Get or register a gauge
+MetricGauge& Metrics::gauge(const std::string& name, const std::string& help) {
+    MetricRegistry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    MetricEntry& entry = findOrAddEntry(registry, name, help, MetricType::Gauge);
+    if (!entry.gauge) {
+        entry.gauge.reset(new MetricGauge());
+    }
+    return *entry.gauge;
+}
+
+// Get or register a histogram
+MetricHistogram& Metrics::histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds) {
+    MetricRegistry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    MetricEntry& entry = findOrAddEntry(registry, name, help, MetricType::Histogram);
+    if (!entry.histogram) {
+        entry.histogram.reset(new MetricHistogram(bounds));
+    }
+    return *entry.histogram;
+}
+
+// Bucket bounds start, start * factor, ...
+std::vector<double> Metrics::exponentialBuckets(double start, double factor, int count) {
+    std::vector<double> bounds;
+    double bound = start;
+    for (int i = 0; i < count; i++) {
+        bounds.push_back(bound);
+        bound *= factor;
+    }
+    return bounds;
+}
+
+// Write all metrics in the Prometheus text format
+void Metrics::writePrometheus(std::ostream& out) {
+    // Process memory is sampled when writing
+    static MetricGauge& residentBytes = gauge("tomicz_process_resident_bytes", "Resident memory of the process");
+    static MetricGauge& peakResidentBytes = gauge("tomicz_process_peak_resident_bytes", "Peak resident memory of the process");
+    residentBytes.set(static_cast<double>(MemoryUsage::getCurrentResident()));
+    peakResidentBytes.set(static_cast<double>(MemoryUsage::getPeakResident()));
+
+    MetricRegistry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // Shortest exact-enough numbers, restoring the caller's formatting afterwards
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(10);
+    out.unsetf(std::ios::floatfield);
+
+    for (const auto& entry : registry.entries) {
+        const std::string& name = entry->name;
+        out << "# HELP " << name << " " << entry->help << "\n";
+
+        switch (entry->type) {
+            case MetricType::Counter:
+                out << "# TYPE " << name << " counter\n" << name << " " << entry->counter->get() << "\n";
+                break;
+
+            case MetricType::Gauge:
+                out << "# TYPE " << name << " gauge\n" << name << " " << entry->gauge->get() << "\n";
+                break;
+
+            case MetricType::Histogram: {
+                const MetricHistogram& histogram = *entry->histogram;
+                const std::vector<double>& bounds = histogram.getBounds();
+
+                // Prometheus buckets are cumulative
+                out << "# TYPE " << name << " histogram\n";
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < bounds.size(); i++) {
+                    cumulative += histogram.getBucketCount(i);
+                    out << name << "_bucket{le=\"" << bounds[i] << "\"} " << cumulative << "\n";
+                }
+                cumulative += histogram.getBucketCount(bounds.size());
+                out << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+                out << name << "_sum " << histogram.getSum() << "\n";
+                out << name << "_count " << histogram.getCount() << "\n";
+                break;
+            }
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Write a snapshot to a file or stdout
+bool Metrics::dump(const std::string& target) {
+    if (target == "-") {
+        writePrometheus(std::cout);
+        std::cout.flush();
+        return static_cast<bool>(std::cout);
+    }
+
+    // Write next to the target and rename, so readers never see a partial file
+    std::string temporary = target + ".tmp";
+    {
+        std::ofstream file(temporary);
+        if (!file) {
+            return false;
+        }
+        writePrometheus(file);
+        if (!file) {
+            return false;
+        }
+    }
+
+    return std::rename(temporary.c_str(), target.c_str()) == 0;
+}
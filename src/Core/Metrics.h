@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Monotonic counter
+class MetricCounter {
+public:
+    MetricCounter() : m_value(0) {}
+
+    // Add to the counter
+    void add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+
+    // Get current value
+    uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value;
+};
+
+// Value that goes up and down
+class MetricGauge {
+public:
+    MetricGauge() : m_value(0.0) {}
+
+    // Set the value
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+
+    // Add to the value (negative to subtract)
+    void add(double amount);
+
+    // Get current value
+    double get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value;
+};
+
+// Distribution of observed values over fixed buckets
+class MetricHistogram {
+public:
+    // Bucket upper bounds must increase, values above the last land in the +Inf bucket
+    explicit MetricHistogram(const std::vector<double>& bounds);
+
+    // Record a value
+    void observe(double value);
+
+    // Get bucket upper bounds
+    const std::vector<double>& getBounds() const { return m_bounds; }
+
+    // Get number of values in a bucket (bounds.size() is the +Inf bucket)
+    uint64_t getBucketCount(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+    // Get number of values
+    uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+
+    // Get sum of values
+    double getSum() const { return m_sum.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<double> m_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<double> m_sum;
+};
+
+// Metrics class
+//
+// Process-wide registry of named counters, gauges and histograms. Registering
+// takes a lock and returns a reference that stays valid for the life of the
+// process, so subsystems look their metrics up once and update them with plain
+// atomics afterwards. Snapshots are written in the Prometheus text format.
+class Metrics {
+public:
+    // Get or register a counter
+    static MetricCounter& counter(const std::string& name, const std::string& help);
+
+    // Get or register a gauge
+    static MetricGauge& gauge(const std::string& name, const std::string& help);
+
+    // Get or register a histogram (bounds are only used when registering)
+    static MetricHistogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds);
+
+    // Bucket bounds start, start * factor, ... (count bounds)
+    static std::vector<double> exponentialBuckets(double start, double factor, int count);
+
+    // Write all metrics in the Prometheus text format
+    static void writePrometheus(std::ostream& out);
+
+    // Write a snapshot to a file (replaced atomically) or stdout for "-", returns false on failure
+    static bool dump(const std::string& target);
+};
@@ -0,0 +1,147 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Profiler::s_enabled(false);
+
+// Recorded zone
+struct ProfileEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Zones of one thread
+struct ProfileThreadBuffer {
+    uint32_t threadId;
+    std::string threadName;
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<uint64_t> count;
+};
+
+// Buffers of all threads that recorded, kept after the threads exit so traces can be written later
+static std::mutex s_buffersMutex;
+static std::vector<std::unique_ptr<ProfileThreadBuffer>> s_buffers;
+
+// Buffer of the calling thread
+static thread_local ProfileThreadBuffer* t_buffer = nullptr;
+
+// Get the buffer of the calling thread, creating it on first use
+static ProfileThreadBuffer* getThreadBuffer() {
+    if (!t_buffer) {
+        std::unique_ptr<ProfileThreadBuffer> buffer(new ProfileThreadBuffer());
+        buffer->count = 0;
+
+        std::lock_guard<std::mutex> lock(s_buffersMutex);
+        buffer->threadId = static_cast<uint32_t>(s_buffers.size() + 1);
+        buffer->threadName = "Thread " + std::to_string(buffer->threadId);
+        t_buffer = buffer.get();
+        s_buffers.push_back(std::move(buffer));
+    }
+
+    return t_buffer;
+}
+
+// Enable or disable recording
+void Profiler::setEnabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// Name the calling thread in exported traces
+void Profiler::setThreadName(const char* name) {
+    ProfileThreadBuffer* buffer = getThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+    buffer->threadName = name;
+}
+
+// Get current time
+uint64_t Profiler::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Record a finished zone on the calling thread
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    ProfileThreadBuffer* buffer = getThreadBuffer();
+
+    // Events are allocated on the first zone, so named threads that never record cost nothing
+    if (!buffer->events) {
+        buffer->events.reset(new ProfileEvent[EVENTS_PER_THREAD]);
+    }
+
+    // Only this thread writes its buffer, the release store publishes the event to exporters
+    uint64_t count = buffer->count.load(std::memory_order_relaxed);
+    ProfileEvent& event = buffer->events[count % EVENTS_PER_THREAD];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+// Get number of zones recorded over all threads
+uint64_t Profiler::getRecordedCount() {
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+    uint64_t total = 0;
+    for (const auto& buffer : s_buffers) {
+        total += buffer->count.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+// Drop all recorded zones
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+    for (const auto& buffer : s_buffers) {
+        buffer->count.store(0, std::memory_order_release);
+    }
+}
+
+// Write recorded zones as Chrome trace JSON
+bool Profiler::writeChromeTrace(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+    // Timestamps relative to the earliest kept zone
+    uint64_t origin = std::numeric_limits<uint64_t>::max();
+    for (const auto& buffer : s_buffers) {
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t first = count > EVENTS_PER_THREAD ? count - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = first; i < count; i++) {
+            origin = std::min(origin, buffer->events[i % EVENTS_PER_THREAD].start);
+        }
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool firstEvent = true;
+    for (const auto& buffer : s_buffers) {
+        file << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+             << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+        firstEvent = false;
+
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t first = count > EVENTS_PER_THREAD ? count - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = first; i < count; i++) {
+            const ProfileEvent& event = buffer->events[i % EVENTS_PER_THREAD];
+            file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        }
+    }
+
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Profiler class
+//
+// Scoped CPU zones recorded into a fixed-size ring buffer per thread, so
+// recording takes no locks and never allocates. Zones nest by time, which the
+// Chrome trace viewer (chrome://tracing, Perfetto) shows as a hierarchy per
+// thread. Recording is off until enabled at runtime; building without
+// TOMICZ_PROFILER removes the zones from the code entirely.
+class Profiler {
+public:
+    // Zones kept per thread (older ones are overwritten)
+    static const size_t EVENTS_PER_THREAD = 1 << 16;
+
+    // Enable or disable recording
+    static void setEnabled(bool enabled);
+
+    // Check if recording is enabled
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Name the calling thread in exported traces
+    static void setThreadName(const char* name);
+
+    // Get current time (nanoseconds)
+    static uint64_t now();
+
+    // Record a finished zone on the calling thread (name must outlive the profiler)
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    // Get number of zones recorded over all threads, including overwritten ones
+    static uint64_t getRecordedCount();
+
+    // Drop all recorded zones (threads must not be recording)
+    static void clear();
+
+    // Write recorded zones as Chrome trace JSON, returns false on failure (threads should be idle)
+    static bool writeChromeTrace(const std::string& filename);
+
+private:
+    // Recording switch
+    static std::atomic<bool> s_enabled;
+};
+
+// Profile zone class
+//
+// Records the time from construction to destruction as a zone.
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : m_name(name),
+          m_start(Profiler::isEnabled() ? Profiler::now() : 0) {
+    }
+
+    ~ProfileZone() {
+        if (m_start != 0) {
+            Profiler::record(m_name, m_start, Profiler::now());
+        }
+    }
+
+    // Delete copy constructor and assignment operator
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_start;
+};
+
+#ifdef TOMICZ_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// Profile the rest of the enclosing scope as a zone (name must be a string literal)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
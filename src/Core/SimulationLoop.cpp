@@ -0,0 +1,229 @@
+#include "SimulationLoop.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include <algorithm>
+
+// Metrics reported by the simulation
+static MetricCounter& s_ticks = Metrics::counter("tomicz_ticks_total", "Simulation ticks run");
+static MetricHistogram& s_tickSeconds = Metrics::histogram("tomicz_tick_seconds",
+    "Time to run a simulation tick", Metrics::exponentialBuckets(0.0001, 2.0, 14));
+
+// Empty camera input
+static CameraInput emptyInput() {
+    CameraInput input;
+    input.forward = 0.0f;
+    input.strafe = 0.0f;
+    input.vertical = 0.0f;
+    input.lookX = 0.0f;
+    input.lookY = 0.0f;
+    input.toggleFlying = false;
+    return input;
+}
+
+// Constructor
+SimulationLoop::SimulationLoop(World* world, PhysicsWorld* physics, Camera* camera, int renderDistance, int tickRate)
+    : m_world(world),
+      m_physics(physics),
+      m_camera(camera),
+      m_renderDistance(renderDistance),
+      m_tickRate(std::max(tickRate, 1)),
+      m_recording(nullptr),
+      m_replay(nullptr),
+      m_replayFrame(0),
+      m_prefetching(true),
+      m_running(false),
+      m_tickCount(0),
+      m_pendingInput(emptyInput()),
+      m_currentSnapshot() {
+    publishSnapshot();
+    m_previousSnapshot = m_currentSnapshot;
+}
+
+// Destructor
+SimulationLoop::~SimulationLoop() {
+    stop();
+}
+
+// Start ticking on the simulation thread
+void SimulationLoop::start() {
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&SimulationLoop::run, this);
+}
+
+// Stop the simulation thread
+void SimulationLoop::stop() {
+    m_running = false;
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+// Run ticks on the calling thread as fast as possible
+void SimulationLoop::runHeadless(uint64_t ticks) {
+    for (uint64_t i = 0; i < ticks; i++) {
+        tick();
+    }
+}
+
+// Run a single tick
+void SimulationLoop::tick() {
+    PROFILE_ZONE("SimulationLoop::tick");
+
+    Clock::time_point start = Clock::now();
+    CameraInput input = takeInput();
+
+    {
+        std::lock_guard<std::mutex> lock(m_worldMutex);
+
+        if (m_replay) {
+            // Recorded poses replace input and the camera body, the last pose holds once the replay ends
+            size_t frameCount = m_replay->getFrameCount();
+            if (frameCount > 0) {
+                size_t frame = std::min<size_t>(m_replayFrame, frameCount - 1);
+                m_camera->setPose(m_replay->getFrame(frame));
+            }
+            if (m_replayFrame < frameCount) {
+                m_replayFrame++;
+            }
+
+            if (m_physics) {
+                m_physics->step();
+            }
+        } else {
+            m_camera->update(input, getTickDuration());
+
+            if (m_physics) {
+                m_physics->step();
+                m_camera->syncToBody();
+            }
+        }
+
+        m_world->updateChunks(m_camera->getPosition(), m_renderDistance, m_camera->getFront());
+
+        // Generate chunks along the predicted path in the spare worker time
+        if (m_prefetching) {
+            m_prefetcher.update(*m_camera, static_cast<double>(m_tickCount) / m_tickRate);
+            m_prefetcher.getPrefetchChunks(m_renderDistance, m_prefetchList);
+            m_world->prefetchChunks(m_prefetchList);
+        }
+
+        if (m_recording) {
+            m_recording->addFrame(m_camera->getPose());
+        }
+    }
+
+    m_tickCount++;
+    s_ticks.add();
+    s_tickSeconds.observe(std::chrono::duration<double>(Clock::now() - start).count());
+    publishSnapshot();
+}
+
+// Add input to apply on the next tick
+void SimulationLoop::submitInput(const CameraInput& input) {
+    std::lock_guard<std::mutex> lock(m_inputMutex);
+
+    m_pendingInput.forward = input.forward;
+    m_pendingInput.strafe = input.strafe;
+    m_pendingInput.vertical = input.vertical;
+    m_pendingInput.lookX += input.lookX;
+    m_pendingInput.lookY += input.lookY;
+    m_pendingInput.toggleFlying = m_pendingInput.toggleFlying != input.toggleFlying;
+}
+
+// Append the camera pose after every tick to recording
+void SimulationLoop::setRecording(CameraRecording* recording) {
+    std::lock_guard<std::mutex> lock(m_worldMutex);
+    m_recording = recording;
+}
+
+// Drive the camera from recorded poses instead of input
+void SimulationLoop::setReplay(const CameraRecording* replay) {
+    std::lock_guard<std::mutex> lock(m_worldMutex);
+    m_replay = replay;
+    m_replayFrame = 0;
+}
+
+// Check if a replay is set and all its frames have been played
+bool SimulationLoop::isReplayFinished() const {
+    return m_replay && m_replayFrame >= m_replay->getFrameCount();
+}
+
+// Enable or disable generating chunks ahead of the camera
+void SimulationLoop::setPrefetching(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_worldMutex);
+    m_prefetching = enabled;
+    m_prefetcher.reset();
+
+    // Cancels the prefetches still queued
+    if (!enabled) {
+        m_prefetchList.clear();
+        m_world->prefetchChunks(m_prefetchList);
+    }
+}
+
+// Get the state interpolated between the last two snapshots
+SimulationSnapshot SimulationLoop::getInterpolatedSnapshot() const {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+
+    // Draw one tick behind, blending towards the newest snapshot as the next tick approaches
+    float elapsed = std::chrono::duration<float>(Clock::now() - m_snapshotTime).count();
+    float alpha = std::min(elapsed * m_tickRate, 1.0f);
+
+    SimulationSnapshot snapshot;
+    snapshot.tick = m_currentSnapshot.tick;
+    snapshot.cameraPosition = glm::mix(m_previousSnapshot.cameraPosition, m_currentSnapshot.cameraPosition, alpha);
+    snapshot.cameraYaw = glm::mix(m_previousSnapshot.cameraYaw, m_currentSnapshot.cameraYaw, alpha);
+    snapshot.cameraPitch = glm::mix(m_previousSnapshot.cameraPitch, m_currentSnapshot.cameraPitch, alpha);
+    return snapshot;
+}
+
+// Take pending input
+CameraInput SimulationLoop::takeInput() {
+    std::lock_guard<std::mutex> lock(m_inputMutex);
+
+    CameraInput input = m_pendingInput;
+    m_pendingInput.lookX = 0.0f;
+    m_pendingInput.lookY = 0.0f;
+    m_pendingInput.toggleFlying = false;
+    return input;
+}
+
+// Publish a snapshot of the current state
+void SimulationLoop::publishSnapshot() {
+    SimulationSnapshot snapshot;
+    snapshot.tick = m_tickCount;
+    snapshot.cameraPosition = m_camera->getPosition();
+    snapshot.cameraYaw = m_camera->getYaw();
+    snapshot.cameraPitch = m_camera->getPitch();
+
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    m_previousSnapshot = m_currentSnapshot;
+    m_currentSnapshot = snapshot;
+    m_snapshotTime = Clock::now();
+}
+
+// Simulation thread entry point
+void SimulationLoop::run() {
+    Profiler::setThreadName("Simulation");
+
+    Clock::duration tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_tickRate));
+    Clock::time_point nextTick = Clock::now();
+
+    while (m_running) {
+        tick();
+        nextTick += tickDuration;
+
+        // Too far behind, start the schedule over instead of spiraling
+        Clock::time_point now = Clock::now();
+        if (now > nextTick + tickDuration * MAX_CATCH_UP_TICKS) {
+            nextTick = now;
+        }
+
+        std::this_thread::sleep_until(nextTick);
+    }
+}
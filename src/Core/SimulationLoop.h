@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Camera.h"
+#include "Voxel/World.h"
+#include "Voxel/ChunkPrefetcher.h"
+#include "Physics/PhysicsWorld.h"
+#include "Replay/CameraRecording.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Simulation state published after every tick
+struct SimulationSnapshot {
+    uint64_t tick;
+    glm::vec3 cameraPosition;
+    float cameraYaw;
+    float cameraPitch;
+};
+
+// Simulation loop class
+//
+// Runs the world at a fixed tick rate on its own thread: each tick applies the
+// input gathered since the last one to the camera, steps physics and streams
+// chunks around the camera, prefetching those along the predicted path, then
+// publishes a snapshot. The render thread draws
+// between the last two snapshots, so simulation throughput no longer depends on
+// frame rate. World access from other threads must hold the world mutex.
+class SimulationLoop {
+public:
+    // Default ticks per second
+    static const int DEFAULT_TICK_RATE = 60;
+
+    // Ticks run back to back before the schedule is reset (when the simulation falls behind)
+    static const int MAX_CATCH_UP_TICKS = 5;
+
+    SimulationLoop(World* world, PhysicsWorld* physics, Camera* camera, int renderDistance, int tickRate = DEFAULT_TICK_RATE);
+    ~SimulationLoop();
+
+    // Delete copy constructor and assignment operator
+    SimulationLoop(const SimulationLoop&) = delete;
+    SimulationLoop& operator=(const SimulationLoop&) = delete;
+
+    // Start ticking on the simulation thread
+    void start();
+
+    // Stop the simulation thread
+    void stop();
+
+    // Run ticks on the calling thread as fast as possible (headless soak testing)
+    void runHeadless(uint64_t ticks);
+
+    // Run a single tick
+    void tick();
+
+    // Add input to apply on the next tick (movement keeps the latest, look movement accumulates)
+    void submitInput(const CameraInput& input);
+
+    // Append the camera pose after every tick to recording (nullptr to stop)
+    void setRecording(CameraRecording* recording);
+
+    // Drive the camera from recorded poses instead of input (nullptr to stop)
+    void setReplay(const CameraRecording* replay);
+
+    // Check if a replay is set and all its frames have been played
+    bool isReplayFinished() const;
+
+    // Enable or disable generating chunks ahead of the camera (enabled by default)
+    void setPrefetching(bool enabled);
+
+    // Get the chunk prefetcher (settings may only change while the world mutex is held)
+    ChunkPrefetcher& getPrefetcher() { return m_prefetcher; }
+
+    // Get the state interpolated between the last two snapshots for the current time
+    SimulationSnapshot getInterpolatedSnapshot() const;
+
+    // Get the mutex guarding world access
+    std::mutex& getWorldMutex() { return m_worldMutex; }
+
+    // Get number of ticks run
+    uint64_t getTickCount() const { return m_tickCount.load(); }
+
+    // Get ticks per second
+    int getTickRate() const { return m_tickRate; }
+
+    // Get duration of a tick (seconds)
+    float getTickDuration() const { return 1.0f / m_tickRate; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Simulated objects
+    World* m_world;
+    PhysicsWorld* m_physics;
+    Camera* m_camera;
+    int m_renderDistance;
+    int m_tickRate;
+
+    // Recording being written and replay being played (owned by the caller)
+    CameraRecording* m_recording;
+    const CameraRecording* m_replay;
+    std::atomic<size_t> m_replayFrame;
+
+    // Prediction of chunks needed soon and the list reused between ticks
+    ChunkPrefetcher m_prefetcher;
+    bool m_prefetching;
+    std::vector<ChunkPosition> m_prefetchList;
+
+    // Simulation thread
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_tickCount;
+
+    // World access lock
+    std::mutex m_worldMutex;
+
+    // Input waiting for the next tick
+    mutable std::mutex m_inputMutex;
+    CameraInput m_pendingInput;
+
+    // Last two snapshots and when the newest was published
+    mutable std::mutex m_snapshotMutex;
+    SimulationSnapshot m_previousSnapshot;
+    SimulationSnapshot m_currentSnapshot;
+    Clock::time_point m_snapshotTime;
+
+    // Take pending input, clearing accumulated look movement and toggles
+    CameraInput takeInput();
+
+    // Publish a snapshot of the current state
+    void publishSnapshot();
+
+    // Simulation thread entry point
+    void run();
+};
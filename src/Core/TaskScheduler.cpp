@@ -0,0 +1,421 @@
+#include "TaskScheduler.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+// Metrics reported by the scheduler
+static MetricCounter& s_tasksExecuted = Metrics::counter("tomicz_tasks_executed_total", "Tasks run to completion");
+static MetricCounter& s_tasksCancelled = Metrics::counter("tomicz_tasks_cancelled_total", "Tasks skipped because they were cancelled");
+static MetricCounter& s_tasksStolen = Metrics::counter("tomicz_tasks_stolen_total", "Tasks taken from another worker's deque");
+static MetricCounter& s_taskMicroseconds = Metrics::counter("tomicz_task_run_microseconds_total",
+    "Time spent running tasks, divide its rate by the worker count for utilization");
+static MetricGauge& s_workers = Metrics::gauge("tomicz_task_workers", "Task scheduler worker threads");
+
+// Task states
+enum TaskState {
+    TASK_PENDING = 0,
+    TASK_RUNNING,
+    TASK_DONE,
+    TASK_CANCELLED
+};
+
+// Scheduled unit of work
+class Task {
+public:
+    std::function<void()> work;
+    TaskPriority priority;
+
+    // Owners: handles, plus the scheduler until the task has been executed
+    std::atomic<int> references;
+
+    // Dependencies not finished yet, plus one while the task is being submitted
+    std::atomic<int> unfinishedDependencies;
+
+    // TaskState
+    std::atomic<int> state;
+
+    // Set once the task ran or was skipped and its dependents were released
+    std::atomic<bool> finished;
+
+    // Tasks waiting for this one
+    std::mutex dependentsMutex;
+    std::vector<Task*> dependents;
+};
+
+// Add a reference
+static void retainTask(Task* task) {
+    task->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Drop a reference, deleting the task with the last one
+static void releaseTask(Task* task) {
+    if (task->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete task;
+    }
+}
+
+// Scheduler and worker index of the calling thread
+static thread_local TaskScheduler* t_scheduler = nullptr;
+static thread_local int t_workerIndex = -1;
+
+// Victim selection for threads that are not workers
+static thread_local uint32_t t_random = 0x9E3779B9u;
+
+// Next xorshift random number
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Constructor
+TaskHandle::TaskHandle()
+    : m_task(nullptr) {
+}
+
+// Constructor
+TaskHandle::TaskHandle(Task* task)
+    : m_task(task) {
+    if (m_task) {
+        retainTask(m_task);
+    }
+}
+
+// Copy constructor
+TaskHandle::TaskHandle(const TaskHandle& other)
+    : m_task(other.m_task) {
+    if (m_task) {
+        retainTask(m_task);
+    }
+}
+
+// Assignment operator
+TaskHandle& TaskHandle::operator=(const TaskHandle& other) {
+    if (other.m_task) {
+        retainTask(other.m_task);
+    }
+    if (m_task) {
+        releaseTask(m_task);
+    }
+    m_task = other.m_task;
+    return *this;
+}
+
+// Destructor
+TaskHandle::~TaskHandle() {
+    if (m_task) {
+        releaseTask(m_task);
+    }
+}
+
+// Check if the task finished
+bool TaskHandle::isFinished() const {
+    return m_task && m_task->finished.load(std::memory_order_acquire);
+}
+
+// Check if the task was cancelled
+bool TaskHandle::isCancelled() const {
+    return m_task && m_task->state.load(std::memory_order_acquire) == TASK_CANCELLED;
+}
+
+// Cancel the task if it has not started
+void TaskHandle::cancel() {
+    if (m_task) {
+        int expected = TASK_PENDING;
+        m_task->state.compare_exchange_strong(expected, TASK_CANCELLED, std::memory_order_acq_rel);
+    }
+}
+
+// Constructor
+TaskScheduler::TaskScheduler(int workerCount)
+    : m_running(true),
+      m_injected(0),
+      m_sleeping(0),
+      m_queued(0) {
+    if (workerCount <= 0) {
+        workerCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+    }
+
+    for (int i = 0; i < workerCount; i++) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->random = 0x9E3779B9u * static_cast<uint32_t>(i + 1);
+        m_workers.push_back(std::move(worker));
+    }
+
+    // Deques must all exist before any worker tries to steal
+    for (int i = 0; i < workerCount; i++) {
+        m_workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+
+    s_workers.add(workerCount);
+}
+
+// Destructor
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_running = false;
+    }
+    m_sleepCondition.notify_all();
+
+    for (const auto& worker : m_workers) {
+        worker->thread.join();
+    }
+
+    // Drop tasks that never ran
+    for (const auto& worker : m_workers) {
+        for (WorkStealingDeque<Task>& deque : worker->deques) {
+            while (Task* task = deque.steal()) {
+                releaseTask(task);
+            }
+        }
+    }
+    for (std::deque<Task*>& queue : m_injection) {
+        for (Task* task : queue) {
+            releaseTask(task);
+        }
+    }
+
+    s_workers.add(-static_cast<double>(m_workers.size()));
+}
+
+// Submit a task
+TaskHandle TaskScheduler::submit(std::function<void()> work, TaskPriority priority) {
+    return submit(std::move(work), priority, std::vector<TaskHandle>());
+}
+
+// Submit a task that runs after all dependencies finished
+TaskHandle TaskScheduler::submit(std::function<void()> work, TaskPriority priority, const std::vector<TaskHandle>& dependencies) {
+    Task* task = new Task();
+    task->work = std::move(work);
+    task->priority = priority;
+    task->references = 1;
+    task->unfinishedDependencies = 1;
+    task->state = TASK_PENDING;
+    task->finished = false;
+
+    TaskHandle handle(task);
+
+    // Register with unfinished dependencies, they schedule the task when the last one finishes
+    for (const TaskHandle& dependency : dependencies) {
+        Task* other = dependency.get();
+        if (!other) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(other->dependentsMutex);
+        if (!other->finished.load(std::memory_order_acquire)) {
+            other->dependents.push_back(task);
+            task->unfinishedDependencies.fetch_add(1, std::memory_order_relaxed);
+        } else if (other->state.load(std::memory_order_acquire) == TASK_CANCELLED) {
+            handle.cancel();
+        }
+    }
+
+    if (task->unfinishedDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(task);
+    }
+    return handle;
+}
+
+// Wait for a task
+void TaskScheduler::wait(const TaskHandle& task) {
+    if (!task.isValid()) {
+        return;
+    }
+
+    // Lower priority work could take much longer than the task being waited for
+    TaskPriority lowestPriority = task.get()->priority;
+
+    while (!task.isFinished()) {
+        if (!runOne(lowestPriority)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Wait for all tasks
+void TaskScheduler::wait(const std::vector<TaskHandle>& tasks) {
+    for (const TaskHandle& task : tasks) {
+        wait(task);
+    }
+}
+
+// Run body(i) for i in [0, count) across the workers and wait
+void TaskScheduler::parallelFor(size_t count, size_t grain, const std::function<void(size_t)>& body, TaskPriority priority) {
+    grain = std::max<size_t>(grain, 1);
+
+    if (count <= grain) {
+        for (size_t i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    std::vector<TaskHandle> batches;
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(begin + grain, count);
+        batches.push_back(submit([&body, begin, end]() {
+            for (size_t i = begin; i < end; i++) {
+                body(i);
+            }
+        }, priority));
+    }
+
+    wait(batches);
+}
+
+// Queue a task whose dependencies finished
+void TaskScheduler::schedule(Task* task) {
+    // The scheduler owns a reference until the task has been executed
+    retainTask(task);
+    m_queued.fetch_add(1);
+
+    int priority = static_cast<int>(task->priority);
+    if (t_scheduler == this && t_workerIndex >= 0) {
+        m_workers[t_workerIndex]->deques[priority].push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(m_injectionMutex);
+        m_injection[priority].push_back(task);
+        m_injected.fetch_add(1, std::memory_order_release);
+    }
+
+    // Ordered after the queued count, a worker going to sleep sees either the count or this wakeup
+    if (m_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.notify_one();
+    }
+}
+
+// Take the next task
+Task* TaskScheduler::findTask(int workerIndex, TaskPriority lowestPriority) {
+    if (m_queued.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+
+    uint32_t& random = workerIndex >= 0 ? m_workers[workerIndex]->random : t_random;
+    int workerCount = static_cast<int>(m_workers.size());
+
+    for (int priority = 0; priority <= static_cast<int>(lowestPriority); priority++) {
+        Task* task = nullptr;
+
+        // Own deque first, newest task (its data is likely still in cache)
+        if (workerIndex >= 0) {
+            task = m_workers[workerIndex]->deques[priority].pop();
+        }
+
+        // Then tasks submitted from outside, oldest first
+        if (!task && m_injected.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(m_injectionMutex);
+            if (!m_injection[priority].empty()) {
+                task = m_injection[priority].front();
+                m_injection[priority].pop_front();
+                m_injected.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Then the oldest task of another worker, starting at a random one
+        if (!task) {
+            int start = static_cast<int>(nextRandom(random) % static_cast<uint32_t>(workerCount));
+            for (int i = 0; i < workerCount && !task; i++) {
+                int victim = (start + i) % workerCount;
+                if (victim != workerIndex) {
+                    task = m_workers[victim]->deques[priority].steal();
+                }
+            }
+            if (task) {
+                s_tasksStolen.add();
+            }
+        }
+
+        if (task) {
+            m_queued.fetch_sub(1);
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+// Run a task and release its dependents
+void TaskScheduler::execute(Task* task) {
+    int expected = TASK_PENDING;
+    if (task->state.compare_exchange_strong(expected, TASK_RUNNING, std::memory_order_acq_rel)) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        task->work();
+        s_taskMicroseconds.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+        s_tasksExecuted.add();
+        task->state.store(TASK_DONE, std::memory_order_release);
+    } else {
+        s_tasksCancelled.add();
+    }
+
+    // Free captured state now rather than when the last handle goes away
+    task->work = nullptr;
+    bool cancelled = task->state.load(std::memory_order_acquire) == TASK_CANCELLED;
+
+    std::vector<Task*> dependents;
+    {
+        std::lock_guard<std::mutex> lock(task->dependentsMutex);
+        dependents.swap(task->dependents);
+        task->finished.store(true, std::memory_order_release);
+    }
+
+    for (Task* dependent : dependents) {
+        if (cancelled) {
+            int pending = TASK_PENDING;
+            dependent->state.compare_exchange_strong(pending, TASK_CANCELLED, std::memory_order_acq_rel);
+        }
+        if (dependent->unfinishedDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(dependent);
+        }
+    }
+
+    releaseTask(task);
+}
+
+// Run one task if any is available
+bool TaskScheduler::runOne(TaskPriority lowestPriority) {
+    Task* task = findTask(t_scheduler == this ? t_workerIndex : -1, lowestPriority);
+    if (!task) {
+        return false;
+    }
+
+    execute(task);
+    return true;
+}
+
+// Worker thread entry point
+void TaskScheduler::workerLoop(int workerIndex) {
+    t_scheduler = this;
+    t_workerIndex = workerIndex;
+
+    std::string name = "Worker " + std::to_string(workerIndex + 1);
+    Profiler::setThreadName(name.c_str());
+
+    int idleRounds = 0;
+    while (m_running.load(std::memory_order_relaxed)) {
+        if (runOne(TaskPriority::Low)) {
+            idleRounds = 0;
+            continue;
+        }
+
+        // Spin briefly, new work often follows soon
+        if (++idleRounds < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleeping.fetch_add(1);
+        while (m_running && m_queued.load() == 0) {
+            m_sleepCondition.wait(lock);
+        }
+        m_sleeping.fetch_sub(1);
+        idleRounds = 0;
+    }
+}
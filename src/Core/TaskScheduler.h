@@ -0,0 +1,132 @@
+#pragma once
+
+#include "WorkStealingDeque.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Task;
+
+// Task priorities, higher ones are always taken first
+enum class TaskPriority {
+    High = 0,
+    Normal,
+    Low,
+    Count
+};
+
+// Task handle class
+//
+// Shared reference to a submitted task; the task lives as long as any handle
+// or the scheduler refers to it.
+class TaskHandle {
+public:
+    TaskHandle();
+    explicit TaskHandle(Task* task);
+    TaskHandle(const TaskHandle& other);
+    TaskHandle& operator=(const TaskHandle& other);
+    ~TaskHandle();
+
+    // Check if the handle refers to a task
+    bool isValid() const { return m_task != nullptr; }
+
+    // Check if the task finished (ran, or was cancelled)
+    bool isFinished() const;
+
+    // Check if the task was cancelled
+    bool isCancelled() const;
+
+    // Cancel the task if it has not started; tasks depending on it are cancelled too
+    void cancel();
+
+    // Get the task
+    Task* get() const { return m_task; }
+
+private:
+    Task* m_task;
+};
+
+// Task scheduler class
+//
+// Work-stealing thread pool shared by all engine subsystems. Each worker owns a
+// Chase-Lev deque per priority: tasks spawned on a worker go to its own deque
+// and idle workers steal from the others, so nested work spreads out without a
+// shared queue. Tasks submitted from other threads go through an injection
+// queue. Tasks can depend on other tasks and only run once those finished;
+// cancelling a task that has not started skips it and its dependents.
+class TaskScheduler {
+public:
+    // Idle rounds a worker spins before sleeping
+    static const int SPIN_ROUNDS = 64;
+
+    // Start workers (0 = one per hardware thread, minus the calling thread)
+    explicit TaskScheduler(int workerCount = 0);
+    ~TaskScheduler();
+
+    // Delete copy constructor and assignment operator
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Submit a task
+    TaskHandle submit(std::function<void()> work, TaskPriority priority = TaskPriority::Normal);
+
+    // Submit a task that runs after all dependencies finished (skipped if any was cancelled)
+    TaskHandle submit(std::function<void()> work, TaskPriority priority, const std::vector<TaskHandle>& dependencies);
+
+    // Wait for a task, running other tasks of the same or higher priority meanwhile
+    void wait(const TaskHandle& task);
+
+    // Wait for all tasks, running other tasks of the same or higher priority meanwhile
+    void wait(const std::vector<TaskHandle>& tasks);
+
+    // Run body(i) for i in [0, count) across the workers and wait, in batches of at least grain items
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t)>& body,
+                     TaskPriority priority = TaskPriority::Normal);
+
+    // Get number of worker threads
+    int getWorkerCount() const { return static_cast<int>(m_workers.size()); }
+
+private:
+    // Per-worker state
+    struct Worker {
+        std::thread thread;
+        WorkStealingDeque<Task> deques[static_cast<int>(TaskPriority::Count)];
+        uint32_t random;
+    };
+
+    // Workers
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_running;
+
+    // Tasks submitted from threads that are not workers
+    std::mutex m_injectionMutex;
+    std::deque<Task*> m_injection[static_cast<int>(TaskPriority::Count)];
+    std::atomic<int> m_injected;
+
+    // Sleeping workers and tasks waiting in any queue
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    std::atomic<int> m_sleeping;
+    std::atomic<int> m_queued;
+
+    // Queue a task whose dependencies finished
+    void schedule(Task* task);
+
+    // Take the next task of at most lowestPriority for a worker (-1 for other threads), nullptr if none
+    Task* findTask(int workerIndex, TaskPriority lowestPriority);
+
+    // Run a task and release its dependents
+    void execute(Task* task);
+
+    // Run one task of at most lowestPriority if any is available, returns false if none was found
+    bool runOne(TaskPriority lowestPriority);
+
+    // Worker thread entry point
+    void workerLoop(int workerIndex);
+};
@@ -0,0 +1,51 @@
+#include "TimingStats.h"
+#include <algorithm>
+#include <cmath>
+
+// Constructor
+TimingStats::TimingStats()
+    : m_sortedValid(true), m_total(0.0) {
+}
+
+// Add a sample
+void TimingStats::add(double milliseconds) {
+    m_samples.push_back(milliseconds);
+    m_total += milliseconds;
+    m_sortedValid = false;
+}
+
+// Remove all samples
+void TimingStats::clear() {
+    m_samples.clear();
+    m_sorted.clear();
+    m_sortedValid = true;
+    m_total = 0.0;
+}
+
+// Get mean sample
+double TimingStats::getMean() const {
+    return m_samples.empty() ? 0.0 : m_total / m_samples.size();
+}
+
+// Get largest sample
+double TimingStats::getMax() const {
+    return m_samples.empty() ? 0.0 : *std::max_element(m_samples.begin(), m_samples.end());
+}
+
+// Get the sample at percentile
+double TimingStats::getPercentile(double percentile) const {
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+
+    if (!m_sortedValid) {
+        m_sorted = m_samples;
+        std::sort(m_sorted.begin(), m_sorted.end());
+        m_sortedValid = true;
+    }
+
+    // Nearest rank
+    double rank = std::ceil(percentile / 100.0 * m_sorted.size());
+    size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    return m_sorted[std::min(index, m_sorted.size() - 1)];
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Timing statistics class
+//
+// Collects duration samples (milliseconds) and reports percentiles over all of them.
+class TimingStats {
+public:
+    TimingStats();
+
+    // Add a sample
+    void add(double milliseconds);
+
+    // Remove all samples
+    void clear();
+
+    // Get number of samples
+    size_t getCount() const { return m_samples.size(); }
+
+    // Get sum of all samples
+    double getTotal() const { return m_total; }
+
+    // Get mean sample (0 without samples)
+    double getMean() const;
+
+    // Get largest sample (0 without samples)
+    double getMax() const;
+
+    // Get the sample at percentile (0-100, nearest rank; 0 without samples)
+    double getPercentile(double percentile) const;
+
+private:
+    // Samples in insertion order
+    std::vector<double> m_samples;
+
+    // Sorted copy, rebuilt when samples changed
+    mutable std::vector<double> m_sorted;
+    mutable bool m_sortedValid;
+
+    // Sum of samples
+    double m_total;
+};
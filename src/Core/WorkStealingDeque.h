@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Work-stealing deque class
+//
+// Chase-Lev deque of pointers (Le et al., "Correct and Efficient Work-Stealing
+// for Weak Memory Models"). The owning thread pushes and pops at the bottom
+// without contention; any other thread steals from the top. The ring grows when
+// full; replaced rings are kept until destruction because thieves may still be
+// reading them.
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256)
+        : m_top(0),
+          m_bottom(0) {
+        m_rings.emplace_back(new Ring(capacity));
+        m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    // Delete copy constructor and assignment operator
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Push at the bottom (owner thread only)
+    void push(T* item) {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_acquire);
+        Ring* ring = m_ring.load(std::memory_order_relaxed);
+
+        if (bottom - top > ring->capacity - 1) {
+            ring = grow(ring, top, bottom);
+        }
+
+        ring->put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    // Pop from the bottom (owner thread only), nullptr if empty
+    T* pop() {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Ring* ring = m_ring.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = ring->get(bottom);
+        if (top == bottom) {
+            // Last item, race thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Steal from the top (any thread), nullptr if empty or another thread won the race
+    T* steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Ring* ring = m_ring.load(std::memory_order_acquire);
+        T* item = ring->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // Check if empty (approximate while other threads are active)
+    bool isEmpty() const {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Ring buffer of item slots
+    struct Ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+
+        explicit Ring(int64_t size) : capacity(size), slots(new std::atomic<T*>[size]) {}
+
+        T* get(int64_t index) const { return slots[index & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t index, T* item) { slots[index & (capacity - 1)].store(item, std::memory_order_relaxed); }
+    };
+
+    // Replace the ring with one twice the size (owner thread only)
+    Ring* grow(Ring* ring, int64_t top, int64_t bottom) {
+        Ring* larger = new Ring(ring->capacity * 2);
+        for (int64_t i = top; i < bottom; i++) {
+            larger->put(i, ring->get(i));
+        }
+
+        m_rings.emplace_back(larger);
+        m_ring.store(larger, std::memory_order_release);
+        return larger;
+    }
+
+    // Indices of the oldest and one past the newest item
+    std::atomic<int64_t> m_top;
+    std::atomic<int64_t> m_bottom;
+
+    // Current ring (capacity is a power of two)
+    std::atomic<Ring*> m_ring;
+
+    // All rings ever used, freed with the deque
+    std::vector<std::unique_ptr<Ring>> m_rings;
+};
@@ -0,0 +1,778 @@
+#include "Benchmarks.h"
+#include "Core/Metrics.h"
+#include "Core/Profiler.h"
+#include "Core/TaskScheduler.h"
+#include "Core/TimingStats.h"
+#include "Renderer/MeshHeap.h"
+#include "Renderer/RecordingRenderBackend.h"
+#include "Renderer/SoftwareRenderBackend.h"
+#include "Voxel/ChunkMesher.h"
+#include "Voxel/LightEngine.h"
+#include "Voxel/SpawnSnapshot.h"
+#include "Voxel/VoxelRenderer.h"
+#include "Voxel/World.h"
+#include "Voxel/WorldMap.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// Milliseconds since start
+static double elapsedMs(const Clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Print count, mean and percentiles of a timing
+static void printStats(const std::string& name, const TimingStats& stats) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "  " << std::left << std::setw(24) << name << std::right
+              << " n " << std::setw(7) << stats.getCount()
+              << "  mean " << std::setw(8) << stats.getMean()
+              << "  p50 " << std::setw(8) << stats.getPercentile(50.0)
+              << "  p99 " << std::setw(8) << stats.getPercentile(99.0)
+              << "  max " << std::setw(8) << stats.getMax() << " ms" << std::endl;
+}
+
+// Time a block edit
+static void timedSetBlock(World& world, int x, int y, int z, BlockType type, TimingStats& stats) {
+    Clock::time_point start = Clock::now();
+    world.setBlock(x, y, z, type);
+    stats.add(elapsedMs(start));
+}
+
+// Fly along -z streaming and meshing chunks like a headless run, returns milliseconds
+static double runStreamingWorkload(int renderDistance, int ticks) {
+    World world;
+    std::vector<Chunk*> dirtyChunks;
+
+    Clock::time_point start = Clock::now();
+    for (int tick = 0; tick < ticks; tick++) {
+        glm::vec3 position(8.0f, 100.0f, 8.0f - tick * (20.0f / 60.0f));
+        world.updateChunks(position, renderDistance);
+
+        world.getDirtyChunks(position, 8, dirtyChunks);
+        for (Chunk* chunk : dirtyChunks) {
+            chunk->generateMesh();
+        }
+    }
+    return elapsedMs(start);
+}
+
+// Spawn a binary tree of tasks below the current one, each waiting for its children
+static void spawnTree(TaskScheduler& scheduler, int depth) {
+    if (depth == 0) {
+        return;
+    }
+
+    TaskHandle left = scheduler.submit([&scheduler, depth]() { spawnTree(scheduler, depth - 1); });
+    TaskHandle right = scheduler.submit([&scheduler, depth]() { spawnTree(scheduler, depth - 1); });
+    scheduler.wait(left);
+    scheduler.wait(right);
+}
+
+// Arithmetic the optimizer cannot remove, roughly iterations nanoseconds
+static uint32_t busyWork(uint32_t seed, int iterations) {
+    for (int i = 0; i < iterations; i++) {
+        seed = seed * 1664525u + 1013904223u;
+    }
+    return seed;
+}
+
+// Full chunk remeshing with and without ambient occlusion
+void Benchmarks::runMesh(int renderDistance, int repeats) {
+    World world;
+    world.updateChunks(glm::vec3(8.0f, 100.0f, 8.0f), renderDistance);
+
+    std::cout << "Mesh benchmark: " << world.getChunks().size() << " chunks x " << repeats << std::endl;
+
+    bool ambientOcclusion = ChunkMesher::isAmbientOcclusionEnabled();
+    const bool modes[2] = {true, false};
+
+    for (bool enabled : modes) {
+        ChunkMesher::setAmbientOcclusion(enabled);
+
+        TimingStats stats;
+        size_t quads = 0;
+
+        for (int repeat = 0; repeat < repeats; repeat++) {
+            for (const auto& pair : world.getChunks()) {
+                Chunk* chunk = pair.second;
+                chunk->setDirty(true);
+
+                Clock::time_point start = Clock::now();
+                chunk->generateMesh();
+                stats.add(elapsedMs(start));
+
+                for (int section = 0; section < CHUNK_SECTIONS; section++) {
+                    quads += chunk->getQuadCount(section);
+                }
+            }
+        }
+
+        printStats(enabled ? "chunk mesh (AO on)" : "chunk mesh (AO off)", stats);
+        std::cout << "  " << std::setprecision(0) << quads / std::max<size_t>(stats.getCount(), 1) << " quads/chunk, "
+                  << stats.getCount() * 1000.0 / std::max(stats.getTotal(), 1e-9) << " chunks/s" << std::endl;
+    }
+
+    ChunkMesher::setAmbientOcclusion(ambientOcclusion);
+
+    // Worst case: transparent blocks emit faces against each other, the mesh must fit the shared quad indices
+    const BlockType transparentTypes[2] = {BlockType::Leaves, BlockType::Water};
+    for (BlockType type : transparentTypes) {
+        Chunk chunk(0, 0);
+        for (int y = 0; y < SECTION_HEIGHT; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    chunk.setBlock(x, y, z, type);
+                }
+            }
+        }
+
+        Clock::time_point start = Clock::now();
+        chunk.generateMesh();
+        double ms = elapsedMs(start);
+
+        uint32_t quads = chunk.getQuadCount(0);
+        std::cout << "  full " << Block::getName(type) << " section: " << quads << " quads in " << std::setprecision(3) << ms << " ms, "
+                  << (quads <= static_cast<uint32_t>(MAX_SECTION_QUADS) ? "fits" : "EXCEEDS") << " the " << MAX_SECTION_QUADS
+                  << " quad index pattern" << std::endl;
+    }
+}
+
+// Count chunks whose light differs from lighting the same blocks from scratch
+static size_t countLightMismatches(const World& world) {
+    World reference;
+    LightEngine lightEngine;
+    std::vector<BlockType> blocks(CHUNK_VOLUME);
+    std::vector<uint8_t> dark(CHUNK_VOLUME, 0);
+
+    // Copy the blocks into fresh chunks and light them the way generated chunks are
+    for (const auto& pair : world.getChunks()) {
+        Chunk* chunk = new Chunk(pair.first.x, pair.first.z);
+        pair.second->copyBlocks(blocks.data());
+        chunk->restoreTerrain(blocks.data(), dark.data());
+        lightEngine.lightChunk(chunk);
+        reference.addRestoredChunk(chunk);
+        lightEngine.linkChunk(chunk);
+    }
+
+    size_t mismatches = 0;
+    for (const auto& pair : world.getChunks()) {
+        const Chunk* chunk = reference.findChunk(pair.first.x, pair.first.z);
+        if (std::memcmp(pair.second->getLightData(), chunk->getLightData(), CHUNK_VOLUME) != 0) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Check the light of a world against lighting it from scratch, printing the result
+static bool checkLight(const World& world, const std::string& phase) {
+    size_t mismatches = countLightMismatches(world);
+    std::cout << "  light after " << phase << " " << (mismatches == 0 ? "matches" : "DOES NOT match") << " lighting from scratch";
+    if (mismatches > 0) {
+        std::cout << " (" << mismatches << " of " << world.getChunks().size() << " chunks differ)";
+    }
+    std::cout << std::endl;
+    return mismatches == 0;
+}
+
+// Block edit latency while digging and lighting a large cave
+bool Benchmarks::runLight() {
+    World world;
+    world.updateChunks(glm::vec3(0.0f, 100.0f, 0.0f), 2);
+
+    // Sealed cave spanning four chunks, well below the surface
+    const int minX = -16, maxX = 16, minZ = -16, maxZ = 16, minY = 20, maxY = 36;
+
+    std::cout << "Light benchmark: " << (maxX - minX) << "x" << (maxY - minY) << "x" << (maxZ - minZ) << " cave" << std::endl;
+
+    // Solid rock around the cave, whatever the terrain looks like
+    const int rockTop = 64;
+    for (int y = 0; y < rockTop; y++) {
+        for (int z = minZ - 2; z < maxZ + 2; z++) {
+            for (int x = minX - 2; x < maxX + 2; x++) {
+                world.setBlock(x, y, z, BlockType::Stone);
+            }
+        }
+    }
+
+    TimingStats dig;
+    for (int y = maxY - 1; y >= minY; y--) {
+        for (int z = minZ; z < maxZ; z++) {
+            for (int x = minX; x < maxX; x++) {
+                timedSetBlock(world, x, y, z, BlockType::Air, dig);
+            }
+        }
+    }
+    printStats("dig cave", dig);
+    bool matches = checkLight(world, "digging");
+
+    // Light the cave with a grid of glowstone on the floor, then take it away again
+    TimingStats place;
+    TimingStats remove;
+    for (int z = minZ; z < maxZ; z += 4) {
+        for (int x = minX; x < maxX; x += 4) {
+            timedSetBlock(world, x, minY, z, BlockType::Glowstone, place);
+        }
+    }
+    printStats("place glowstone", place);
+    matches = checkLight(world, "placing glowstone") && matches;
+
+    for (int z = minZ; z < maxZ; z += 4) {
+        for (int x = minX; x < maxX; x += 4) {
+            timedSetBlock(world, x, minY, z, BlockType::Air, remove);
+        }
+    }
+    printStats("remove glowstone", remove);
+    matches = checkLight(world, "removing glowstone") && matches;
+
+    // Open a shaft to the sky from the top so sky light floods the cave with the last block, then close it
+    TimingStats open;
+    for (int y = CHUNK_HEIGHT - 1; y >= maxY; y--) {
+        timedSetBlock(world, 0, y, 0, BlockType::Air, open);
+    }
+    printStats("open sky shaft", open);
+    matches = checkLight(world, "opening the shaft") && matches;
+
+    TimingStats close;
+    timedSetBlock(world, 0, maxY, 0, BlockType::Stone, close);
+    printStats("close sky shaft", close);
+    matches = checkLight(world, "closing the shaft") && matches;
+
+    return matches;
+}
+
+// Batched and single ray casts across chunk borders
+void Benchmarks::runRaycast(int renderDistance, int rayCount) {
+    World world;
+    world.updateChunks(glm::vec3(8.0f, 100.0f, 8.0f), renderDistance);
+
+    // Rays from above the terrain looking down at random angles
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float extent = static_cast<float>(renderDistance * CHUNK_SIZE);
+
+    std::vector<Ray> rays(rayCount);
+    for (Ray& ray : rays) {
+        ray.origin = glm::vec3((unit(random) * 2.0f - 1.0f) * extent, 150.0f + unit(random) * 50.0f, (unit(random) * 2.0f - 1.0f) * extent);
+        ray.direction = glm::normalize(glm::vec3(unit(random) - 0.5f, -unit(random) - 0.1f, unit(random) - 0.5f));
+        ray.maxDistance = 128.0f;
+    }
+
+    std::vector<RaycastHit> hits(rayCount);
+
+    Clock::time_point start = Clock::now();
+    world.raycast(rays.data(), rays.size(), hits.data());
+    double batchedMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (size_t i = 0; i < rays.size(); i++) {
+        hits[i] = world.raycast(rays[i].origin, rays[i].direction, rays[i].maxDistance);
+    }
+    double singleMs = elapsedMs(start);
+
+    size_t hitCount = 0;
+    for (const RaycastHit& hit : hits) {
+        hitCount += hit.hit ? 1 : 0;
+    }
+
+    std::cout << "Raycast benchmark: " << rayCount << " rays, " << hitCount << " hits" << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+              << "  batched " << rayCount / batchedMs / 1000.0 << " Mrays/s" << std::endl
+              << "  single  " << rayCount / singleMs / 1000.0 << " Mrays/s" << std::endl;
+}
+
+// Cost of a profile zone and profiler overhead on chunk streaming and meshing
+void Benchmarks::runProfiler(int renderDistance, int ticks) {
+    const int zoneCount = 1000000;
+    bool enabled = Profiler::isEnabled();
+
+#ifndef TOMICZ_PROFILER
+    std::cout << "Profiler benchmark: zones are compiled out (TOMICZ_PROFILER off), engine overhead is zero" << std::endl;
+#endif
+
+    // Cost of a single zone, disabled and enabled
+    double zoneCost[2];
+    for (int mode = 0; mode < 2; mode++) {
+        Profiler::setEnabled(mode == 1);
+
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < zoneCount; i++) {
+            ProfileZone zone("Benchmarks::zone");
+        }
+        zoneCost[mode] = elapsedMs(start) * 1e6 / zoneCount;
+    }
+
+    std::cout << "Profiler benchmark: zone cost " << std::fixed << std::setprecision(1) << zoneCost[0] << " ns disabled, "
+              << zoneCost[1] << " ns enabled" << std::endl;
+
+    // Same streaming workload with recording off and on, best of three each
+    double best[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    uint64_t zones = 0;
+
+    for (int repeat = 0; repeat < 3; repeat++) {
+        for (int mode = 0; mode < 2; mode++) {
+            Profiler::setEnabled(mode == 1);
+            Profiler::clear();
+
+            best[mode] = std::min(best[mode], runStreamingWorkload(renderDistance, ticks));
+            if (mode == 1) {
+                zones = Profiler::getRecordedCount();
+            }
+        }
+    }
+
+    Profiler::setEnabled(enabled);
+    Profiler::clear();
+
+    std::cout << std::setprecision(2)
+              << "  streaming " << ticks << " ticks: " << best[0] << " ms off, " << best[1] << " ms on ("
+              << (best[1] - best[0]) * 100.0 / best[0] << "% measured)" << std::endl
+              << "  " << zones << " zones recorded, estimated overhead "
+              << zones * zoneCost[1] * 1e-6 * 100.0 / best[0] << "%" << std::endl;
+}
+
+// Task spawn and steal overhead, scaling over worker counts and parallel chunk generation
+void Benchmarks::runScheduler(int maxWorkers) {
+    int hardwareThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    if (maxWorkers <= 0) {
+        maxWorkers = hardwareThreads;
+    }
+
+    std::cout << "Scheduler benchmark: " << hardwareThreads << " hardware threads, up to " << maxWorkers << " workers" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    MetricCounter& stolen = Metrics::counter("tomicz_tasks_stolen_total", "");
+
+    // Overhead of empty tasks submitted from outside and spawned recursively on workers
+    {
+        TaskScheduler scheduler(maxWorkers);
+        const int taskCount = 200000;
+
+        std::vector<TaskHandle> tasks;
+        tasks.reserve(taskCount);
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < taskCount; i++) {
+            tasks.push_back(scheduler.submit([]() {}));
+        }
+        scheduler.wait(tasks);
+        std::cout << "  submit + run (external): " << elapsedMs(start) * 1e6 / taskCount << " ns/task" << std::endl;
+
+        const int depth = 16;
+        uint64_t stolenBefore = stolen.get();
+        start = Clock::now();
+        TaskHandle root = scheduler.submit([&scheduler]() { spawnTree(scheduler, depth); });
+        scheduler.wait(root);
+        double treeMs = elapsedMs(start);
+        int treeTasks = (1 << (depth + 1)) - 1;
+        std::cout << "  spawn + run (nested):    " << treeMs * 1e6 / treeTasks << " ns/task, "
+                  << stolen.get() - stolenBefore << " of " << treeTasks << " stolen" << std::endl;
+    }
+
+    // Scaling of independent ~20 us tasks
+    const int workCount = 4096;
+    const int iterations = 20000;
+    double baseline = 0.0;
+
+    std::vector<int> workerCounts;
+    for (int workers = 1; workers < maxWorkers; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    for (int workers : workerCounts) {
+        TaskScheduler scheduler(workers);
+        std::vector<uint32_t> results(workCount);
+
+        Clock::time_point start = Clock::now();
+        scheduler.parallelFor(workCount, 16, [&results](size_t i) {
+            results[i] = busyWork(static_cast<uint32_t>(i), iterations);
+        });
+        double ms = elapsedMs(start);
+
+        if (workers == 1) {
+            baseline = ms;
+        }
+        std::cout << "  " << std::setw(3) << workers << " workers: " << std::setprecision(2) << ms << " ms, speedup "
+                  << baseline / ms << "x" << std::setprecision(1) << std::endl;
+
+    }
+
+    // Generating a full view of chunks without and with workers
+    for (int mode = 0; mode < 2; mode++) {
+        std::unique_ptr<TaskScheduler> scheduler(mode == 1 ? new TaskScheduler(maxWorkers) : nullptr);
+        World world;
+        world.setTaskScheduler(scheduler.get());
+
+        Clock::time_point start = Clock::now();
+        world.loadChunks(glm::vec3(8.0f, 100.0f, 8.0f), 6);
+        std::cout << "  generate " << world.getChunks().size() << " chunks " << (mode == 1 ? "with workers:    " : "on one thread: ")
+                  << std::setprecision(2) << elapsedMs(start) << " ms" << std::setprecision(1) << std::endl;
+    }
+}
+
+// Draw submission cost and upload volume through the renderer with a recording backend
+void Benchmarks::runRender(int renderDistance, int frames) {
+    World world;
+    world.updateChunks(glm::vec3(8.0f, 100.0f, 8.0f), renderDistance);
+
+    RecordingRenderBackend backend;
+    VoxelRenderer renderer(&backend);
+    renderer.init();
+
+    // Upload every mesh once
+    Clock::time_point start = Clock::now();
+    renderer.updateChunkMeshes(&world, glm::vec3(8.0f, 100.0f, 8.0f), std::numeric_limits<size_t>::max());
+    double uploadMs = elapsedMs(start);
+    MeshHeap::Stats heapStats = renderer.getMeshHeap().getStats();
+    std::cout << "Render benchmark: " << world.getChunks().size() << " chunks, " << std::fixed << std::setprecision(2)
+              << heapStats.usedBytes / (1024.0 * 1024.0) << " MB of meshes in " << heapStats.allocations << " ranges of "
+              << backend.getBufferCount() << " buffers, meshed and uploaded in " << uploadMs << " ms" << std::endl;
+
+    // Turn the camera around once, culling and submitting every frame
+    Camera camera(70.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    camera.setPosition(glm::vec3(8.0f, 100.0f, 8.0f));
+
+    // Batched and one draw per section with per-chunk uniforms
+    for (int mode = 0; mode < 2; mode++) {
+        renderer.setBatching(mode == 0);
+
+        TimingStats frameStats;
+        RenderFrameStats sum = RenderFrameStats();
+        for (int frame = 0; frame < frames; frame++) {
+            camera.setRotation(360.0f * frame / frames, -20.0f);
+
+            start = Clock::now();
+            renderer.render(&world, camera);
+            frameStats.add(elapsedMs(start));
+
+            // The first frame also carries the mesh uploads
+            const RenderFrameStats& last = backend.getLastFrame();
+            sum.draws += last.draws;
+            sum.batches += last.batches;
+            sum.uniformUpdates += last.uniformUpdates;
+            sum.uploadBytes += frame > 0 ? last.uploadBytes : 0;
+        }
+
+        printStats(mode == 0 ? "cull and submit batched" : "cull and submit per draw", frameStats);
+        std::cout << "  " << std::setprecision(1) << static_cast<double>(sum.draws) / frames << " draws in "
+                  << static_cast<double>(sum.batches) / frames << " batches/frame, "
+                  << static_cast<double>(sum.uniformUpdates) / frames << " uniform updates/frame, "
+                  << static_cast<double>(sum.uploadBytes) / std::max(frames - 1, 1) / 1024.0 << " KB uniforms and instances/frame" << std::endl;
+    }
+
+    // Resize twice and keep rendering, only the resizes may create depth targets
+    RenderTargetStats before = backend.getRenderTargetStats();
+    const int sizes[3][2] = {{1920, 1080}, {1280, 720}, {1280, 720}};
+    for (int step = 0; step < 3; step++) {
+        backend.setFrameSize(sizes[step][0], sizes[step][1]);
+        for (int frame = 0; frame < frames / 3; frame++) {
+            renderer.render(&world, camera);
+        }
+    }
+    RenderTargetStats after = backend.getRenderTargetStats();
+    std::cout << "  depth targets: " << after.allocations - before.allocations << " created and "
+              << after.evictions - before.evictions << " evicted over " << after.acquires - before.acquires
+              << " frames with 2 resizes, " << after.targets << " pooled" << std::endl;
+
+    std::cout << "  " << backend.getInvalidCallCount() << " invalid calls" << std::endl;
+}
+
+// Allocation and free cost, utilization and fragmentation of the mesh heap under remeshing churn
+void Benchmarks::runMeshHeap(int operations) {
+    const int framesInFlight = RenderBackend::MAX_FRAMES_IN_FLIGHT;
+    const size_t liveTarget = 4096;
+    const int operationsPerFrame = 64;
+
+    MeshHeap heap(MeshHeap::DEFAULT_PAGE_SIZE, framesInFlight);
+    std::mt19937 random(1234);
+
+    // Section meshes range from a few quads to a full section of faces (log-uniform)
+    std::uniform_real_distribution<double> logSize(std::log(256.0), std::log(4.0 * 1024.0 * 1024.0));
+    std::vector<MeshAllocation> live;
+    live.reserve(liveTarget * 2);
+
+    uint64_t allocateNs = 0;
+    uint64_t freeNs = 0;
+    int allocations = 0;
+    int frees = 0;
+    int invalid = 0;
+    double utilizationSum = 0.0;
+    double fragmentationSum = 0.0;
+    int frames = 0;
+
+    for (int operation = 0; operation < operations; operation++) {
+        // Grow to the target, then replace meshes at random
+        bool allocateNext = live.size() < liveTarget || (random() & 1);
+        if (allocateNext) {
+            uint32_t size = static_cast<uint32_t>(std::exp(logSize(random)));
+
+            Clock::time_point start = Clock::now();
+            MeshAllocation allocation = heap.allocate(size);
+            allocateNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            allocations++;
+
+            if (!allocation.isValid() || allocation.size < size ||
+                static_cast<uint64_t>(allocation.offset) + allocation.size > heap.getPageSize(allocation.page)) {
+                invalid++;
+            }
+            live.push_back(allocation);
+        } else if (!live.empty()) {
+            size_t index = random() % live.size();
+
+            Clock::time_point start = Clock::now();
+            heap.free(live[index]);
+            freeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            frees++;
+
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        if ((operation + 1) % operationsPerFrame == 0) {
+            heap.endFrame();
+
+            MeshHeap::Stats stats = heap.getStats();
+            utilizationSum += static_cast<double>(stats.usedBytes) / stats.capacityBytes;
+            fragmentationSum += heap.getFragmentation();
+            frames++;
+        }
+
+        // Check free list invariants and that live ranges do not overlap
+        if ((operation + 1) % (operations / 16) == 0) {
+            if (!heap.validate()) {
+                invalid++;
+            }
+
+            std::vector<MeshAllocation> sorted(live);
+            std::sort(sorted.begin(), sorted.end(), [](const MeshAllocation& a, const MeshAllocation& b) {
+                return a.page != b.page ? a.page < b.page : a.offset < b.offset;
+            });
+            for (size_t i = 1; i < sorted.size(); i++) {
+                if (sorted[i].page == sorted[i - 1].page && sorted[i - 1].offset + sorted[i - 1].size > sorted[i].offset) {
+                    invalid++;
+                }
+            }
+        }
+    }
+
+    MeshHeap::Stats stats = heap.getStats();
+    std::cout << "Mesh heap benchmark: " << operations << " operations, " << live.size() << " live ranges, "
+              << framesInFlight << " frames in flight" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "  allocate " << static_cast<double>(allocateNs) / std::max(allocations, 1) << " ns, free "
+              << static_cast<double>(freeNs) / std::max(frees, 1) << " ns" << std::endl
+              << "  " << heap.getPageCount() << " pages, " << stats.capacityBytes / (1024.0 * 1024.0) << " MB capacity, "
+              << stats.usedBytes / (1024.0 * 1024.0) << " MB used, " << stats.pendingFreeBytes / (1024.0 * 1024.0) << " MB pending, "
+              << stats.freeRanges << " free ranges" << std::endl
+              << "  mean utilization " << utilizationSum * 100.0 / std::max(frames, 1) << "%, mean fragmentation "
+              << fragmentationSum * 100.0 / std::max(frames, 1) << "%, " << invalid << " invalid" << std::endl;
+}
+
+// Software rasterizer frame time on one thread and across workers
+void Benchmarks::runRaster(int renderDistance, int width, int height, int maxWorkers) {
+    const int frames = 5;
+    if (maxWorkers <= 0) {
+        maxWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    World world;
+    world.updateChunks(glm::vec3(8.0f, 100.0f, 8.0f), renderDistance);
+
+    Camera camera(70.0f, static_cast<float>(width) / height, 0.1f, 1000.0f);
+    camera.setPosition(glm::vec3(8.0f, 100.0f, 8.0f));
+    camera.setRotation(45.0f, -20.0f);
+
+    std::cout << "Raster benchmark: " << world.getChunks().size() << " chunks at " << width << "x" << height << std::endl;
+
+    double baseline = 0.0;
+    for (int mode = 0; mode < 2; mode++) {
+        std::unique_ptr<TaskScheduler> scheduler(mode == 1 ? new TaskScheduler(maxWorkers) : nullptr);
+        SoftwareRenderBackend backend(width, height, scheduler.get());
+        VoxelRenderer renderer(&backend);
+        renderer.init();
+        renderer.updateChunkMeshes(&world, camera.getPosition(), std::numeric_limits<size_t>::max());
+        renderer.uploadChunkMeshes(&world, camera.getPosition());
+
+        // The first frame carries the mesh uploads
+        renderer.render(&world, camera);
+
+        double bestMs = std::numeric_limits<double>::max();
+        SoftwareRasterStats best = SoftwareRasterStats();
+        for (int frame = 0; frame < frames; frame++) {
+            Clock::time_point start = Clock::now();
+            renderer.render(&world, camera);
+            double ms = elapsedMs(start);
+            if (ms < bestMs) {
+                bestMs = ms;
+                best = backend.getLastFrameStats();
+            }
+        }
+
+        if (mode == 0) {
+            baseline = bestMs;
+        }
+        std::string label = mode == 1 ? std::to_string(maxWorkers) + " workers" : "one thread";
+        std::cout << "  " << label << ": " << std::fixed
+                  << std::setprecision(2) << bestMs << " ms (bin " << best.binMs << ", raster " << best.rasterMs
+                  << "), speedup " << baseline / bestMs << "x, " << best.triangles << " triangles, " << best.rasterized
+                  << " rasterized, " << best.binEntries << " bin entries, " << best.pixelsShaded << " pixels shaded"
+                  << std::endl;
+    }
+}
+
+// World map render time from terrain noise, cache reuse and re-rendering after an edit
+void Benchmarks::runWorldMap(int radius, int maxWorkers) {
+    if (maxWorkers <= 0) {
+        maxWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    int chunks = radius * 2 + 1;
+    std::vector<uint32_t> pixels;
+    std::cout << "World map benchmark: " << chunks << "x" << chunks << " chunks (" << chunks * CHUNK_SIZE << "x"
+              << chunks * CHUNK_SIZE << " pixels) from terrain noise" << std::endl;
+
+    // Cold renders without and with workers, then a warm render from the cache
+    double baseline = 0.0;
+    std::unique_ptr<TaskScheduler> scheduler(new TaskScheduler(maxWorkers));
+    for (int mode = 0; mode < 2; mode++) {
+        WorldMap map(mode == 1 ? scheduler.get() : nullptr, static_cast<size_t>(chunks * chunks));
+        map.render(nullptr, -radius, -radius, chunks, chunks, pixels);
+        const WorldMapStats& stats = map.getLastStats();
+        if (mode == 0) {
+            baseline = stats.ms;
+        }
+
+        std::string label = mode == 1 ? std::to_string(maxWorkers) + " workers" : "one thread";
+        std::cout << "  " << label << ": " << std::fixed << std::setprecision(2) << stats.ms << " ms, " << stats.tilesRendered
+                  << " tiles, " << stats.columnsGenerated / (stats.ms * 1000.0) << " M columns/s, speedup "
+                  << baseline / stats.ms << "x" << std::endl;
+
+        if (mode == 1) {
+            map.render(nullptr, -radius, -radius, chunks, chunks, pixels);
+            std::cout << "  cached:  " << map.getLastStats().ms << " ms, " << map.getLastStats().tilesRendered << " tiles rendered"
+                      << std::endl;
+        }
+    }
+
+    // Loaded chunks must look exactly like the noise path, and an edit only redraws its tile
+    World world;
+    world.updateChunks(glm::vec3(8.0f, 100.0f, 8.0f), 4);
+
+    std::vector<uint32_t> generated;
+    WorldMap noiseMap;
+    noiseMap.render(nullptr, -4, -4, 9, 9, generated);
+
+    WorldMap worldMap(scheduler.get());
+    worldMap.render(&world, -4, -4, 9, 9, pixels);
+    std::cout << "  loaded chunks " << (pixels == generated ? "match" : "DO NOT match") << " the generated map ("
+              << worldMap.getLastStats().columnsLoaded << " columns loaded)" << std::endl;
+
+    world.setBlock(8, CHUNK_HEIGHT - 1, 8, BlockType::Stone);
+    worldMap.render(&world, -4, -4, 9, 9, pixels);
+    std::cout << "  after an edit: " << worldMap.getLastStats().tilesRendered << " of " << worldMap.getLastStats().tiles
+              << " tiles rendered, map " << (pixels == generated ? "unchanged" : "changed") << std::endl;
+}
+
+// Time to the first frame's meshes from generation against restoring the spawn snapshot
+void Benchmarks::runStartup(int renderDistance, int maxWorkers) {
+    if (maxWorkers <= 0) {
+        maxWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    const std::string filename = "spawn_benchmark.snapshot";
+    const glm::vec3 spawn(8.0f, 100.0f, 8.0f);
+    const ChunkPosition center = {0, 0};
+    TaskScheduler scheduler(maxWorkers);
+
+    std::cout << "Startup benchmark: render distance " << renderDistance << ", " << maxWorkers << " workers" << std::endl;
+
+    // Cold start: generate, light and mesh everything like main does without a snapshot
+    World generated;
+    generated.setTaskScheduler(&scheduler);
+    RecordingRenderBackend coldBackend;
+    VoxelRenderer coldRenderer(&coldBackend);
+    coldRenderer.init();
+
+    Clock::time_point start = Clock::now();
+    generated.loadChunks(spawn, renderDistance);
+    double generateMs = elapsedMs(start);
+    start = Clock::now();
+    coldRenderer.updateChunkMeshes(&generated, spawn, std::numeric_limits<size_t>::max());
+    double meshMs = elapsedMs(start);
+    double coldMs = generateMs + meshMs;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  generate:  " << generateMs << " ms, mesh " << meshMs << " ms, total " << coldMs << " ms" << std::endl;
+
+    // Warm starts from snapshots with blocks and light only, then with meshes
+    for (int mode = 0; mode < 2; mode++) {
+        bool meshes = mode == 1;
+
+        start = Clock::now();
+        bool saved = SpawnSnapshot::save(filename, generated, center, renderDistance, meshes);
+        double saveMs = elapsedMs(start);
+
+        long fileBytes = 0;
+        FILE* file = std::fopen(filename.c_str(), "rb");
+        if (file) {
+            std::fseek(file, 0, SEEK_END);
+            fileBytes = std::ftell(file);
+            std::fclose(file);
+        }
+
+        // Restore, generate and mesh whatever the snapshot lacks, then upload
+        World restored;
+        restored.setTaskScheduler(&scheduler);
+        RecordingRenderBackend warmBackend;
+        VoxelRenderer warmRenderer(&warmBackend);
+        warmRenderer.init();
+
+        start = Clock::now();
+        size_t restoredChunks = SpawnSnapshot::load(filename, &restored, center, renderDistance, &scheduler);
+        double loadMs = elapsedMs(start);
+        start = Clock::now();
+        restored.loadChunks(spawn, renderDistance);
+        warmRenderer.updateChunkMeshes(&restored, spawn, std::numeric_limits<size_t>::max());
+        warmRenderer.uploadChunkMeshes(&restored, spawn);
+        double finishMs = elapsedMs(start);
+
+        // The restored world must be the generated one
+        size_t mismatches = restored.getChunks().size() == generated.getChunks().size() ? 0 : 1;
+        for (const auto& pair : generated.getChunks()) {
+            const Chunk* a = pair.second;
+            const Chunk* b = restored.findChunk(pair.first.x, pair.first.z);
+            if (!b || std::memcmp(a->getLightData(), b->getLightData(), CHUNK_VOLUME) != 0) {
+                mismatches++;
+                continue;
+            }
+            for (int section = 0; section < CHUNK_SECTIONS; section++) {
+                const std::vector<ChunkVertex>& va = a->getSectionVertices(section);
+                const std::vector<ChunkVertex>& vb = b->getSectionVertices(section);
+                if (std::memcmp(a->getSectionBlocks(section), b->getSectionBlocks(section), SECTION_VOLUME) != 0 ||
+                    va.size() != vb.size() || (!va.empty() && std::memcmp(va.data(), vb.data(), va.size() * sizeof(ChunkVertex)) != 0)) {
+                    mismatches++;
+                    break;
+                }
+            }
+        }
+
+        std::cout << "  " << (meshes ? "with meshes:" : "terrain:    ") << " " << fileBytes / (1024.0 * 1024.0) << " MB saved in "
+                  << (saved ? "" : "FAILED ") << saveMs << " ms, restored " << restoredChunks << " chunks in " << loadMs
+                  << " ms, meshed and uploaded in " << finishMs << " ms, total " << loadMs + finishMs << " ms (speedup "
+                  << coldMs / std::max(loadMs + finishMs, 1e-6) << "x), " << (mismatches == 0 ? "matches" : "DOES NOT match") << std::endl;
+    }
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Benchmarks class
+//
+// Micro benchmarks of engine subsystems on generated terrain, printed to stdout.
+class Benchmarks {
+public:
+    // Full chunk remeshing with and without ambient occlusion
+    static void runMesh(int renderDistance, int repeats);
+
+    // Block edit latency (including light updates) while digging and lighting a large cave
+    //
+    // Returns false if the updated light differs from lighting the same blocks from scratch.
+    static bool runLight();
+
+    // Batched and single ray casts across chunk borders
+    static void runRaycast(int renderDistance, int rayCount);
+
+    // Cost of a profile zone and profiler overhead on chunk streaming and meshing
+    static void runProfiler(int renderDistance, int ticks);
+
+    // Task spawn and steal overhead, scaling over worker counts and parallel chunk generation
+    static void runScheduler(int maxWorkers);
+
+    // Draw submission cost and upload volume through the renderer with a recording backend
+    static void runRender(int renderDistance, int frames);
+
+    // Allocation and free cost, utilization and fragmentation of the mesh heap under remeshing churn
+    static void runMeshHeap(int operations);
+
+    // Software rasterizer frame time on one thread and across workers
+    static void runRaster(int renderDistance, int width, int height, int maxWorkers);
+
+    // World map render time from terrain noise, cache reuse and re-rendering after an edit
+    static void runWorldMap(int radius, int maxWorkers);
+
+    // Time to the first frame's meshes: generating, lighting and meshing the spawn area against restoring its snapshot
+    static void runStartup(int renderDistance, int maxWorkers);
+};
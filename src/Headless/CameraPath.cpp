@@ -0,0 +1,125 @@
+#include "CameraPath.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+// Waypoints generated per second of path
+static const float WAYPOINTS_PER_SECOND = 4.0f;
+
+// Constructor
+CameraPath::CameraPath() {
+}
+
+// Straight flight along -z
+CameraPath CameraPath::makeLine(const glm::vec3& start, float speed, float duration) {
+    CameraPath path;
+
+    CameraPose pose;
+    pose.yaw = -90.0f;
+    pose.pitch = -20.0f;
+
+    pose.position = start;
+    path.addWaypoint(0.0f, pose);
+
+    pose.position = start + glm::vec3(0.0f, 0.0f, -speed * duration);
+    path.addWaypoint(duration, pose);
+
+    return path;
+}
+
+// Circle around center
+CameraPath CameraPath::makeCircle(const glm::vec3& center, float radius, float speed, float duration) {
+    CameraPath path;
+
+    int count = std::max(static_cast<int>(duration * WAYPOINTS_PER_SECOND), 1);
+    float angularSpeed = speed / std::max(radius, 1.0f);
+
+    for (int i = 0; i <= count; i++) {
+        float time = duration * i / count;
+        float angle = angularSpeed * time;
+
+        // Look along the direction of travel
+        CameraPose pose;
+        pose.position = center + glm::vec3(std::cos(angle) * radius, 0.0f, std::sin(angle) * radius);
+        pose.yaw = glm::degrees(angle) + 90.0f;
+        pose.pitch = -20.0f;
+        path.addWaypoint(time, pose);
+    }
+
+    return path;
+}
+
+// Load waypoints from a file
+bool CameraPath::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    m_waypoints.clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip blank lines and comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        float time;
+        CameraPose pose;
+        if (!(stream >> time >> pose.position.x >> pose.position.y >> pose.position.z >> pose.yaw >> pose.pitch)) {
+            return false;
+        }
+
+        addWaypoint(time, pose);
+    }
+
+    return !m_waypoints.empty();
+}
+
+// Add a waypoint
+void CameraPath::addWaypoint(float time, const CameraPose& pose) {
+    Waypoint waypoint;
+    waypoint.time = time;
+    waypoint.pose = pose;
+    m_waypoints.push_back(waypoint);
+}
+
+// Get pose at time
+CameraPose CameraPath::sample(float time) const {
+    if (m_waypoints.empty()) {
+        CameraPose pose;
+        pose.position = glm::vec3(0.0f);
+        pose.yaw = -90.0f;
+        pose.pitch = 0.0f;
+        return pose;
+    }
+
+    if (time <= m_waypoints.front().time) {
+        return m_waypoints.front().pose;
+    }
+    if (time >= m_waypoints.back().time) {
+        return m_waypoints.back().pose;
+    }
+
+    // First waypoint after time
+    auto next = std::upper_bound(m_waypoints.begin(), m_waypoints.end(), time,
+                                 [](float t, const Waypoint& waypoint) { return t < waypoint.time; });
+    auto previous = next - 1;
+
+    float span = next->time - previous->time;
+    float alpha = span > 0.0f ? (time - previous->time) / span : 1.0f;
+
+    CameraPose pose;
+    pose.position = glm::mix(previous->pose.position, next->pose.position, alpha);
+    pose.yaw = glm::mix(previous->pose.yaw, next->pose.yaw, alpha);
+    pose.pitch = glm::mix(previous->pose.pitch, next->pose.pitch, alpha);
+    return pose;
+}
+
+// Get time of the last waypoint
+float CameraPath::getDuration() const {
+    return m_waypoints.empty() ? 0.0f : m_waypoints.back().time;
+}
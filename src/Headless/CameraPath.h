@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Camera.h"
+#include <string>
+#include <vector>
+
+// Camera path class
+//
+// Timed waypoints the camera is moved along, interpolated linearly. Paths are
+// either generated (straight line, circle) or loaded from a text file with one
+// "time x y z yaw pitch" waypoint per line.
+class CameraPath {
+public:
+    CameraPath();
+
+    // Straight flight along -z at speed (blocks per second) for duration seconds
+    static CameraPath makeLine(const glm::vec3& start, float speed, float duration);
+
+    // Circle around center with radius at speed (blocks per second) for duration seconds
+    static CameraPath makeCircle(const glm::vec3& center, float radius, float speed, float duration);
+
+    // Load waypoints from a file, returns false on failure
+    bool loadFromFile(const std::string& filename);
+
+    // Add a waypoint (times must increase)
+    void addWaypoint(float time, const CameraPose& pose);
+
+    // Get pose at time (clamped to the ends of the path)
+    CameraPose sample(float time) const;
+
+    // Get time of the last waypoint
+    float getDuration() const;
+
+    // Check if the path has no waypoints
+    bool isEmpty() const { return m_waypoints.empty(); }
+
+private:
+    // Timed pose
+    struct Waypoint {
+        float time;
+        CameraPose pose;
+    };
+
+    // Waypoints in time order
+    std::vector<Waypoint> m_waypoints;
+};
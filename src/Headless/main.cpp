@@ -0,0 +1,553 @@
+#include "Camera.h"
+#include "Core/ImageWriter.h"
+#include "Core/MemoryUsage.h"
+#include "Core/Metrics.h"
+#include "Core/Profiler.h"
+#include "Core/SimulationLoop.h"
+#include "Core/TaskScheduler.h"
+#include "Core/TimingStats.h"
+#include "Headless/Benchmarks.h"
+#include "Headless/CameraPath.h"
+#include "Renderer/RecordingRenderBackend.h"
+#include "Renderer/SoftwareRenderBackend.h"
+#include "Replay/CameraRecording.h"
+#include "Replay/FrameTimings.h"
+#include "Voxel/ChunkCuller.h"
+#include "Voxel/ChunkMesher.h"
+#include "Voxel/ChunkPrefetcher.h"
+#include "Voxel/MeshCache.h"
+#include "Voxel/SectionPool.h"
+#include "Voxel/VoxelRenderer.h"
+#include "Voxel/World.h"
+#include "Voxel/WorldMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// Headless run options
+struct HeadlessOptions {
+    uint64_t ticks;
+    int tickRate;
+    int renderDistance;
+    std::string path;
+    float speed;
+    bool mesh;
+    bool render;
+    bool realtime;
+    double maxP99;
+    std::string benchmark;
+    std::string record;
+    std::string replay;
+    std::string timings;
+    std::string profile;
+    std::string metrics;
+    double metricsInterval;
+    std::string snapshot;
+    int snapshotWidth;
+    int snapshotHeight;
+    std::string map;
+    int mapRadius;
+    int workers;
+    bool prefetch;
+    float prefetchLookahead;
+    int meshCacheMb;
+    std::string meshCacheDir;
+};
+
+// Print usage
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --ticks N             ticks to run (default 3600)\n"
+              << "  --tick-rate HZ        simulated ticks per second (default 60)\n"
+              << "  --render-distance N   chunks loaded around the camera (default 8)\n"
+              << "  --path line|circle|FILE  camera path (default line)\n"
+              << "  --speed S             camera speed for generated paths in blocks/s (default 20)\n"
+              << "  --workers N           generation and meshing threads (default: hardware threads - 1, 0: none)\n"
+              << "  --mesh                also mesh dirty chunks every tick like the renderer\n"
+              << "  --render              mesh and submit draws to a recording render backend (implies --mesh)\n"
+              << "  --realtime            run at the tick rate instead of as fast as possible\n"
+              << "  --mesh-cache-mb N     memory for reusing meshes of unchanged chunk sections (default 256, 0: off)\n"
+              << "  --mesh-cache-dir DIR  spill meshes evicted from the mesh cache to DIR and reuse them across runs\n"
+              << "  --no-prefetch         only generate chunks once they are within render distance\n"
+              << "  --prefetch-lookahead S  seconds of predicted camera motion to prefetch chunks for (default 2)\n"
+              << "  --max-p99 MS          exit with an error if the p99 tick time is higher\n"
+              << "  --record FILE         save the camera pose of every tick as a recording\n"
+              << "  --replay FILE         replay a recording instead of following a path (runs all its ticks)\n"
+              << "  --timings FILE        write per-frame timings as .csv or .json\n"
+              << "  --profile FILE        record profile zones and write them as Chrome trace JSON\n"
+              << "  --metrics FILE|-      write a Prometheus text snapshot periodically and at the end\n"
+              << "  --metrics-interval S  seconds between metrics snapshots (default 10)\n"
+              << "  --snapshot FILE       render the final view with the software rasterizer and write it as a PPM image\n"
+              << "  --snapshot-size WxH   snapshot resolution (default 1920x1080)\n"
+              << "  --map FILE            write a top-down map around the final camera position as a PPM image\n"
+              << "  --map-radius N        map radius in chunks (default 64)\n"
+              << "  --bench mesh|light|raycast|profiler|scheduler|render|heap|raster|map|startup  run a benchmark instead\n";
+}
+
+// Parse arguments, returns false on invalid arguments
+static bool parseArguments(int argc, char* argv[], HeadlessOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--ticks" && hasValue) {
+            options.ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--tick-rate" && hasValue) {
+            options.tickRate = std::atoi(argv[++i]);
+        } else if (argument == "--render-distance" && hasValue) {
+            options.renderDistance = std::atoi(argv[++i]);
+        } else if (argument == "--path" && hasValue) {
+            options.path = argv[++i];
+        } else if (argument == "--speed" && hasValue) {
+            options.speed = static_cast<float>(std::atof(argv[++i]));
+        } else if (argument == "--workers" && hasValue) {
+            options.workers = std::atoi(argv[++i]);
+        } else if (argument == "--mesh") {
+            options.mesh = true;
+        } else if (argument == "--render") {
+            options.mesh = true;
+            options.render = true;
+        } else if (argument == "--realtime") {
+            options.realtime = true;
+        } else if (argument == "--mesh-cache-mb" && hasValue) {
+            options.meshCacheMb = std::atoi(argv[++i]);
+        } else if (argument == "--mesh-cache-dir" && hasValue) {
+            options.meshCacheDir = argv[++i];
+        } else if (argument == "--no-prefetch") {
+            options.prefetch = false;
+        } else if (argument == "--prefetch-lookahead" && hasValue) {
+            options.prefetchLookahead = static_cast<float>(std::atof(argv[++i]));
+        } else if (argument == "--max-p99" && hasValue) {
+            options.maxP99 = std::atof(argv[++i]);
+        } else if (argument == "--record" && hasValue) {
+            options.record = argv[++i];
+        } else if (argument == "--replay" && hasValue) {
+            options.replay = argv[++i];
+        } else if (argument == "--timings" && hasValue) {
+            options.timings = argv[++i];
+        } else if (argument == "--profile" && hasValue) {
+            options.profile = argv[++i];
+        } else if (argument == "--metrics" && hasValue) {
+            options.metrics = argv[++i];
+        } else if (argument == "--metrics-interval" && hasValue) {
+            options.metricsInterval = std::atof(argv[++i]);
+        } else if (argument == "--map" && hasValue) {
+            options.map = argv[++i];
+        } else if (argument == "--map-radius" && hasValue) {
+            options.mapRadius = std::atoi(argv[++i]);
+        } else if (argument == "--snapshot" && hasValue) {
+            options.snapshot = argv[++i];
+        } else if (argument == "--snapshot-size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.snapshotWidth, &options.snapshotHeight) != 2) {
+                return false;
+            }
+        } else if (argument == "--bench" && hasValue) {
+            options.benchmark = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    return options.tickRate > 0 && options.renderDistance >= 0 && options.workers >= -1 && options.snapshotWidth > 0 &&
+           options.snapshotHeight > 0 && options.mapRadius >= 0;
+}
+
+// Render a top-down map of the chunks within radius of a position and write it as an image
+static bool writeMap(World* world, const glm::vec3& position, int radius, TaskScheduler* scheduler, const std::string& filename) {
+    WorldMap map(scheduler);
+    int centerX = static_cast<int>(std::floor(position.x / CHUNK_SIZE));
+    int centerZ = static_cast<int>(std::floor(position.z / CHUNK_SIZE));
+    int chunks = radius * 2 + 1;
+
+    std::vector<uint32_t> pixels;
+    map.render(world, centerX - radius, centerZ - radius, chunks, chunks, pixels);
+
+    const WorldMapStats& stats = map.getLastStats();
+    std::cout << "Map: " << chunks << "x" << chunks << " chunks in " << stats.ms << " ms, " << stats.tilesRendered << " tiles, "
+              << stats.columnsGenerated << " columns generated, " << stats.columnsLoaded << " loaded" << std::endl;
+
+    int size = chunks * CHUNK_SIZE;
+    if (!ImageWriter::writePpm(filename, pixels.data(), size, size, size)) {
+        std::cerr << "Failed to write map: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Run a benchmark by name
+static int runBenchmark(const std::string& name, int maxWorkers) {
+    if (name == "mesh") {
+        Benchmarks::runMesh(4, 3);
+    } else if (name == "light") {
+        if (!Benchmarks::runLight()) {
+            return 1;
+        }
+    } else if (name == "raycast") {
+        Benchmarks::runRaycast(4, 1000000);
+    } else if (name == "profiler") {
+        Benchmarks::runProfiler(4, 600);
+    } else if (name == "scheduler") {
+        Benchmarks::runScheduler(maxWorkers);
+    } else if (name == "render") {
+        Benchmarks::runRender(8, 720);
+    } else if (name == "heap") {
+        Benchmarks::runMeshHeap(1000000);
+    } else if (name == "raster") {
+        Benchmarks::runRaster(6, 1920, 1080, maxWorkers);
+    } else if (name == "map") {
+        Benchmarks::runWorldMap(64, maxWorkers);
+    } else if (name == "startup") {
+        Benchmarks::runStartup(3, maxWorkers);
+    } else {
+        std::cerr << "Unknown benchmark: " << name << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// Check if a string ends with suffix
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Milliseconds since start
+static double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Render the view of a camera with the software rasterizer and write it as an image
+static bool writeSnapshot(World* world, const Camera& camera, TaskScheduler* scheduler, const std::string& filename, int width, int height) {
+    SoftwareRenderBackend backend(width, height, scheduler);
+    VoxelRenderer renderer(&backend);
+    if (!renderer.init()) {
+        return false;
+    }
+
+    // Meshes built during the run, then the chunks still dirty
+    Clock::time_point start = Clock::now();
+    renderer.uploadChunkMeshes(world, camera.getPosition());
+    renderer.updateChunkMeshes(world, camera.getPosition(), std::numeric_limits<size_t>::max());
+    double meshMs = millisecondsSince(start);
+
+    Camera view(camera);
+    view.setAspectRatio(static_cast<float>(width) / height);
+
+    start = Clock::now();
+    renderer.render(world, view);
+    double renderMs = millisecondsSince(start);
+
+    const SoftwareRasterStats& stats = backend.getLastFrameStats();
+    std::cout << "Snapshot: " << width << "x" << height << " in " << renderMs << " ms (bin " << stats.binMs << ", raster "
+              << stats.rasterMs << ", meshes " << meshMs << "), " << stats.triangles << " triangles, " << stats.rasterized
+              << " rasterized, " << stats.pixelsShaded << " pixels shaded" << std::endl;
+
+    if (!backend.writeImage(filename)) {
+        std::cerr << "Failed to write snapshot: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    HeadlessOptions options;
+    options.ticks = 3600;
+    options.tickRate = SimulationLoop::DEFAULT_TICK_RATE;
+    options.renderDistance = 8;
+    options.path = "line";
+    options.speed = 20.0f;
+    options.mesh = false;
+    options.render = false;
+    options.realtime = false;
+    options.maxP99 = 0.0;
+    options.metricsInterval = 10.0;
+    options.snapshotWidth = 1920;
+    options.snapshotHeight = 1080;
+    options.mapRadius = 64;
+    options.workers = -1;
+    options.prefetch = true;
+    options.prefetchLookahead = ChunkPrefetcher::DEFAULT_LOOKAHEAD;
+    options.meshCacheMb = static_cast<int>(MeshCache::DEFAULT_MAX_BYTES / (1024 * 1024));
+
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!options.benchmark.empty()) {
+        return runBenchmark(options.benchmark, options.workers);
+    }
+
+    // Camera poses to replay, either loaded or sampled from a path once per tick
+    CameraRecording replay(options.tickRate);
+
+    if (!options.replay.empty()) {
+        if (!replay.load(options.replay)) {
+            std::cerr << "Failed to load recording: " << options.replay << std::endl;
+            return 1;
+        }
+        options.ticks = replay.getFrameCount();
+        options.tickRate = replay.getTickRate();
+    } else {
+        float duration = static_cast<float>(options.ticks) / options.tickRate;
+        glm::vec3 start(0.0f, 100.0f, 0.0f);
+        CameraPath path;
+
+        if (options.path == "line") {
+            path = CameraPath::makeLine(start, options.speed, duration);
+        } else if (options.path == "circle") {
+            path = CameraPath::makeCircle(start, 64.0f, options.speed, duration);
+        } else if (!path.loadFromFile(options.path)) {
+            std::cerr << "Failed to load camera path: " << options.path << std::endl;
+            return 1;
+        }
+
+        for (uint64_t tick = 0; tick < options.ticks; tick++) {
+            replay.addFrame(path.sample(static_cast<float>(tick) / options.tickRate));
+        }
+    }
+
+    // Profile the run when asked
+    if (!options.profile.empty()) {
+        Profiler::setThreadName("Main");
+        Profiler::setEnabled(true);
+    }
+
+    // Worker threads for generation and meshing, outliving the world that waits for its tasks
+    std::unique_ptr<TaskScheduler> scheduler;
+    if (options.workers != 0) {
+        scheduler.reset(new TaskScheduler(std::max(options.workers, 0)));
+    }
+
+    // Meshes of unchanged sections are reused, like in the game
+    std::unique_ptr<MeshCache> meshCache;
+    if (options.meshCacheMb > 0) {
+        meshCache.reset(new MeshCache(static_cast<size_t>(options.meshCacheMb) * 1024 * 1024, options.meshCacheDir));
+    }
+    ChunkMesher::setCache(meshCache.get());
+
+    // Same world and simulation as the game, without window or renderer
+    std::unique_ptr<World> world(new World());
+    world->setTaskScheduler(scheduler.get());
+    std::unique_ptr<Camera> camera(new Camera(70.0f, 16.0f / 9.0f, 0.1f, 1000.0f));
+
+    std::unique_ptr<SimulationLoop> simulation(new SimulationLoop(world.get(), nullptr, camera.get(), options.renderDistance, options.tickRate));
+    simulation->setPrefetching(options.prefetch);
+    simulation->getPrefetcher().setLookahead(options.prefetchLookahead);
+
+    // Renderer submitting to a backend that only counts draws and uploads
+    RecordingRenderBackend renderBackend;
+    std::unique_ptr<VoxelRenderer> renderer;
+    if (options.render) {
+        renderer.reset(new VoxelRenderer(&renderBackend));
+        renderer->init();
+    }
+
+    CameraRecording recording(options.tickRate);
+    simulation->setReplay(&replay);
+    if (!options.record.empty()) {
+        simulation->setRecording(&recording);
+    }
+
+    std::cout << "Running " << options.ticks << " ticks at " << options.tickRate << " Hz, render distance "
+              << options.renderDistance << ", " << (options.replay.empty() ? "path " + options.path : "replay " + options.replay)
+              << (options.render ? ", rendering" : options.mesh ? ", meshing" : "") << (options.prefetch ? "" : ", no prefetch") << ", " << (scheduler ? scheduler->getWorkerCount() : 0) << " workers" << std::endl;
+
+    TimingStats tickStats;
+    FrameTimings frameTimings;
+    std::vector<Chunk*> dirtyChunks;
+    std::vector<uint32_t> rebuiltSections;
+    std::vector<ChunkDraw> drawList;
+    uint64_t maxUploadBytes = 0;
+    uint64_t holeFrames = 0;
+    uint64_t holeChunks = 0;
+
+    Clock::duration tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.tickRate));
+    Clock::time_point runStart = Clock::now();
+    Clock::time_point nextTick = runStart;
+    Clock::duration metricsInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.metricsInterval));
+    Clock::time_point nextMetrics = runStart + metricsInterval;
+
+    for (uint64_t tick = 0; tick < options.ticks; tick++) {
+        FrameTiming frame = FrameTiming();
+        uint64_t generatedBefore = world->getGeneratedChunkCount();
+
+        Clock::time_point phaseStart = Clock::now();
+        simulation->tick();
+        frame.generationMs = millisecondsSince(phaseStart);
+        frame.chunksGenerated = static_cast<uint32_t>(world->getGeneratedChunkCount() - generatedBefore);
+        tickStats.add(frame.generationMs);
+
+        // Mesh, cull and build the draw list like the renderer does each frame
+        if (renderer) {
+            phaseStart = Clock::now();
+            renderer->updateChunkMeshes(world.get(), camera->getPosition());
+            frame.meshingMs = millisecondsSince(phaseStart);
+            frame.chunksMeshed = static_cast<uint32_t>(renderer->getMeshedChunkCount());
+        } else if (options.mesh) {
+            phaseStart = Clock::now();
+            world->getDirtyChunks(camera->getPosition(), VoxelRenderer::MESH_BUDGET_PER_FRAME, dirtyChunks);
+            world->meshChunks(dirtyChunks, rebuiltSections);
+            frame.meshingMs = millisecondsSince(phaseStart);
+            frame.chunksMeshed = static_cast<uint32_t>(dirtyChunks.size());
+        }
+
+        phaseStart = Clock::now();
+        Frustum frustum = Frustum::fromMatrix(camera->getProjectionMatrix() * camera->getViewMatrix());
+        ChunkCuller::cull(*world, frustum, camera->getPosition(), drawList);
+        frame.cullingMs = millisecondsSince(phaseStart);
+        frame.chunksVisible = static_cast<uint32_t>(drawList.size());
+        frame.chunksMissing = ChunkCuller::countMissing(*world, frustum, camera->getPosition(), options.renderDistance);
+        holeFrames += frame.chunksMissing > 0 ? 1 : 0;
+        holeChunks += frame.chunksMissing;
+
+        phaseStart = Clock::now();
+        ChunkCuller::sortFrontToBack(drawList);
+        frame.drawListMs = millisecondsSince(phaseStart);
+
+        if (renderer) {
+            phaseStart = Clock::now();
+            renderer->submitDrawList(drawList, *camera);
+            frame.submitMs = millisecondsSince(phaseStart);
+            frame.draws = renderBackend.getLastFrame().draws;
+            frame.uploadBytes = renderBackend.getLastFrame().uploadBytes;
+            maxUploadBytes = std::max(maxUploadBytes, frame.uploadBytes);
+        }
+
+        frameTimings.add(frame);
+
+        // Periodic metrics snapshot
+        if (!options.metrics.empty() && Clock::now() >= nextMetrics) {
+            Metrics::dump(options.metrics);
+            nextMetrics = Clock::now() + metricsInterval;
+        }
+
+        if (options.realtime) {
+            nextTick += tickDuration;
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+
+    // Report
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Ticks:  " << options.ticks << " in " << seconds << " s (" << options.ticks / seconds << " ticks/s)" << std::endl;
+    std::cout << "Tick:   mean " << tickStats.getMean() << "  p50 " << tickStats.getPercentile(50.0)
+              << "  p90 " << tickStats.getPercentile(90.0) << "  p99 " << tickStats.getPercentile(99.0)
+              << "  max " << tickStats.getMax() << " ms" << std::endl;
+    std::cout << "Frame phases:" << std::endl;
+    frameTimings.printSummary(std::cout);
+    std::cout << "Chunks: " << world->getGeneratedChunkCount() << " generated (" << world->getGeneratedChunkCount() / seconds
+              << " chunks/s), " << world->getUnloadedChunkCount() << " unloaded, " << world->getChunks().size() << " loaded" << std::endl;
+    const TimingStats& forwardLatency = world->getForwardChunkLatency();
+    std::cout << "Ahead:  " << forwardLatency.getCount() << " chunks, load latency p50 " << forwardLatency.getPercentile(50.0)
+              << "  p99 " << forwardLatency.getPercentile(99.0) << "  max " << forwardLatency.getMax() << " ms" << std::endl;
+    std::cout << "Holes:  " << holeFrames << " frames (" << 100.0 * holeFrames / std::max<uint64_t>(options.ticks, 1) << "%) with chunks missing in view, "
+              << static_cast<double>(holeChunks) / std::max<uint64_t>(options.ticks, 1) << " missing/frame, "
+              << world->getPrefetchHitCount() << " prefetched chunks used" << std::endl;
+    if (renderer) {
+        const RenderFrameStats& totals = renderBackend.getTotals();
+        double frames = static_cast<double>(std::max<uint64_t>(renderBackend.getFrameCount(), 1));
+        std::cout << "Render: " << totals.draws / frames << " draws in " << totals.batches / frames << " batches/frame, " << totals.uploadBytes / frames / (1024.0 * 1024.0)
+                  << " MB uploaded/frame (max " << maxUploadBytes / (1024.0 * 1024.0) << "), "
+                  << renderBackend.getResidentBytes() / (1024.0 * 1024.0) << " MB resident in " << renderBackend.getBufferCount()
+                  << " buffers" << std::endl;
+        RenderTargetStats targets = renderBackend.getRenderTargetStats();
+        std::cout << "Targets: " << targets.allocations << " created for " << targets.acquires << " frames, "
+                  << targets.evictions << " evicted, " << targets.bytes / (1024.0 * 1024.0) << " MB pooled" << std::endl;
+    }
+    if (meshCache) {
+        MeshCacheStats cacheStats = meshCache->getStats();
+        uint64_t lookups = std::max<uint64_t>(cacheStats.hits + cacheStats.misses, 1);
+        std::cout << "Mesh cache: " << cacheStats.hits << " hits (" << 100.0 * cacheStats.hits / lookups << "%, " << cacheStats.diskHits
+                  << " from disk), " << cacheStats.misses << " misses, " << cacheStats.evictions << " evicted, "
+                  << cacheStats.bytes / (1024.0 * 1024.0) << " MB in " << cacheStats.entries << " sections" << std::endl;
+    }
+    SectionPoolStats pool = SectionPool::getStats();
+    std::cout << "Blocks: " << pool.references << " sections sharing " << pool.sections << " distinct ("
+              << static_cast<double>(pool.references) / std::max<size_t>(pool.sections, 1) << "x), "
+              << pool.bytes / (1024.0 * 1024.0) << " MB instead of " << pool.references * sizeof(SectionBlocks) / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << "Memory: " << MemoryUsage::getCurrentResident() / (1024.0 * 1024.0) << " MB resident, "
+              << MemoryUsage::getPeakResident() / (1024.0 * 1024.0) << " MB peak" << std::endl;
+
+    // Outputs
+    if (!options.record.empty()) {
+        if (!recording.save(options.record)) {
+            std::cerr << "Failed to save recording: " << options.record << std::endl;
+            return 1;
+        }
+        std::cout << "Saved " << recording.getFrameCount() << " ticks to " << options.record << std::endl;
+    }
+
+    if (!options.snapshot.empty()) {
+        if (!writeSnapshot(world.get(), *camera, scheduler.get(), options.snapshot, options.snapshotWidth, options.snapshotHeight)) {
+            return 1;
+        }
+        std::cout << "Wrote snapshot to " << options.snapshot << std::endl;
+    }
+
+    if (!options.map.empty()) {
+        if (!writeMap(world.get(), camera->getPosition(), options.mapRadius, scheduler.get(), options.map)) {
+            return 1;
+        }
+        std::cout << "Wrote map to " << options.map << std::endl;
+    }
+
+    if (!options.timings.empty()) {
+        bool written = endsWith(options.timings, ".json") ? frameTimings.writeJson(options.timings) : frameTimings.writeCsv(options.timings);
+        if (!written) {
+            std::cerr << "Failed to write timings: " << options.timings << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << frameTimings.getFrameCount() << " frames to " << options.timings << std::endl;
+    }
+
+    if (!options.metrics.empty()) {
+        if (!Metrics::dump(options.metrics)) {
+            std::cerr << "Failed to write metrics: " << options.metrics << std::endl;
+            return 1;
+        }
+    }
+
+    if (!options.profile.empty()) {
+        Profiler::setEnabled(false);
+        if (!Profiler::writeChromeTrace(options.profile)) {
+            std::cerr << "Failed to write profile: " << options.profile << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << Profiler::getRecordedCount() << " zones to " << options.profile << std::endl;
+    }
+
+    // Perf gate
+    if (renderBackend.getInvalidCallCount() > 0) {
+        std::cerr << renderBackend.getInvalidCallCount() << " invalid render backend calls" << std::endl;
+        return 1;
+    }
+
+    // The frame size never changes, so the depth target must be created once
+    if (renderBackend.getRenderTargetStats().allocations > 1) {
+        std::cerr << renderBackend.getRenderTargetStats().allocations << " render targets created without a resize" << std::endl;
+        return 1;
+    }
+
+    if (options.maxP99 > 0.0 && tickStats.getPercentile(99.0) > options.maxP99) {
+        std::cerr << "p99 tick time " << tickStats.getPercentile(99.0) << " ms exceeds " << options.maxP99 << " ms" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "PhysicsWorld.h"
+#include <algorithm>
+
+constexpr float PhysicsWorld::FIXED_TIMESTEP;
+constexpr float PhysicsWorld::GRAVITY;
+constexpr float PhysicsWorld::TERMINAL_VELOCITY;
+
+// Constructor
+PhysicsWorld::PhysicsWorld(const World* world)
+    : m_world(world), m_collider(world), m_unloadedChunkCount(world->getUnloadedChunkCount()), m_accumulator(0.0f) {
+}
+
+// Create a body
+uint32_t PhysicsWorld::createBody(const glm::vec3& position, const glm::vec3& size, float gravityScale, float stepHeight) {
+    PhysicsBody body;
+    body.position = position;
+    body.previousPosition = position;
+    body.size = size;
+    body.velocity = glm::vec3(0.0f);
+    body.gravityScale = gravityScale;
+    body.stepHeight = stepHeight;
+    body.onGround = false;
+    body.alive = true;
+    body.chunkHint = nullptr;
+
+    if (!m_freeIds.empty()) {
+        uint32_t id = m_freeIds.back();
+        m_freeIds.pop_back();
+        m_bodies[id] = body;
+        return id;
+    }
+
+    m_bodies.push_back(body);
+    return static_cast<uint32_t>(m_bodies.size() - 1);
+}
+
+// Destroy a body
+void PhysicsWorld::destroyBody(uint32_t id) {
+    if (id >= m_bodies.size() || !m_bodies[id].alive) {
+        return;
+    }
+
+    m_bodies[id].alive = false;
+    m_freeIds.push_back(id);
+}
+
+// Advance by deltaTime in fixed steps
+int PhysicsWorld::update(float deltaTime) {
+    m_accumulator += deltaTime;
+
+    int steps = 0;
+    while (m_accumulator >= FIXED_TIMESTEP && steps < MAX_STEPS_PER_UPDATE) {
+        step();
+        m_accumulator -= FIXED_TIMESTEP;
+        steps++;
+    }
+
+    // Too far behind, drop the rest
+    if (steps == MAX_STEPS_PER_UPDATE) {
+        m_accumulator = std::min(m_accumulator, FIXED_TIMESTEP);
+    }
+
+    return steps;
+}
+
+// Run a single fixed step
+void PhysicsWorld::step() {
+    // Chunk hints may point at unloaded chunks
+    if (m_world->getUnloadedChunkCount() != m_unloadedChunkCount) {
+        m_unloadedChunkCount = m_world->getUnloadedChunkCount();
+        
+        for (size_t i = 0; i < m_bodies.size(); i++) {
+            m_bodies[i].chunkHint = nullptr;
+        }
+    }
+
+    for (size_t i = 0; i < m_bodies.size(); i++) {
+        PhysicsBody& body = m_bodies[i];
+
+        if (body.alive) {
+            stepBody(body, FIXED_TIMESTEP);
+        }
+    }
+}
+
+// Get body position interpolated between the last two steps
+glm::vec3 PhysicsWorld::getInterpolatedPosition(uint32_t id) const {
+    const PhysicsBody& body = m_bodies[id];
+    return glm::mix(body.previousPosition, body.position, getInterpolationAlpha());
+}
+
+// Step one body
+void PhysicsWorld::stepBody(PhysicsBody& body, float deltaTime) const {
+    body.previousPosition = body.position;
+
+    // Gravity
+    if (body.gravityScale != 0.0f) {
+        body.velocity.y = std::max(body.velocity.y - GRAVITY * body.gravityScale * deltaTime, -TERMINAL_VELOCITY);
+    }
+
+    glm::vec3 displacement = body.velocity * deltaTime;
+    if (displacement == glm::vec3(0.0f)) {
+        return;
+    }
+
+    // Box around the body
+    glm::vec3 halfSize(body.size.x * 0.5f, 0.0f, body.size.z * 0.5f);
+    AABB box = {body.position - halfSize, body.position + halfSize + glm::vec3(0.0f, body.size.y, 0.0f)};
+
+    MoveResult result = m_collider.move(box, displacement, body.stepHeight, body.onGround, body.chunkHint);
+
+    body.position += result.displacement;
+    body.onGround = result.onGround;
+
+    // Blocked axes lose their velocity
+    for (int axis = 0; axis < 3; axis++) {
+        if (result.collided[axis]) {
+            body.velocity[axis] = 0.0f;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "VoxelCollider.h"
+#include <cstdint>
+#include <vector>
+
+// Physics body (box standing on its bottom center)
+struct PhysicsBody {
+    glm::vec3 position;             // Center of the bottom face
+    glm::vec3 previousPosition;     // Position before the last step (for interpolation)
+    glm::vec3 size;                 // Width, height, depth
+    glm::vec3 velocity;
+    float gravityScale;             // 0 for flying bodies
+    float stepHeight;               // Highest ledge walked up without jumping
+    bool onGround;
+    bool alive;
+    const Chunk* chunkHint;         // Chunk under the body, kept by the collider
+};
+
+// Physics world class
+//
+// Steps bodies against the voxel world at a fixed timestep. Bodies live in one
+// contiguous array and are addressed by index, so stepping thousands of them is
+// a linear walk with no virtual calls; each body keeps a chunk hint so its
+// collision queries read chunk data directly.
+class PhysicsWorld {
+public:
+    // Fixed simulation step (seconds)
+    static constexpr float FIXED_TIMESTEP = 1.0f / 60.0f;
+
+    // Most steps run per update before dropping time (avoids spiraling when behind)
+    static const int MAX_STEPS_PER_UPDATE = 5;
+
+    // Gravity acceleration (blocks per second squared)
+    static constexpr float GRAVITY = 28.0f;
+
+    // Fastest falling speed (blocks per second)
+    static constexpr float TERMINAL_VELOCITY = 60.0f;
+
+    PhysicsWorld(const World* world);
+
+    // Create a body, returns its id
+    uint32_t createBody(const glm::vec3& position, const glm::vec3& size, float gravityScale = 1.0f, float stepHeight = 1.0f);
+
+    // Destroy a body (its id may be reused)
+    void destroyBody(uint32_t id);
+
+    // Get body by id
+    PhysicsBody& getBody(uint32_t id) { return m_bodies[id]; }
+    const PhysicsBody& getBody(uint32_t id) const { return m_bodies[id]; }
+
+    // Get number of live bodies
+    size_t getBodyCount() const { return m_bodies.size() - m_freeIds.size(); }
+
+    // Advance by deltaTime in fixed steps, returns the number of steps run
+    int update(float deltaTime);
+
+    // Run a single fixed step
+    void step();
+
+    // Get fraction of a step left over after the last update (for interpolating between steps)
+    float getInterpolationAlpha() const { return m_accumulator / FIXED_TIMESTEP; }
+
+    // Get body position interpolated between the last two steps
+    glm::vec3 getInterpolatedPosition(uint32_t id) const;
+
+    // Get the voxel collider
+    const VoxelCollider& getCollider() const { return m_collider; }
+
+private:
+    // World bodies collide with
+    const World* m_world;
+
+    // Collision against world blocks
+    VoxelCollider m_collider;
+
+    // World unload count the chunk hints were taken at
+    uint64_t m_unloadedChunkCount;
+
+    // Bodies (dead ones are kept in place for id reuse)
+    std::vector<PhysicsBody> m_bodies;
+    std::vector<uint32_t> m_freeIds;
+
+    // Time not yet simulated
+    float m_accumulator;
+
+    // Step one body
+    void stepBody(PhysicsBody& body, float deltaTime) const;
+};
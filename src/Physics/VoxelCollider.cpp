@@ -0,0 +1,258 @@
+#include "VoxelCollider.h"
+#include <algorithm>
+#include <cmath>
+
+// Gap kept between boxes and the blocks they rest against
+static const float SKIN = 0.001f;
+
+// Integer division rounding towards negative infinity
+static int floorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// Floor a coordinate to its block
+static int toBlock(float value) {
+    return static_cast<int>(std::floor(value));
+}
+
+// Constructor
+VoxelCollider::VoxelCollider(const World* world)
+    : m_world(world) {
+    for (int type = 0; type < static_cast<int>(BlockType::Count); type++) {
+        m_solid[type] = Block::isSolid(static_cast<BlockType>(type));
+    }
+}
+
+// Move box by displacement
+MoveResult VoxelCollider::move(AABB& box, const glm::vec3& displacement, float stepHeight, bool onGround, const Chunk*& chunkHint) const {
+    MoveResult result;
+
+    // Broadphase: nothing to hit in the chunk sections the movement covers (plus the blocks touching it)
+    glm::vec3 margin(SKIN * 10.0f);
+    AABB swept = {glm::min(box.min, box.min + displacement) - margin, glm::max(box.max, box.max + displacement) + margin};
+    if (isRegionEmpty(swept, chunkHint)) {
+        box.min += displacement;
+        box.max += displacement;
+        result.displacement = displacement;
+        result.collided[0] = result.collided[1] = result.collided[2] = false;
+        result.onGround = false;
+        return result;
+    }
+
+    AABB start = box;
+    result = sweep(box, displacement, chunkHint);
+
+    // Blocked sideways while standing: retry lifted by the step height and settle back down
+    bool blockedSideways = result.collided[0] || result.collided[2];
+    if (stepHeight > 0.0f && blockedSideways && (onGround || result.onGround)) {
+        AABB stepped = start;
+        const Chunk* stepHint = chunkHint;
+
+        float up = sweepAxis(stepped, 1, stepHeight, stepHint);
+        stepped.min.y += up;
+        stepped.max.y += up;
+
+        MoveResult stepResult = sweep(stepped, glm::vec3(displacement.x, 0.0f, displacement.z), stepHint);
+
+        float down = sweepAxis(stepped, 1, -up, stepHint);
+        stepped.min.y += down;
+        stepped.max.y += down;
+
+        glm::vec3 stepDisplacement = stepped.min - start.min;
+        float stepDistance = stepDisplacement.x * stepDisplacement.x + stepDisplacement.z * stepDisplacement.z;
+        float distance = result.displacement.x * result.displacement.x + result.displacement.z * result.displacement.z;
+
+        if (stepDistance > distance) {
+            box = stepped;
+            chunkHint = stepHint;
+            result.displacement = stepDisplacement;
+            result.collided[0] = stepResult.collided[0];
+            result.collided[2] = stepResult.collided[2];
+            result.onGround = true;
+        }
+    }
+
+    // Keep the hint on the chunk under the box
+    glm::vec3 center = (box.min + box.max) * 0.5f;
+    const Chunk* chunk = findChunk(floorDiv(toBlock(center.x), CHUNK_SIZE), floorDiv(toBlock(center.z), CHUNK_SIZE), chunkHint);
+    if (chunk) {
+        chunkHint = chunk;
+    }
+
+    return result;
+}
+
+// Check if the box overlaps any solid block
+bool VoxelCollider::overlapsSolid(const AABB& box, const Chunk*& chunkHint) const {
+    int minX = toBlock(box.min.x + SKIN), maxX = toBlock(box.max.x - SKIN);
+    int minY = toBlock(box.min.y + SKIN), maxY = toBlock(box.max.y - SKIN);
+    int minZ = toBlock(box.min.z + SKIN), maxZ = toBlock(box.max.z - SKIN);
+
+    for (int y = minY; y <= maxY; y++) {
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = minX; x <= maxX; x++) {
+                if (isSolidAt(x, y, z, chunkHint)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// Check if the box only covers empty chunk sections
+bool VoxelCollider::isRegionEmpty(const AABB& box, const Chunk*& chunkHint) const {
+    int minY = toBlock(box.min.y);
+    int maxY = std::min(toBlock(box.max.y), CHUNK_HEIGHT - 1);
+
+    if (minY < 0) {
+        return false;
+    }
+    if (minY > maxY) {
+        return true;
+    }
+
+    int minChunkX = floorDiv(toBlock(box.min.x), CHUNK_SIZE), maxChunkX = floorDiv(toBlock(box.max.x), CHUNK_SIZE);
+    int minChunkZ = floorDiv(toBlock(box.min.z), CHUNK_SIZE), maxChunkZ = floorDiv(toBlock(box.max.z), CHUNK_SIZE);
+
+    for (int chunkZ = minChunkZ; chunkZ <= maxChunkZ; chunkZ++) {
+        for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+            const Chunk* chunk = findChunk(chunkX, chunkZ, chunkHint);
+            if (!chunk) {
+                return false;
+            }
+            chunkHint = chunk;
+
+            for (int section = minY / SECTION_HEIGHT; section <= maxY / SECTION_HEIGHT; section++) {
+                if (chunk->getSectionBlockCount(section) > 0) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Find the loaded chunk at chunk position
+const Chunk* VoxelCollider::findChunk(int chunkX, int chunkZ, const Chunk* hint) const {
+    if (hint) {
+        int dx = chunkX - hint->getPosition().x;
+        int dz = chunkZ - hint->getPosition().z;
+
+        if (dx == 0 && dz == 0) {
+            return hint;
+        }
+
+        // Nearby chunks through the neighbor links
+        if (dx >= -1 && dx <= 1 && dz >= -1 && dz <= 1) {
+            const Chunk* chunk = hint;
+            if (dx != 0) {
+                chunk = chunk->getNeighbor(dx < 0 ? BlockFace::Left : BlockFace::Right);
+            }
+            if (chunk && dz != 0) {
+                chunk = chunk->getNeighbor(dz < 0 ? BlockFace::Back : BlockFace::Front);
+            }
+            if (chunk) {
+                return chunk;
+            }
+        }
+    }
+
+    return m_world->findChunk(chunkX, chunkZ);
+}
+
+// Check if the block at world position blocks movement
+bool VoxelCollider::isSolidAt(int x, int y, int z, const Chunk*& chunkHint) const {
+    if (y < 0) {
+        return true;
+    }
+    if (y >= CHUNK_HEIGHT) {
+        return false;
+    }
+
+    int chunkX = floorDiv(x, CHUNK_SIZE);
+    int chunkZ = floorDiv(z, CHUNK_SIZE);
+    const Chunk* chunk = findChunk(chunkX, chunkZ, chunkHint);
+    if (!chunk) {
+        return true;
+    }
+    chunkHint = chunk;
+
+    BlockType type = chunk->getBlockUnchecked(x - chunkX * CHUNK_SIZE, y, z - chunkZ * CHUNK_SIZE);
+    return m_solid[static_cast<int>(type)];
+}
+
+// Clamp movement of box along axis
+float VoxelCollider::sweepAxis(const AABB& box, int axis, float distance, const Chunk*& chunkHint) const {
+    if (distance == 0.0f) {
+        return 0.0f;
+    }
+
+    // Blocks covered on the two other axes
+    int other[2] = {(axis + 1) % 3, (axis + 2) % 3};
+    int minOther[2], maxOther[2];
+    for (int i = 0; i < 2; i++) {
+        minOther[i] = toBlock(box.min[other[i]] + SKIN);
+        maxOther[i] = static_cast<int>(std::ceil(box.max[other[i]] - SKIN)) - 1;
+    }
+
+    // Block slices in front of the leading face, nearest first
+    int first, last, direction;
+    if (distance > 0.0f) {
+        float leading = box.max[axis];
+        first = static_cast<int>(std::ceil(leading - SKIN));
+        last = static_cast<int>(std::ceil(leading + distance)) - 1;
+        direction = 1;
+    } else {
+        float leading = box.min[axis];
+        first = toBlock(leading + SKIN) - 1;
+        last = toBlock(leading + distance);
+        direction = -1;
+    }
+
+    for (int slice = first; (last - slice) * direction >= 0; slice += direction) {
+        int block[3];
+        block[axis] = slice;
+
+        for (int a = minOther[0]; a <= maxOther[0]; a++) {
+            block[other[0]] = a;
+
+            for (int b = minOther[1]; b <= maxOther[1]; b++) {
+                block[other[1]] = b;
+
+                if (isSolidAt(block[0], block[1], block[2], chunkHint)) {
+                    // Stop just short of the slice
+                    if (direction > 0) {
+                        return std::max(0.0f, slice - SKIN - box.max[axis]);
+                    }
+                    return std::min(0.0f, slice + 1.0f + SKIN - box.min[axis]);
+                }
+            }
+        }
+    }
+
+    return distance;
+}
+
+// Move box along y, x and z in turn
+MoveResult VoxelCollider::sweep(AABB& box, const glm::vec3& displacement, const Chunk*& chunkHint) const {
+    static const int AXIS_ORDER[3] = {1, 0, 2};
+
+    MoveResult result;
+    result.displacement = glm::vec3(0.0f);
+
+    for (int i = 0; i < 3; i++) {
+        int axis = AXIS_ORDER[i];
+        float allowed = sweepAxis(box, axis, displacement[axis], chunkHint);
+
+        result.collided[axis] = allowed != displacement[axis];
+        result.displacement[axis] = allowed;
+        box.min[axis] += allowed;
+        box.max[axis] += allowed;
+    }
+
+    result.onGround = result.collided[1] && displacement.y < 0.0f;
+    return result;
+}
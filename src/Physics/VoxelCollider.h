@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Voxel/World.h"
+#include <glm/glm.hpp>
+
+// Axis-aligned bounding box
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// Result of moving a box through the world
+struct MoveResult {
+    glm::vec3 displacement;     // Displacement actually applied
+    bool collided[3];           // Movement was blocked along x, y, z
+    bool onGround;              // Box ended resting on a solid block
+};
+
+// Voxel collider class
+//
+// Sweeps axis-aligned boxes through the solid blocks of a World one axis at a
+// time (y, then x, then z), clamping the movement at the first solid block slice
+// in the way, so fast boxes cannot tunnel. Blocks are read chunk-locally: the
+// caller keeps a chunk hint per box and lookups near it follow the chunk neighbor
+// links, so the hot path makes no map lookups. Unloaded chunks and everything
+// below the world count as solid.
+class VoxelCollider {
+public:
+    VoxelCollider(const World* world);
+
+    // Move box by displacement, stepping up ledges of at most stepHeight while on the ground.
+    // chunkHint is a chunk near the box (may be null) and is updated to the chunk under the box.
+    MoveResult move(AABB& box, const glm::vec3& displacement, float stepHeight, bool onGround, const Chunk*& chunkHint) const;
+
+    // Check if the box overlaps any solid block
+    bool overlapsSolid(const AABB& box, const Chunk*& chunkHint) const;
+
+    // Check if the box only covers empty chunk sections (broadphase, conservative)
+    bool isRegionEmpty(const AABB& box, const Chunk*& chunkHint) const;
+
+private:
+    // World to collide with
+    const World* m_world;
+
+    // Block property table
+    bool m_solid[static_cast<int>(BlockType::Count)];
+
+    // Find the loaded chunk at chunk position, starting from the hint
+    const Chunk* findChunk(int chunkX, int chunkZ, const Chunk* hint) const;
+
+    // Check if the block at world position blocks movement
+    bool isSolidAt(int x, int y, int z, const Chunk*& chunkHint) const;
+
+    // Clamp movement of box along axis by distance at the first solid slice, returns the allowed distance
+    float sweepAxis(const AABB& box, int axis, float distance, const Chunk*& chunkHint) const;
+
+    // Move box along y, x and z in turn
+    MoveResult sweep(AABB& box, const glm::vec3& displacement, const Chunk*& chunkHint) const;
+};
@@ -0,0 +1,188 @@
+#include "MeshHeap.h"
+#include <algorithm>
+#include <iterator>
+
+const uint32_t MeshHeap::DEFAULT_PAGE_SIZE;
+const uint32_t MeshHeap::ALIGNMENT;
+
+// Pack a page and offset into a size index value
+static uint64_t packLocation(uint32_t page, uint32_t offset) {
+    return (static_cast<uint64_t>(page) << 32) | offset;
+}
+
+// Constructor
+MeshHeap::MeshHeap(uint32_t pageSize, int framesInFlight, uint32_t alignment)
+    : m_alignment(std::max(alignment, 4u)),
+      m_pageSize(alignSize(std::max(pageSize, m_alignment))),
+      m_framesInFlight(framesInFlight),
+      m_frame(0),
+      m_capacityBytes(0),
+      m_usedBytes(0),
+      m_pendingFreeBytes(0),
+      m_allocations(0) {
+}
+
+// Allocate a range
+MeshAllocation MeshHeap::allocate(uint32_t size) {
+    MeshAllocation allocation = MeshAllocation();
+    if (size == 0) {
+        return allocation;
+    }
+
+    uint32_t alignedSize = alignSize(size);
+
+    // Smallest free range that fits, or a new page
+    auto it = m_freeBySize.lower_bound(std::make_pair(alignedSize, static_cast<uint64_t>(0)));
+    if (it == m_freeBySize.end()) {
+        addPage(std::max(alignedSize, m_pageSize));
+        it = m_freeBySize.lower_bound(std::make_pair(alignedSize, static_cast<uint64_t>(0)));
+    }
+
+    uint32_t rangeSize = it->first;
+    uint32_t page = static_cast<uint32_t>(it->second >> 32);
+    uint32_t offset = static_cast<uint32_t>(it->second);
+    m_freeBySize.erase(it);
+    m_freeByOffset[page].erase(offset);
+
+    // Keep the rest of the range free (it cannot merge, its neighbors were not free)
+    if (rangeSize > alignedSize) {
+        uint32_t restOffset = offset + alignedSize;
+        uint32_t restSize = rangeSize - alignedSize;
+        m_freeByOffset[page][restOffset] = restSize;
+        m_freeBySize.insert(std::make_pair(restSize, packLocation(page, restOffset)));
+    }
+
+    allocation.page = page;
+    allocation.offset = offset;
+    allocation.size = alignedSize;
+
+    m_usedBytes += alignedSize;
+    m_allocations++;
+    return allocation;
+}
+
+// Free an allocation after the frames in flight
+void MeshHeap::free(const MeshAllocation& allocation) {
+    if (!allocation.isValid()) {
+        return;
+    }
+
+    PendingFree pending;
+    pending.frame = m_frame;
+    pending.allocation = allocation;
+    m_pendingFrees.push_back(pending);
+
+    m_usedBytes -= allocation.size;
+    m_pendingFreeBytes += allocation.size;
+    m_allocations--;
+}
+
+// End a frame
+void MeshHeap::endFrame() {
+    m_frame++;
+
+    while (!m_pendingFrees.empty() && m_pendingFrees.front().frame + m_framesInFlight <= m_frame) {
+        const MeshAllocation& allocation = m_pendingFrees.front().allocation;
+        addFreeRange(allocation.page, allocation.offset, allocation.size);
+        m_pendingFreeBytes -= allocation.size;
+        m_pendingFrees.pop_front();
+    }
+}
+
+// Release all pending frees
+void MeshHeap::releasePendingFrees() {
+    for (const PendingFree& pending : m_pendingFrees) {
+        addFreeRange(pending.allocation.page, pending.allocation.offset, pending.allocation.size);
+    }
+    m_pendingFrees.clear();
+    m_pendingFreeBytes = 0;
+}
+
+// Get usage counters
+MeshHeap::Stats MeshHeap::getStats() const {
+    Stats stats;
+    stats.capacityBytes = m_capacityBytes;
+    stats.usedBytes = m_usedBytes;
+    stats.pendingFreeBytes = m_pendingFreeBytes;
+    stats.freeBytes = m_capacityBytes - m_usedBytes - m_pendingFreeBytes;
+    stats.largestFreeBytes = m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first;
+    stats.freeRanges = static_cast<uint32_t>(m_freeBySize.size());
+    stats.allocations = m_allocations;
+    return stats;
+}
+
+// Share of free bytes outside the largest free range
+double MeshHeap::getFragmentation() const {
+    Stats stats = getStats();
+    if (stats.freeBytes == 0) {
+        return 0.0;
+    }
+    return 1.0 - static_cast<double>(stats.largestFreeBytes) / static_cast<double>(stats.freeBytes);
+}
+
+// Check free range invariants
+bool MeshHeap::validate() const {
+    uint64_t freeBytes = 0;
+    size_t rangeCount = 0;
+
+    for (uint32_t page = 0; page < getPageCount(); page++) {
+        uint64_t end = 0;
+        bool first = true;
+
+        for (const auto& range : m_freeByOffset[page]) {
+            // Ranges must not overlap or touch (touching ranges are merged)
+            if (!first && range.first <= end) {
+                return false;
+            }
+            if (range.second == 0 || static_cast<uint64_t>(range.first) + range.second > m_pageSizes[page]) {
+                return false;
+            }
+
+            end = static_cast<uint64_t>(range.first) + range.second;
+            first = false;
+            freeBytes += range.second;
+            rangeCount++;
+        }
+    }
+
+    return rangeCount == m_freeBySize.size() &&
+           freeBytes + m_usedBytes + m_pendingFreeBytes == m_capacityBytes;
+}
+
+// Add a page
+void MeshHeap::addPage(uint32_t size) {
+    uint32_t page = getPageCount();
+    m_pageSizes.push_back(size);
+    m_freeByOffset.push_back(std::map<uint32_t, uint32_t>());
+    m_capacityBytes += size;
+
+    m_freeByOffset[page][0] = size;
+    m_freeBySize.insert(std::make_pair(size, packLocation(page, 0)));
+}
+
+// Add a free range, merging with adjacent ones
+void MeshHeap::addFreeRange(uint32_t page, uint32_t offset, uint32_t size) {
+    std::map<uint32_t, uint32_t>& ranges = m_freeByOffset[page];
+
+    // Merge with the following range
+    auto next = ranges.lower_bound(offset);
+    if (next != ranges.end() && next->first == offset + size) {
+        m_freeBySize.erase(std::make_pair(next->second, packLocation(page, next->first)));
+        size += next->second;
+        next = ranges.erase(next);
+    }
+
+    // Merge with the preceding range
+    if (next != ranges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            m_freeBySize.erase(std::make_pair(previous->second, packLocation(page, previous->first)));
+            offset = previous->first;
+            size += previous->second;
+            ranges.erase(previous);
+        }
+    }
+
+    ranges[offset] = size;
+    m_freeBySize.insert(std::make_pair(size, packLocation(page, offset)));
+}
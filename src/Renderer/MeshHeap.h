@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Range of a mesh heap page
+struct MeshAllocation {
+    uint32_t page;
+    uint32_t offset;
+    uint32_t size;      // 0 = no allocation
+
+    bool isValid() const { return size != 0; }
+};
+
+// Mesh heap class
+//
+// CPU-side sub-allocator for mesh data kept in a few large device buffers
+// ("pages"). Ranges are handed out best fit from a free list that coalesces
+// neighbors on free. Freed ranges may still be read by frames the device has
+// not finished, so they only return to the free list after framesInFlight
+// more frames ended. Knows nothing about the backend: the owner creates a
+// device buffer for each new page and uploads into the returned ranges.
+class MeshHeap {
+public:
+    // Default size of a page
+    static const uint32_t DEFAULT_PAGE_SIZE = 32 * 1024 * 1024;
+
+    // Default offset and size alignment of allocations
+    static const uint32_t ALIGNMENT = 256;
+
+    // Usage counters
+    struct Stats {
+        uint64_t capacityBytes;         // Bytes of all pages
+        uint64_t usedBytes;             // Bytes of live allocations (aligned)
+        uint64_t pendingFreeBytes;      // Bytes freed but still waiting for frames in flight
+        uint64_t freeBytes;             // Bytes ready to allocate
+        uint64_t largestFreeBytes;      // Largest range ready to allocate
+        uint32_t freeRanges;
+        uint32_t allocations;
+    };
+
+    // Create an empty heap, freed ranges are reused after framesInFlight more frames
+    explicit MeshHeap(uint32_t pageSize = DEFAULT_PAGE_SIZE, int framesInFlight = 3, uint32_t alignment = ALIGNMENT);
+
+    // Allocate size bytes, adding a page when no free range fits (invalid for size 0)
+    MeshAllocation allocate(uint32_t size);
+
+    // Free an allocation once the frames in flight finished (invalid allocations are ignored)
+    void free(const MeshAllocation& allocation);
+
+    // End a frame, releasing ranges freed framesInFlight frames ago
+    void endFrame();
+
+    // Release all pending frees immediately (the device must be idle)
+    void releasePendingFrees();
+
+    // Get number of pages (new pages are added at the end)
+    uint32_t getPageCount() const { return static_cast<uint32_t>(m_pageSizes.size()); }
+
+    // Get size of a page
+    uint32_t getPageSize(uint32_t page) const { return m_pageSizes[page]; }
+
+    // Get offset and size alignment of allocations
+    uint32_t getAlignment() const { return m_alignment; }
+
+    // Get usage counters
+    Stats getStats() const;
+
+    // Share of free bytes outside the largest free range (0 = one contiguous range)
+    double getFragmentation() const;
+
+    // Check that free ranges are sorted, coalesced and inside their pages, returns false if not
+    bool validate() const;
+
+private:
+    // Freed range waiting for frames in flight
+    struct PendingFree {
+        uint64_t frame;
+        MeshAllocation allocation;
+    };
+
+    // Offset and size alignment of allocations (not only powers of two)
+    uint32_t m_alignment;
+
+    // Size of new pages
+    uint32_t m_pageSize;
+
+    // Frames the device may still be reading
+    int m_framesInFlight;
+
+    // Sizes of all pages
+    std::vector<uint32_t> m_pageSizes;
+
+    // Free ranges per page by offset, used to coalesce
+    std::vector<std::map<uint32_t, uint32_t>> m_freeByOffset;
+
+    // Free ranges of all pages by size, then location (page << 32 | offset), used for best fit
+    std::set<std::pair<uint32_t, uint64_t>> m_freeBySize;
+
+    // Frees waiting for frames in flight, oldest first
+    std::deque<PendingFree> m_pendingFrees;
+
+    // Frames ended so far
+    uint64_t m_frame;
+
+    // Counters
+    uint64_t m_capacityBytes;
+    uint64_t m_usedBytes;
+    uint64_t m_pendingFreeBytes;
+    uint32_t m_allocations;
+
+    // Round up to the allocation alignment
+    uint32_t alignSize(uint32_t size) const { return (size + m_alignment - 1) / m_alignment * m_alignment; }
+
+    // Add a page of at least size bytes
+    void addPage(uint32_t size);
+
+    // Add a free range, merging it with adjacent free ranges
+    void addFreeRange(uint32_t page, uint32_t offset, uint32_t size);
+};
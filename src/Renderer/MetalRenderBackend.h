@@ -0,0 +1,45 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+// Forward declarations
+class Window;
+
+// Metal render backend class
+//
+// Draws into the window's CAMetalLayer with the voxel shader pipeline.
+class MetalRenderBackend : public RenderBackend {
+public:
+    MetalRenderBackend(Window* window);
+    ~MetalRenderBackend();
+
+    // Delete copy constructor and assignment operator
+    MetalRenderBackend(const MetalRenderBackend&) = delete;
+    MetalRenderBackend& operator=(const MetalRenderBackend&) = delete;
+
+    // RenderBackend
+    bool init() override;
+    RenderHandle createBuffer(const void* data, size_t size) override;
+    void updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) override;
+    void destroyBuffer(RenderHandle buffer) override;
+    RenderHandle createTexture(const uint32_t* pixels, int width, int height) override;
+    void destroyTexture(RenderHandle texture) override;
+    RenderHandle createRenderTarget(int width, int height, RenderTargetFormat format) override;
+    RenderTargetStats getRenderTargetStats() const override;
+    bool beginFrame(const glm::vec4& clearColor) override;
+    void setTexture(RenderHandle texture) override;
+    void setUniforms(const DrawUniforms& uniforms) override;
+    void drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) override;
+    void setFrameUniforms(const FrameUniforms& uniforms) override;
+    void setInstanceBuffer(RenderHandle buffer, size_t offset) override;
+    void drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) override;
+    void endFrame() override;
+
+private:
+    // Window reference
+    Window* m_window;
+
+    // Implementation details are hidden in the .mm file
+    struct Impl;
+    Impl* m_impl;
+};
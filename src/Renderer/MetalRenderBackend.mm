@@ -0,0 +1,480 @@
+#include "MetalRenderBackend.h"
+#include "RenderTargetPool.h"
+#include "../Window.h"
+#include "../Voxel/Chunk.h"
+
+#import <Metal/Metal.h>
+#import <MetalKit/MetalKit.h>
+#import <QuartzCore/CAMetalLayer.h>
+#import <simd/simd.h>
+
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <string>
+
+// Uniform buffer for transformation matrices
+struct Uniforms {
+    simd::float4x4 modelMatrix;
+    simd::float4x4 viewMatrix;
+    simd::float4x4 projectionMatrix;
+};
+
+// Uniform buffer shared by the draws of batches
+struct BatchUniforms {
+    simd::float4x4 viewMatrix;
+    simd::float4x4 projectionMatrix;
+};
+
+// Implementation details for the Metal backend
+struct MetalRenderBackend::Impl {
+    id<MTLDevice> device;
+    id<MTLCommandQueue> commandQueue;
+    id<MTLLibrary> library;
+    id<MTLRenderPipelineState> pipelineState;
+    id<MTLRenderPipelineState> batchPipelineState;
+    id<MTLDepthStencilState> depthStencilState;
+    id<MTLSamplerState> samplerState;
+    
+    // Frame being encoded
+    id<CAMetalDrawable> drawable;
+    id<MTLCommandBuffer> commandBuffer;
+    id<MTLRenderCommandEncoder> currentRenderEncoder;
+    bool batchPipelineBound;
+    
+    // Buffers and textures by handle
+    std::unordered_map<RenderHandle, id<MTLBuffer>> buffers;
+    std::unordered_map<RenderHandle, id<MTLTexture>> textures;
+    RenderHandle nextHandle;
+    
+    // Depth attachments reused across frames
+    RenderTargetPool* renderTargets;
+    
+    // Limits frames the device may still be reading to MAX_FRAMES_IN_FLIGHT
+    dispatch_semaphore_t frameSemaphore;
+};
+
+// Helper function to convert glm::mat4 to simd::float4x4
+simd::float4x4 glmToSIMD(const glm::mat4& matrix) {
+    simd::float4x4 result;
+    
+    // Create each column vector
+    simd::float4 col0 = {matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]};
+    simd::float4 col1 = {matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]};
+    simd::float4 col2 = {matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]};
+    simd::float4 col3 = {matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]};
+    
+    // Assign to columns
+    result.columns[0] = col0;
+    result.columns[1] = col1;
+    result.columns[2] = col2;
+    result.columns[3] = col3;
+    
+    return result;
+}
+
+// Constructor
+MetalRenderBackend::MetalRenderBackend(Window* window)
+    : m_window(window), m_impl(new Impl()) {
+    m_impl->nextHandle = 1;
+    m_impl->renderTargets = new RenderTargetPool(this);
+    m_impl->frameSemaphore = dispatch_semaphore_create(MAX_FRAMES_IN_FLIGHT);
+}
+
+// Destructor
+MetalRenderBackend::~MetalRenderBackend() {
+    delete m_impl->renderTargets;
+    delete m_impl;
+}
+
+// Initialize the backend
+bool MetalRenderBackend::init() {
+    // Get Metal device from MetalRenderer
+    // In a real implementation, we would get this from the MetalRenderer
+    m_impl->device = MTLCreateSystemDefaultDevice();
+    if (!m_impl->device) {
+        std::cerr << "Failed to create Metal device!" << std::endl;
+        return false;
+    }
+    
+    // Create command queue
+    m_impl->commandQueue = [m_impl->device newCommandQueue];
+    if (!m_impl->commandQueue) {
+        std::cerr << "Failed to create command queue!" << std::endl;
+        return false;
+    }
+    
+    // Load Metal library from file
+    NSString* libraryPath = [NSString stringWithUTF8String:"VoxelShaders.metallib"];
+    NSError* error = nil;
+    m_impl->library = [m_impl->device newLibraryWithFile:libraryPath error:&error];
+    
+    if (!m_impl->library) {
+        std::cerr << "Failed to load Metal library from file: " << [error.localizedDescription UTF8String] << std::endl;
+        
+        // Try to load default library as fallback
+        m_impl->library = [m_impl->device newDefaultLibrary];
+        if (!m_impl->library) {
+            std::cerr << "Failed to load default Metal library!" << std::endl;
+            return false;
+        }
+    }
+    
+    // Create render pipeline state
+    MTLRenderPipelineDescriptor* pipelineDescriptor = [[MTLRenderPipelineDescriptor alloc] init];
+    
+    // Set vertex and fragment functions
+    id<MTLFunction> vertexFunction = [m_impl->library newFunctionWithName:@"voxelVertexShader"];
+    id<MTLFunction> fragmentFunction = [m_impl->library newFunctionWithName:@"voxelFragmentShader"];
+    
+    if (!vertexFunction || !fragmentFunction) {
+        std::cerr << "Failed to load shader functions!" << std::endl;
+        return false;
+    }
+    
+    pipelineDescriptor.vertexFunction = vertexFunction;
+    pipelineDescriptor.fragmentFunction = fragmentFunction;
+    
+    // Set pixel format
+    pipelineDescriptor.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    pipelineDescriptor.depthAttachmentPixelFormat = MTLPixelFormatDepth32Float;
+    
+    // Create vertex descriptor
+    MTLVertexDescriptor* vertexDescriptor = [MTLVertexDescriptor vertexDescriptor];
+    
+    // Position attribute
+    vertexDescriptor.attributes[0].format = MTLVertexFormatFloat3;
+    vertexDescriptor.attributes[0].offset = offsetof(ChunkVertex, position);
+    vertexDescriptor.attributes[0].bufferIndex = 0;
+    
+    // Texture coordinate attribute
+    vertexDescriptor.attributes[1].format = MTLVertexFormatFloat2;
+    vertexDescriptor.attributes[1].offset = offsetof(ChunkVertex, texCoord);
+    vertexDescriptor.attributes[1].bufferIndex = 0;
+    
+    // Normal attribute
+    vertexDescriptor.attributes[2].format = MTLVertexFormatFloat3;
+    vertexDescriptor.attributes[2].offset = offsetof(ChunkVertex, normal);
+    vertexDescriptor.attributes[2].bufferIndex = 0;
+    
+    // Color attribute
+    vertexDescriptor.attributes[3].format = MTLVertexFormatFloat4;
+    vertexDescriptor.attributes[3].offset = offsetof(ChunkVertex, color);
+    vertexDescriptor.attributes[3].bufferIndex = 0;
+    
+    // Buffer layout
+    vertexDescriptor.layouts[0].stride = sizeof(ChunkVertex);
+    vertexDescriptor.layouts[0].stepRate = 1;
+    vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
+    
+    pipelineDescriptor.vertexDescriptor = vertexDescriptor;
+    
+    // Create pipeline state
+    error = nil;
+    m_impl->pipelineState = [m_impl->device newRenderPipelineStateWithDescriptor:pipelineDescriptor error:&error];
+    
+    if (!m_impl->pipelineState) {
+        std::cerr << "Failed to create render pipeline state: " << [error.localizedDescription UTF8String] << std::endl;
+        return false;
+    }
+    
+    // Create batch pipeline state (same layout, transforms from frame uniforms and instances)
+    id<MTLFunction> batchVertexFunction = [m_impl->library newFunctionWithName:@"voxelBatchVertexShader"];
+    if (!batchVertexFunction) {
+        std::cerr << "Failed to load batch shader function!" << std::endl;
+        return false;
+    }
+    
+    pipelineDescriptor.vertexFunction = batchVertexFunction;
+    m_impl->batchPipelineState = [m_impl->device newRenderPipelineStateWithDescriptor:pipelineDescriptor error:&error];
+    
+    if (!m_impl->batchPipelineState) {
+        std::cerr << "Failed to create batch pipeline state: " << [error.localizedDescription UTF8String] << std::endl;
+        return false;
+    }
+    
+    // Create depth stencil state
+    MTLDepthStencilDescriptor* depthStencilDescriptor = [[MTLDepthStencilDescriptor alloc] init];
+    depthStencilDescriptor.depthCompareFunction = MTLCompareFunctionLess;
+    depthStencilDescriptor.depthWriteEnabled = YES;
+    
+    m_impl->depthStencilState = [m_impl->device newDepthStencilStateWithDescriptor:depthStencilDescriptor];
+    
+    // Create sampler state
+    MTLSamplerDescriptor* samplerDescriptor = [[MTLSamplerDescriptor alloc] init];
+    samplerDescriptor.minFilter = MTLSamplerMinMagFilterNearest;
+    samplerDescriptor.magFilter = MTLSamplerMinMagFilterNearest;
+    samplerDescriptor.mipFilter = MTLSamplerMipFilterNearest;
+    samplerDescriptor.sAddressMode = MTLSamplerAddressModeRepeat;
+    samplerDescriptor.tAddressMode = MTLSamplerAddressModeRepeat;
+    
+    m_impl->samplerState = [m_impl->device newSamplerStateWithDescriptor:samplerDescriptor];
+    
+    return true;
+}
+
+// Create a buffer
+RenderHandle MetalRenderBackend::createBuffer(const void* data, size_t size) {
+    id<MTLBuffer> buffer = data ? [m_impl->device newBufferWithBytes:data length:size options:MTLResourceStorageModeShared]
+                                : [m_impl->device newBufferWithLength:size options:MTLResourceStorageModeShared];
+    if (!buffer) {
+        std::cerr << "Failed to create buffer of " << size << " bytes!" << std::endl;
+        return 0;
+    }
+    
+    RenderHandle handle = m_impl->nextHandle++;
+    m_impl->buffers[handle] = buffer;
+    return handle;
+}
+
+// Copy data into a buffer
+void MetalRenderBackend::updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) {
+    auto it = m_impl->buffers.find(buffer);
+    if (it == m_impl->buffers.end() || offset + size > [it->second length]) {
+        return;
+    }
+    
+    // Shared storage is visible to the device without a blit
+    std::memcpy(static_cast<uint8_t*>([it->second contents]) + offset, data, size);
+}
+
+// Destroy a buffer
+void MetalRenderBackend::destroyBuffer(RenderHandle buffer) {
+    // Metal keeps the buffer alive until command buffers using it completed
+    m_impl->buffers.erase(buffer);
+}
+
+// Create a texture
+RenderHandle MetalRenderBackend::createTexture(const uint32_t* pixels, int width, int height) {
+    // Create texture descriptor
+    MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA8Unorm
+                                                                                                 width:width
+                                                                                                height:height
+                                                                                             mipmapped:YES];
+    
+    // Create texture
+    id<MTLTexture> texture = [m_impl->device newTextureWithDescriptor:textureDescriptor];
+    if (!texture) {
+        std::cerr << "Failed to create texture!" << std::endl;
+        return 0;
+    }
+    
+    // Upload texture data
+    MTLRegion region = MTLRegionMake2D(0, 0, width, height);
+    [texture replaceRegion:region mipmapLevel:0 withBytes:pixels bytesPerRow:width * sizeof(uint32_t)];
+    
+    // Generate mipmaps
+    id<MTLCommandBuffer> commandBuffer = [m_impl->commandQueue commandBuffer];
+    id<MTLBlitCommandEncoder> blitEncoder = [commandBuffer blitCommandEncoder];
+    [blitEncoder generateMipmapsForTexture:texture];
+    [blitEncoder endEncoding];
+    [commandBuffer commit];
+    
+    RenderHandle handle = m_impl->nextHandle++;
+    m_impl->textures[handle] = texture;
+    return handle;
+}
+
+// Destroy a texture
+void MetalRenderBackend::destroyTexture(RenderHandle texture) {
+    m_impl->textures.erase(texture);
+}
+
+// Begin a frame
+bool MetalRenderBackend::beginFrame(const glm::vec4& clearColor) {
+    // Get Metal layer
+    NSWindow* nsWindow = (__bridge NSWindow*)m_window->getNativeWindow();
+    NSView* contentView = [nsWindow contentView];
+    
+    // Make sure the view's layer is a CAMetalLayer
+    if (![contentView.layer isKindOfClass:[CAMetalLayer class]]) {
+        // Set the view to use a metal layer
+        [contentView setWantsLayer:YES];
+        CAMetalLayer* metalLayer = [CAMetalLayer layer];
+        metalLayer.device = m_impl->device;
+        metalLayer.pixelFormat = MTLPixelFormatBGRA8Unorm;
+        metalLayer.framebufferOnly = YES;
+        contentView.layer = metalLayer;
+    }
+    
+    CAMetalLayer* metalLayer = (CAMetalLayer*)contentView.layer;
+    
+    // Wait until the device finished the frame MAX_FRAMES_IN_FLIGHT frames ago
+    dispatch_semaphore_wait(m_impl->frameSemaphore, DISPATCH_TIME_FOREVER);
+    
+    // Get drawable
+    m_impl->drawable = [metalLayer nextDrawable];
+    if (!m_impl->drawable) {
+        std::cerr << "Failed to get next drawable" << std::endl;
+        dispatch_semaphore_signal(m_impl->frameSemaphore);
+        return false;
+    }
+    
+    // Create render pass descriptor
+    MTLRenderPassDescriptor* renderPassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
+    renderPassDescriptor.colorAttachments[0].texture = m_impl->drawable.texture;
+    renderPassDescriptor.colorAttachments[0].loadAction = MTLLoadActionClear;
+    renderPassDescriptor.colorAttachments[0].storeAction = MTLStoreActionStore;
+    renderPassDescriptor.colorAttachments[0].clearColor = MTLClearColorMake(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    
+    // Get a depth texture of the drawable size (only created on the first frame and after a resize)
+    RenderHandle depthTarget = m_impl->renderTargets->acquire(static_cast<int>(m_impl->drawable.texture.width),
+                                                               static_cast<int>(m_impl->drawable.texture.height),
+                                                               RenderTargetFormat::Depth32Float);
+    if (!depthTarget) {
+        m_impl->drawable = nil;
+        dispatch_semaphore_signal(m_impl->frameSemaphore);
+        return false;
+    }
+    
+    renderPassDescriptor.depthAttachment.texture = m_impl->textures[depthTarget];
+    renderPassDescriptor.depthAttachment.loadAction = MTLLoadActionClear;
+    renderPassDescriptor.depthAttachment.storeAction = MTLStoreActionDontCare;
+    renderPassDescriptor.depthAttachment.clearDepth = 1.0;
+    
+    // Create command buffer
+    m_impl->commandBuffer = [m_impl->commandQueue commandBuffer];
+    
+    // Create render command encoder
+    m_impl->currentRenderEncoder = [m_impl->commandBuffer renderCommandEncoderWithDescriptor:renderPassDescriptor];
+    [m_impl->currentRenderEncoder setRenderPipelineState:m_impl->pipelineState];
+    m_impl->batchPipelineBound = false;
+    [m_impl->currentRenderEncoder setDepthStencilState:m_impl->depthStencilState];
+    [m_impl->currentRenderEncoder setFragmentSamplerState:m_impl->samplerState atIndex:0];
+    
+    return true;
+}
+
+// Create a render target
+RenderHandle MetalRenderBackend::createRenderTarget(int width, int height, RenderTargetFormat format) {
+    MTLPixelFormat pixelFormat = format == RenderTargetFormat::Depth32Float ? MTLPixelFormatDepth32Float : MTLPixelFormatBGRA8Unorm;
+    MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:pixelFormat
+                                                                                                 width:width
+                                                                                                height:height
+                                                                                             mipmapped:NO];
+    textureDescriptor.usage = MTLTextureUsageRenderTarget;
+    textureDescriptor.storageMode = MTLStorageModePrivate;
+    
+    id<MTLTexture> texture = [m_impl->device newTextureWithDescriptor:textureDescriptor];
+    if (!texture) {
+        std::cerr << "Failed to create render target!" << std::endl;
+        return 0;
+    }
+    
+    RenderHandle handle = m_impl->nextHandle++;
+    m_impl->textures[handle] = texture;
+    return handle;
+}
+
+// Get render target pool counters
+RenderTargetStats MetalRenderBackend::getRenderTargetStats() const {
+    return m_impl->renderTargets->getStats();
+}
+
+// Bind a texture
+void MetalRenderBackend::setTexture(RenderHandle texture) {
+    auto it = m_impl->textures.find(texture);
+    [m_impl->currentRenderEncoder setFragmentTexture:(it != m_impl->textures.end() ? it->second : nil) atIndex:0];
+}
+
+// Set draw uniforms
+void MetalRenderBackend::setUniforms(const DrawUniforms& uniforms) {
+    if (m_impl->batchPipelineBound) {
+        [m_impl->currentRenderEncoder setRenderPipelineState:m_impl->pipelineState];
+        m_impl->batchPipelineBound = false;
+    }
+    
+    // Convert to simd matrices
+    Uniforms simdUniforms;
+    simdUniforms.modelMatrix = glmToSIMD(uniforms.modelMatrix);
+    simdUniforms.viewMatrix = glmToSIMD(uniforms.viewMatrix);
+    simdUniforms.projectionMatrix = glmToSIMD(uniforms.projectionMatrix);
+    
+    [m_impl->currentRenderEncoder setVertexBytes:&simdUniforms length:sizeof(Uniforms) atIndex:1];
+}
+
+// Draw indexed triangles
+void MetalRenderBackend::drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) {
+    auto vertices = m_impl->buffers.find(vertexBuffer);
+    auto indices = m_impl->buffers.find(indexBuffer);
+    if (vertices == m_impl->buffers.end() || indices == m_impl->buffers.end()) {
+        return;
+    }
+    
+    // Set vertex buffer
+    [m_impl->currentRenderEncoder setVertexBuffer:vertices->second offset:vertexOffset atIndex:0];
+    
+    // Draw indexed primitives
+    [m_impl->currentRenderEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                             indexCount:indexCount
+                                              indexType:MTLIndexTypeUInt32
+                                            indexBuffer:indices->second
+                                      indexBufferOffset:0];
+}
+
+// Set uniforms of batches
+void MetalRenderBackend::setFrameUniforms(const FrameUniforms& uniforms) {
+    if (!m_impl->batchPipelineBound) {
+        [m_impl->currentRenderEncoder setRenderPipelineState:m_impl->batchPipelineState];
+        m_impl->batchPipelineBound = true;
+    }
+    
+    BatchUniforms simdUniforms;
+    simdUniforms.viewMatrix = glmToSIMD(uniforms.viewMatrix);
+    simdUniforms.projectionMatrix = glmToSIMD(uniforms.projectionMatrix);
+    
+    [m_impl->currentRenderEncoder setVertexBytes:&simdUniforms length:sizeof(BatchUniforms) atIndex:1];
+}
+
+// Bind the instance buffer of batches
+void MetalRenderBackend::setInstanceBuffer(RenderHandle buffer, size_t offset) {
+    auto it = m_impl->buffers.find(buffer);
+    if (it == m_impl->buffers.end()) {
+        return;
+    }
+    
+    [m_impl->currentRenderEncoder setVertexBuffer:it->second offset:offset atIndex:2];
+}
+
+// Draw a batch
+void MetalRenderBackend::drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) {
+    auto vertices = m_impl->buffers.find(vertexBuffer);
+    auto indices = m_impl->buffers.find(indexBuffer);
+    if (vertices == m_impl->buffers.end() || indices == m_impl->buffers.end()) {
+        return;
+    }
+    
+    // Bind vertices once, draws only differ in base vertex and instance
+    [m_impl->currentRenderEncoder setVertexBuffer:vertices->second offset:0 atIndex:0];
+    
+    for (size_t i = 0; i < count; i++) {
+        [m_impl->currentRenderEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                                 indexCount:commands[i].indexCount
+                                                  indexType:MTLIndexTypeUInt32
+                                                indexBuffer:indices->second
+                                          indexBufferOffset:0
+                                              instanceCount:1
+                                                 baseVertex:commands[i].baseVertex
+                                               baseInstance:commands[i].instance];
+    }
+}
+
+// Finish and present the frame
+void MetalRenderBackend::endFrame() {
+    // End encoding and present
+    [m_impl->currentRenderEncoder endEncoding];
+    [m_impl->commandBuffer presentDrawable:m_impl->drawable];
+    
+    // Release the frame slot once the device is done with it
+    dispatch_semaphore_t frameSemaphore = m_impl->frameSemaphore;
+    [m_impl->commandBuffer addCompletedHandler:^(id<MTLCommandBuffer>) {
+        dispatch_semaphore_signal(frameSemaphore);
+    }];
+    [m_impl->commandBuffer commit];
+    
+    m_impl->currentRenderEncoder = nil;
+    m_impl->commandBuffer = nil;
+    m_impl->drawable = nil;
+    
+    m_impl->renderTargets->endFrame();
+}
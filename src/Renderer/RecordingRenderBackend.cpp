@@ -0,0 +1,269 @@
+#include "RecordingRenderBackend.h"
+
+// Constructor
+RecordingRenderBackend::RecordingRenderBackend()
+    : m_nextHandle(1),
+      m_residentBytes(0),
+      m_inFrame(false),
+      m_instanceBuffer(0),
+      m_instanceOffset(0),
+      m_frame(RenderFrameStats()),
+      m_captureCommands(false),
+      m_lastFrame(RenderFrameStats()),
+      m_totals(RenderFrameStats()),
+      m_frameCount(0),
+      m_invalidCalls(0),
+      m_frameWidth(1280),
+      m_frameHeight(720),
+      m_renderTargets(this) {
+}
+
+// Set the size of the following frames
+void RecordingRenderBackend::setFrameSize(int width, int height) {
+    m_frameWidth = width;
+    m_frameHeight = height;
+}
+
+// Initialize the backend
+bool RecordingRenderBackend::init() {
+    return true;
+}
+
+// Create a buffer
+RenderHandle RecordingRenderBackend::createBuffer(const void* data, size_t size) {
+    RenderHandle buffer = m_nextHandle++;
+    m_bufferSizes[buffer] = size;
+    m_residentBytes += size;
+
+    m_frame.buffersCreated++;
+    if (data) {
+        m_frame.bufferUploads++;
+        m_frame.uploadBytes += size;
+    }
+    addCommand(RenderCommand::CREATE_BUFFER, buffer, data ? size : 0);
+    return buffer;
+}
+
+// Copy data into a buffer
+void RecordingRenderBackend::updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) {
+    auto it = m_bufferSizes.find(buffer);
+    if (!data || it == m_bufferSizes.end() || offset + size > it->second) {
+        m_invalidCalls++;
+    }
+
+    m_frame.bufferUploads++;
+    m_frame.uploadBytes += size;
+    addCommand(RenderCommand::UPDATE_BUFFER, buffer, size);
+}
+
+// Destroy a buffer
+void RecordingRenderBackend::destroyBuffer(RenderHandle buffer) {
+    if (buffer == 0) {
+        return;
+    }
+
+    auto it = m_bufferSizes.find(buffer);
+    if (it == m_bufferSizes.end()) {
+        m_invalidCalls++;
+        return;
+    }
+
+    m_residentBytes -= it->second;
+    m_bufferSizes.erase(it);
+
+    m_frame.buffersDestroyed++;
+    addCommand(RenderCommand::DESTROY_BUFFER, buffer, 0);
+}
+
+// Create a texture
+RenderHandle RecordingRenderBackend::createTexture(const uint32_t* pixels, int width, int height) {
+    (void)pixels;
+
+    // Mipmaps are generated on the device, only the base level is uploaded
+    uint64_t bytes = static_cast<uint64_t>(width) * height * sizeof(uint32_t);
+    RenderHandle texture = m_nextHandle++;
+    m_bufferSizes[texture] = bytes;
+    m_residentBytes += bytes;
+
+    m_frame.uploadBytes += bytes;
+    addCommand(RenderCommand::CREATE_TEXTURE, texture, bytes);
+    return texture;
+}
+
+// Destroy a texture
+void RecordingRenderBackend::destroyTexture(RenderHandle texture) {
+    if (texture == 0) {
+        return;
+    }
+
+    auto it = m_bufferSizes.find(texture);
+    if (it == m_bufferSizes.end()) {
+        m_invalidCalls++;
+        return;
+    }
+
+    m_residentBytes -= it->second;
+    m_bufferSizes.erase(it);
+}
+
+// Create a render target
+RenderHandle RecordingRenderBackend::createRenderTarget(int width, int height, RenderTargetFormat format) {
+    if (width <= 0 || height <= 0 || format >= RenderTargetFormat::Count) {
+        m_invalidCalls++;
+        return 0;
+    }
+
+    uint64_t bytes = static_cast<uint64_t>(width) * height * RenderTargetPool::getBytesPerPixel(format);
+    RenderHandle target = m_nextHandle++;
+    m_bufferSizes[target] = bytes;
+    m_residentBytes += bytes;
+
+    addCommand(RenderCommand::CREATE_RENDER_TARGET, target, bytes);
+    return target;
+}
+
+// Get render target pool counters
+RenderTargetStats RecordingRenderBackend::getRenderTargetStats() const {
+    return m_renderTargets.getStats();
+}
+
+// Begin a frame
+bool RecordingRenderBackend::beginFrame(const glm::vec4& clearColor) {
+    (void)clearColor;
+
+    if (m_inFrame) {
+        m_invalidCalls++;
+    }
+    m_inFrame = true;
+
+    // Depth attachment of the frame
+    if (!m_renderTargets.acquire(m_frameWidth, m_frameHeight, RenderTargetFormat::Depth32Float)) {
+        m_inFrame = false;
+        return false;
+    }
+    return true;
+}
+
+// Bind a texture
+void RecordingRenderBackend::setTexture(RenderHandle texture) {
+    if (!m_inFrame || m_bufferSizes.find(texture) == m_bufferSizes.end()) {
+        m_invalidCalls++;
+    }
+    addCommand(RenderCommand::SET_TEXTURE, texture, 0);
+}
+
+// Set draw uniforms
+void RecordingRenderBackend::setUniforms(const DrawUniforms& uniforms) {
+    (void)uniforms;
+
+    if (!m_inFrame) {
+        m_invalidCalls++;
+    }
+
+    m_frame.uniformUpdates++;
+    m_frame.uploadBytes += sizeof(DrawUniforms);
+    addCommand(RenderCommand::SET_UNIFORMS, 0, sizeof(DrawUniforms));
+}
+
+// Draw indexed triangles
+void RecordingRenderBackend::drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) {
+    auto vertices = m_bufferSizes.find(vertexBuffer);
+    auto indices = m_bufferSizes.find(indexBuffer);
+    if (!m_inFrame || vertices == m_bufferSizes.end() || indices == m_bufferSizes.end() || vertexOffset >= vertices->second ||
+        static_cast<uint64_t>(indexCount) * sizeof(uint32_t) > indices->second) {
+        m_invalidCalls++;
+    }
+
+    m_frame.draws++;
+    m_frame.indices += indexCount;
+    addCommand(RenderCommand::DRAW, vertexBuffer, indexCount);
+}
+
+// Set uniforms of batches
+void RecordingRenderBackend::setFrameUniforms(const FrameUniforms& uniforms) {
+    (void)uniforms;
+
+    if (!m_inFrame) {
+        m_invalidCalls++;
+    }
+
+    m_frame.uniformUpdates++;
+    m_frame.uploadBytes += sizeof(FrameUniforms);
+    addCommand(RenderCommand::SET_FRAME_UNIFORMS, 0, sizeof(FrameUniforms));
+}
+
+// Bind the instance buffer of batches
+void RecordingRenderBackend::setInstanceBuffer(RenderHandle buffer, size_t offset) {
+    auto it = m_bufferSizes.find(buffer);
+    if (!m_inFrame || it == m_bufferSizes.end() || offset >= it->second) {
+        m_invalidCalls++;
+    }
+
+    m_instanceBuffer = buffer;
+    m_instanceOffset = offset;
+    addCommand(RenderCommand::SET_INSTANCE_BUFFER, buffer, offset);
+}
+
+// Draw a batch
+void RecordingRenderBackend::drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) {
+    auto vertices = m_bufferSizes.find(vertexBuffer);
+    auto indices = m_bufferSizes.find(indexBuffer);
+    auto instances = m_bufferSizes.find(m_instanceBuffer);
+    if (!m_inFrame || vertices == m_bufferSizes.end() || indices == m_bufferSizes.end() || instances == m_bufferSizes.end()) {
+        m_invalidCalls++;
+    } else {
+        // Every command must stay inside the index buffer and the bound instances
+        for (size_t i = 0; i < count; i++) {
+            if (static_cast<uint64_t>(commands[i].indexCount) * sizeof(uint32_t) > indices->second ||
+                m_instanceOffset + (commands[i].instance + 1) * sizeof(DrawInstance) > instances->second) {
+                m_invalidCalls++;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        m_frame.indices += commands[i].indexCount;
+    }
+    m_frame.draws += static_cast<uint32_t>(count);
+    m_frame.batches++;
+    addCommand(RenderCommand::DRAW_BATCH, vertexBuffer, count);
+}
+
+// Finish the frame
+void RecordingRenderBackend::endFrame() {
+    if (!m_inFrame) {
+        m_invalidCalls++;
+    }
+    m_inFrame = false;
+    m_instanceBuffer = 0;
+
+    m_totals.draws += m_frame.draws;
+    m_totals.batches += m_frame.batches;
+    m_totals.indices += m_frame.indices;
+    m_totals.uniformUpdates += m_frame.uniformUpdates;
+    m_totals.buffersCreated += m_frame.buffersCreated;
+    m_totals.buffersDestroyed += m_frame.buffersDestroyed;
+    m_totals.bufferUploads += m_frame.bufferUploads;
+    m_totals.uploadBytes += m_frame.uploadBytes;
+
+    m_lastFrame = m_frame;
+    m_frame = RenderFrameStats();
+    m_frameCount++;
+
+    m_lastCommands.swap(m_commands);
+    m_commands.clear();
+
+    m_renderTargets.endFrame();
+}
+
+// Keep a call if capturing
+void RecordingRenderBackend::addCommand(RenderCommand::Type type, RenderHandle handle, uint64_t value) {
+    if (m_captureCommands) {
+        RenderCommand command;
+        command.type = type;
+        command.handle = handle;
+        command.value = value;
+        m_commands.push_back(command);
+    }
+}
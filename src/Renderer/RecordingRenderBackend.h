@@ -0,0 +1,126 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include "RenderTargetPool.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Submission counters of one frame
+struct RenderFrameStats {
+    uint32_t draws;
+    uint32_t batches;
+    uint64_t indices;
+    uint32_t uniformUpdates;
+    uint32_t buffersCreated;
+    uint32_t buffersDestroyed;
+    uint32_t bufferUploads;     // Buffers created with data and buffer updates
+    uint64_t uploadBytes;       // Buffer, texture and uniform bytes sent to the device
+};
+
+// Backend call kept by the recording backend
+struct RenderCommand {
+    enum Type {
+        CREATE_BUFFER = 0,
+        UPDATE_BUFFER,
+        DESTROY_BUFFER,
+        CREATE_TEXTURE,
+        CREATE_RENDER_TARGET,
+        SET_TEXTURE,
+        SET_UNIFORMS,
+        SET_FRAME_UNIFORMS,
+        SET_INSTANCE_BUFFER,
+        DRAW,
+        DRAW_BATCH
+    };
+
+    Type type;
+    RenderHandle handle;    // Buffer or texture, vertex buffer for draws
+    uint64_t value;         // Bytes uploaded, index count for draws, draw count for batches, instance offset
+};
+
+// Recording render backend class
+//
+// Backend without a device for headless runs. It counts draws and uploads per
+// frame, checks that draws only use live buffers inside a frame, and can keep
+// the calls of each frame for regression tests. Uploads made between frames
+// are counted towards the next frame. Each frame takes a depth target of the
+// frame size from a render target pool, like the Metal backend does.
+class RecordingRenderBackend : public RenderBackend {
+public:
+    RecordingRenderBackend();
+
+    // RenderBackend
+    bool init() override;
+    RenderHandle createBuffer(const void* data, size_t size) override;
+    void updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) override;
+    void destroyBuffer(RenderHandle buffer) override;
+    RenderHandle createTexture(const uint32_t* pixels, int width, int height) override;
+    void destroyTexture(RenderHandle texture) override;
+    RenderHandle createRenderTarget(int width, int height, RenderTargetFormat format) override;
+    RenderTargetStats getRenderTargetStats() const override;
+    bool beginFrame(const glm::vec4& clearColor) override;
+    void setTexture(RenderHandle texture) override;
+    void setUniforms(const DrawUniforms& uniforms) override;
+    void drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) override;
+    void setFrameUniforms(const FrameUniforms& uniforms) override;
+    void setInstanceBuffer(RenderHandle buffer, size_t offset) override;
+    void drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) override;
+    void endFrame() override;
+
+    // Set the size of the following frames (default 1280 x 720)
+    void setFrameSize(int width, int height);
+
+    // Keep the calls of each frame (off by default, counters are always kept)
+    void setCaptureCommands(bool capture) { m_captureCommands = capture; }
+
+    // Get the calls of the last finished frame
+    const std::vector<RenderCommand>& getCommands() const { return m_lastCommands; }
+
+    // Get counters of the last finished frame
+    const RenderFrameStats& getLastFrame() const { return m_lastFrame; }
+
+    // Get counters summed over all finished frames
+    const RenderFrameStats& getTotals() const { return m_totals; }
+
+    // Get number of finished frames
+    uint64_t getFrameCount() const { return m_frameCount; }
+
+    // Get number of live buffers and textures
+    size_t getBufferCount() const { return m_bufferSizes.size(); }
+
+    // Get bytes held by live buffers and textures
+    uint64_t getResidentBytes() const { return m_residentBytes; }
+
+    // Get number of calls that were invalid (unknown buffers, draws outside a frame, ranges past the buffer)
+    uint64_t getInvalidCallCount() const { return m_invalidCalls; }
+
+private:
+    // Sizes of live buffers and textures
+    std::unordered_map<RenderHandle, uint64_t> m_bufferSizes;
+    RenderHandle m_nextHandle;
+    uint64_t m_residentBytes;
+
+    // Frame being recorded
+    bool m_inFrame;
+    RenderHandle m_instanceBuffer;
+    uint64_t m_instanceOffset;
+    RenderFrameStats m_frame;
+    std::vector<RenderCommand> m_commands;
+    bool m_captureCommands;
+
+    // Finished frames
+    RenderFrameStats m_lastFrame;
+    RenderFrameStats m_totals;
+    std::vector<RenderCommand> m_lastCommands;
+    uint64_t m_frameCount;
+    uint64_t m_invalidCalls;
+
+    // Depth targets reused across frames (declared last, its destructor destroys textures)
+    int m_frameWidth;
+    int m_frameHeight;
+    RenderTargetPool m_renderTargets;
+
+    // Keep a call if capturing
+    void addCommand(RenderCommand::Type type, RenderHandle handle, uint64_t value);
+};
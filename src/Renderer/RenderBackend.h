@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Handle of a buffer or texture created by a render backend (0 = none)
+typedef uint32_t RenderHandle;
+
+// Pixel format of a render target
+enum class RenderTargetFormat : uint8_t {
+    Depth32Float = 0,
+    BGRA8,
+    Count
+};
+
+// Render target pool counters of a backend
+struct RenderTargetStats {
+    uint64_t acquires;          // Targets requested by frames
+    uint64_t allocations;       // Targets created because no pooled one matched
+    uint64_t evictions;         // Pooled targets destroyed after going unused
+    uint32_t targets;           // Targets held by the pool
+    uint64_t bytes;             // Bytes of those targets
+};
+
+// Vertex uniforms of a draw
+struct DrawUniforms {
+    glm::mat4 modelMatrix;
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
+};
+
+// Vertex uniforms shared by all draws of a batched frame
+struct FrameUniforms {
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
+};
+
+// Per-draw data read from the instance buffer in batched draws
+struct DrawInstance {
+    glm::vec4 origin;       // World position added to vertex positions (w unused)
+};
+
+// Indexed draw of a batch
+struct DrawCommand {
+    uint32_t indexCount;
+    uint32_t baseVertex;    // Added to every index
+    uint32_t instance;      // Entry of the instance buffer
+};
+
+// Render backend interface
+//
+// The graphics API calls the voxel renderer makes: buffer and texture uploads
+// and one pass of indexed triangle draws per frame. Draws are either issued one
+// by one with their own uniforms, or in batches that share a vertex buffer and
+// read per-draw data from an instance buffer. Draw list building and mesh
+// bookkeeping stay in the renderer, so the same code drives Metal in the game
+// and the recording backend in headless runs. Backends queue at most
+// MAX_FRAMES_IN_FLIGHT frames on the device, so buffer ranges released in a
+// frame can be overwritten once that many more frames ended.
+class RenderBackend {
+public:
+    // Frames the device may be working on at once
+    static const int MAX_FRAMES_IN_FLIGHT = 3;
+
+    virtual ~RenderBackend() {}
+
+    // Initialize the backend, returns false on failure
+    virtual bool init() = 0;
+
+    // Create a buffer of size bytes holding a copy of data (uninitialized if data is nullptr)
+    virtual RenderHandle createBuffer(const void* data, size_t size) = 0;
+
+    // Copy size bytes of data into a buffer at offset (the range must not be used by frames in flight)
+    virtual void updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) = 0;
+
+    // Destroy a buffer (0 is ignored, frames in flight may keep using it)
+    virtual void destroyBuffer(RenderHandle buffer) = 0;
+
+    // Create a mipmapped RGBA8 texture from width * height pixels
+    virtual RenderHandle createTexture(const uint32_t* pixels, int width, int height) = 0;
+
+    // Destroy a texture or render target (0 is ignored)
+    virtual void destroyTexture(RenderHandle texture) = 0;
+
+    // Create a render target texture the device draws into
+    virtual RenderHandle createRenderTarget(int width, int height, RenderTargetFormat format) = 0;
+
+    // Get counters of the render targets the backend reuses across frames
+    virtual RenderTargetStats getRenderTargetStats() const = 0;
+
+    // Begin a frame cleared to clearColor, returns false if nothing can be drawn this frame
+    virtual bool beginFrame(const glm::vec4& clearColor) = 0;
+
+    // Bind the texture sampled by the following draws
+    virtual void setTexture(RenderHandle texture) = 0;
+
+    // Set the uniforms of the following draws
+    virtual void setUniforms(const DrawUniforms& uniforms) = 0;
+
+    // Draw indexCount 32-bit indices of indexBuffer as triangles, with vertices starting at vertexOffset bytes
+    virtual void drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) = 0;
+
+    // Set the uniforms of the following batches
+    virtual void setFrameUniforms(const FrameUniforms& uniforms) = 0;
+
+    // Bind the DrawInstance array read by the following batches, starting at offset bytes
+    virtual void setInstanceBuffer(RenderHandle buffer, size_t offset) = 0;
+
+    // Draw count commands as triangles, all with vertices of vertexBuffer and 32-bit indices of indexBuffer
+    virtual void drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) = 0;
+
+    // Finish and present the frame
+    virtual void endFrame() = 0;
+};
@@ -0,0 +1,101 @@
+#include "RenderTargetPool.h"
+#include "../Core/Metrics.h"
+
+const int RenderTargetPool::MAX_UNUSED_FRAMES;
+
+// Metrics reported by render target pools
+static MetricCounter& s_targetAllocations = Metrics::counter("tomicz_render_target_allocations_total", "Render targets created because no pooled one matched");
+static MetricGauge& s_targetBytes = Metrics::gauge("tomicz_render_target_bytes", "Bytes of pooled render targets");
+
+// Constructor
+RenderTargetPool::RenderTargetPool(RenderBackend* backend)
+    : m_backend(backend), m_frame(0), m_stats(RenderTargetStats()) {
+}
+
+// Destructor
+RenderTargetPool::~RenderTargetPool() {
+    clear();
+}
+
+// Get a target for the current frame
+RenderHandle RenderTargetPool::acquire(int width, int height, RenderTargetFormat format) {
+    m_stats.acquires++;
+
+    for (Target& target : m_targets) {
+        if (!target.inUse && target.width == width && target.height == height && target.format == format) {
+            target.inUse = true;
+            target.lastUsedFrame = m_frame;
+            return target.handle;
+        }
+    }
+
+    // Nothing matches (first frame, resize or a second target of the same kind)
+    RenderHandle handle = m_backend->createRenderTarget(width, height, format);
+    if (!handle) {
+        return 0;
+    }
+
+    Target target;
+    target.handle = handle;
+    target.width = width;
+    target.height = height;
+    target.format = format;
+    target.lastUsedFrame = m_frame;
+    target.inUse = true;
+    m_targets.push_back(target);
+
+    uint64_t bytes = static_cast<uint64_t>(width) * height * getBytesPerPixel(format);
+    m_stats.allocations++;
+    m_stats.targets++;
+    m_stats.bytes += bytes;
+    s_targetAllocations.add(1);
+    s_targetBytes.add(static_cast<double>(bytes));
+    return handle;
+}
+
+// End a frame
+void RenderTargetPool::endFrame() {
+    for (size_t i = 0; i < m_targets.size();) {
+        Target& target = m_targets[i];
+        target.inUse = false;
+
+        if (m_frame - target.lastUsedFrame >= static_cast<uint64_t>(MAX_UNUSED_FRAMES)) {
+            uint64_t bytes = static_cast<uint64_t>(target.width) * target.height * getBytesPerPixel(target.format);
+            m_backend->destroyTexture(target.handle);
+            m_stats.evictions++;
+            m_stats.targets--;
+            m_stats.bytes -= bytes;
+            s_targetBytes.add(-static_cast<double>(bytes));
+
+            m_targets[i] = m_targets.back();
+            m_targets.pop_back();
+        } else {
+            i++;
+        }
+    }
+
+    m_frame++;
+}
+
+// Destroy all pooled targets
+void RenderTargetPool::clear() {
+    for (const Target& target : m_targets) {
+        m_backend->destroyTexture(target.handle);
+    }
+    m_targets.clear();
+
+    s_targetBytes.add(-static_cast<double>(m_stats.bytes));
+    m_stats.targets = 0;
+    m_stats.bytes = 0;
+}
+
+// Get bytes per pixel of a format
+int RenderTargetPool::getBytesPerPixel(RenderTargetFormat format) {
+    switch (format) {
+        case RenderTargetFormat::Depth32Float:
+        case RenderTargetFormat::BGRA8:
+            return 4;
+        default:
+            return 0;
+    }
+}
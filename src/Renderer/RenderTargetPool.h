@@ -0,0 +1,65 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include <vector>
+
+// Render target pool class
+//
+// Keeps transient render targets (like the depth attachment) alive across
+// frames. A frame acquires targets by size and format and gets back a pooled
+// one when it matches, so targets are only created on the first frame and
+// after a resize. Targets not acquired for MAX_UNUSED_FRAMES frames are
+// destroyed, by which time no frame in flight uses them any more.
+class RenderTargetPool {
+public:
+    // Frames a target may go unused before it is destroyed
+    static const int MAX_UNUSED_FRAMES = RenderBackend::MAX_FRAMES_IN_FLIGHT;
+
+    // Create an empty pool creating targets through backend
+    explicit RenderTargetPool(RenderBackend* backend);
+
+    // Destroy all pooled targets
+    ~RenderTargetPool();
+
+    // Delete copy constructor and assignment operator
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // Get a target for the current frame, returns 0 if the backend failed to create one
+    RenderHandle acquire(int width, int height, RenderTargetFormat format);
+
+    // End a frame, returning its targets to the pool and destroying unused ones
+    void endFrame();
+
+    // Destroy all pooled targets (the device must be idle)
+    void clear();
+
+    // Get counters
+    const RenderTargetStats& getStats() const { return m_stats; }
+
+    // Get bytes per pixel of a format
+    static int getBytesPerPixel(RenderTargetFormat format);
+
+private:
+    // Pooled target
+    struct Target {
+        RenderHandle handle;
+        int width;
+        int height;
+        RenderTargetFormat format;
+        uint64_t lastUsedFrame;
+        bool inUse;
+    };
+
+    // Backend creating the targets (not owned)
+    RenderBackend* m_backend;
+
+    // Pooled targets (a handful, searched linearly)
+    std::vector<Target> m_targets;
+
+    // Frames ended so far
+    uint64_t m_frame;
+
+    // Counters
+    RenderTargetStats m_stats;
+};
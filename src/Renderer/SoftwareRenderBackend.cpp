@@ -0,0 +1,678 @@
+#include "SoftwareRenderBackend.h"
+#include "../Core/ImageWriter.h"
+#include "../Core/Profiler.h"
+#include "../Core/TaskScheduler.h"
+#include "../Voxel/Chunk.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+const int SoftwareRenderBackend::TILE_SIZE;
+const size_t SoftwareRenderBackend::MAX_PASS_TRIANGLES;
+
+typedef std::chrono::steady_clock Clock;
+
+// Four floats or 32-bit masks processed together (GCC and Clang vector extensions, SSE or NEON registers)
+typedef float Float4 __attribute__((vector_size(16)));
+typedef int32_t Int4 __attribute__((vector_size(16)));
+
+// Most draw groups binned in parallel per pass
+static const size_t MAX_BIN_GROUPS = 64;
+
+// Light direction of the voxel shader
+static const glm::vec3 LIGHT_DIRECTION = glm::normalize(glm::vec3(0.5f, 1.0f, 0.5f));
+
+// Milliseconds since start
+static double elapsedMs(const Clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Splat a float into all lanes
+static inline Float4 splat(float value) {
+    Float4 result = {value, value, value, value};
+    return result;
+}
+
+// Check if any lane of a mask is set
+static inline bool anyLane(Int4 mask) {
+    return (mask[0] | mask[1] | mask[2] | mask[3]) != 0;
+}
+
+// Pick a where mask is set, else b
+static inline Float4 select(Int4 mask, Float4 a, Float4 b) {
+    return (Float4)((mask & (Int4)a) | (~mask & (Int4)b));
+}
+
+// Round up to a multiple of the tile size
+static int alignToTile(int size) {
+    return (size + SoftwareRenderBackend::TILE_SIZE - 1) / SoftwareRenderBackend::TILE_SIZE * SoftwareRenderBackend::TILE_SIZE;
+}
+
+// Convert a color channel to 8 bits
+static inline uint32_t toByte(float value) {
+    return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// Convert a color to RGBA8 (R in the lowest byte, like the atlas)
+static inline uint32_t packColor(float red, float green, float blue, float alpha) {
+    return toByte(red) | (toByte(green) << 8) | (toByte(blue) << 16) | (toByte(alpha) << 24);
+}
+
+// Constructor
+SoftwareRenderBackend::SoftwareRenderBackend(int width, int height, TaskScheduler* scheduler)
+    : m_width(width),
+      m_height(height),
+      m_scheduler(scheduler),
+      m_nextHandle(1),
+      m_inFrame(false),
+      m_colorHandle(0),
+      m_colorTarget(nullptr),
+      m_depthTarget(nullptr),
+      m_clearColor(0),
+      m_texture(nullptr),
+      m_modelViewProjection(1.0f),
+      m_model(1.0f),
+      m_viewProjection(1.0f),
+      m_instances(nullptr),
+      m_instanceCount(0),
+      m_activeGroups(0),
+      m_lastColor(0),
+      m_lastStats(SoftwareRasterStats()),
+      m_renderTargets(this) {
+}
+
+// Initialize the backend
+bool SoftwareRenderBackend::init() {
+    return m_width > 0 && m_height > 0;
+}
+
+// Create a buffer
+RenderHandle SoftwareRenderBackend::createBuffer(const void* data, size_t size) {
+    RenderHandle buffer = m_nextHandle++;
+    std::vector<uint8_t>& bytes = m_buffers[buffer];
+    bytes.resize(size);
+    if (data) {
+        std::memcpy(bytes.data(), data, size);
+    }
+    return buffer;
+}
+
+// Copy data into a buffer
+void SoftwareRenderBackend::updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) {
+    auto it = m_buffers.find(buffer);
+    if (it == m_buffers.end() || offset + size > it->second.size()) {
+        return;
+    }
+    std::memcpy(it->second.data() + offset, data, size);
+}
+
+// Destroy a buffer
+void SoftwareRenderBackend::destroyBuffer(RenderHandle buffer) {
+    m_buffers.erase(buffer);
+}
+
+// Create a texture
+RenderHandle SoftwareRenderBackend::createTexture(const uint32_t* pixels, int width, int height) {
+    // Only the base level is kept, the atlas is sampled with nearest filtering
+    RenderHandle handle = m_nextHandle++;
+    Texture& texture = m_textures[handle];
+    texture.width = width;
+    texture.height = height;
+    texture.stride = width;
+    texture.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height);
+    return handle;
+}
+
+// Destroy a texture
+void SoftwareRenderBackend::destroyTexture(RenderHandle texture) {
+    m_textures.erase(texture);
+}
+
+// Create a render target
+RenderHandle SoftwareRenderBackend::createRenderTarget(int width, int height, RenderTargetFormat format) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+
+    // Pad to whole tiles so four-pixel spans never leave the rows
+    RenderHandle handle = m_nextHandle++;
+    Texture& target = m_textures[handle];
+    target.width = width;
+    target.height = height;
+    target.stride = alignToTile(width);
+
+    size_t size = static_cast<size_t>(target.stride) * alignToTile(height);
+    if (format == RenderTargetFormat::Depth32Float) {
+        target.depth.assign(size, 1.0f);
+    } else {
+        target.pixels.assign(size, 0);
+    }
+    return handle;
+}
+
+// Get render target pool counters
+RenderTargetStats SoftwareRenderBackend::getRenderTargetStats() const {
+    return m_renderTargets.getStats();
+}
+
+// Set the size of the following frames
+void SoftwareRenderBackend::setFrameSize(int width, int height) {
+    m_width = width;
+    m_height = height;
+}
+
+// Begin a frame
+bool SoftwareRenderBackend::beginFrame(const glm::vec4& clearColor) {
+    m_colorHandle = m_renderTargets.acquire(m_width, m_height, RenderTargetFormat::BGRA8);
+    RenderHandle depthHandle = m_renderTargets.acquire(m_width, m_height, RenderTargetFormat::Depth32Float);
+    if (!m_colorHandle || !depthHandle) {
+        m_renderTargets.endFrame();
+        return false;
+    }
+
+    m_inFrame = true;
+    m_colorTarget = &m_textures[m_colorHandle];
+    m_depthTarget = &m_textures[depthHandle];
+    m_clearColor = packColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+    m_texture = nullptr;
+    m_instances = nullptr;
+    m_instanceCount = 0;
+    m_draws.clear();
+    return true;
+}
+
+// Bind a texture
+void SoftwareRenderBackend::setTexture(RenderHandle texture) {
+    auto it = m_textures.find(texture);
+    m_texture = it != m_textures.end() ? &it->second : nullptr;
+}
+
+// Set draw uniforms
+void SoftwareRenderBackend::setUniforms(const DrawUniforms& uniforms) {
+    m_model = uniforms.modelMatrix;
+    m_modelViewProjection = uniforms.projectionMatrix * uniforms.viewMatrix * uniforms.modelMatrix;
+}
+
+// Draw indexed triangles
+void SoftwareRenderBackend::drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) {
+    auto vertices = m_buffers.find(vertexBuffer);
+    auto indices = m_buffers.find(indexBuffer);
+    if (!m_inFrame || vertices == m_buffers.end() || indices == m_buffers.end()) {
+        return;
+    }
+
+    addDraw(vertices->second, vertexOffset, indices->second, indexCount, m_model, m_modelViewProjection);
+}
+
+// Set uniforms of batches
+void SoftwareRenderBackend::setFrameUniforms(const FrameUniforms& uniforms) {
+    m_viewProjection = uniforms.projectionMatrix * uniforms.viewMatrix;
+}
+
+// Bind the instance buffer of batches
+void SoftwareRenderBackend::setInstanceBuffer(RenderHandle buffer, size_t offset) {
+    auto it = m_buffers.find(buffer);
+    if (it == m_buffers.end() || offset >= it->second.size()) {
+        m_instances = nullptr;
+        m_instanceCount = 0;
+        return;
+    }
+
+    m_instances = it->second.data() + offset;
+    m_instanceCount = (it->second.size() - offset) / sizeof(DrawInstance);
+}
+
+// Draw a batch
+void SoftwareRenderBackend::drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) {
+    auto vertices = m_buffers.find(vertexBuffer);
+    auto indices = m_buffers.find(indexBuffer);
+    if (!m_inFrame || vertices == m_buffers.end() || indices == m_buffers.end()) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (commands[i].instance >= m_instanceCount) {
+            continue;
+        }
+
+        // Instances only translate
+        DrawInstance instance;
+        std::memcpy(&instance, m_instances + commands[i].instance * sizeof(DrawInstance), sizeof(DrawInstance));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(instance.origin.x, instance.origin.y, instance.origin.z));
+
+        addDraw(vertices->second, static_cast<size_t>(commands[i].baseVertex) * sizeof(ChunkVertex), indices->second,
+                commands[i].indexCount, model, m_viewProjection * model);
+    }
+}
+
+// Rasterize the recorded draws
+void SoftwareRenderBackend::endFrame() {
+    PROFILE_ZONE("SoftwareRenderBackend::endFrame");
+
+    if (!m_inFrame) {
+        return;
+    }
+
+    int tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    std::vector<uint64_t> tilePixels(tileCount);
+
+    SoftwareRasterStats stats = SoftwareRasterStats();
+    size_t nextDraw = 0;
+    bool firstPass = true;
+
+    // Bin and rasterize at most MAX_PASS_TRIANGLES at a time (the first pass also clears)
+    while (firstPass || nextDraw < m_draws.size()) {
+        size_t endDraw = nextDraw;
+        size_t passTriangles = 0;
+        while (endDraw < m_draws.size() &&
+               (endDraw == nextDraw || passTriangles + m_draws[endDraw].indexCount / 3 <= MAX_PASS_TRIANGLES)) {
+            passTriangles += m_draws[endDraw].indexCount / 3;
+            endDraw++;
+        }
+
+        // Split the pass into groups of about the same triangle count
+        m_activeGroups = std::min(endDraw - nextDraw, MAX_BIN_GROUPS);
+        if (m_groups.size() < m_activeGroups) {
+            m_groups.resize(m_activeGroups);
+        }
+
+        size_t draw = nextDraw;
+        size_t triangles = 0;
+        for (size_t i = 0; i < m_activeGroups; i++) {
+            BinGroup& group = m_groups[i];
+            group.firstDraw = draw;
+
+            size_t target = passTriangles * (i + 1) / m_activeGroups;
+            while (draw < endDraw && (draw == group.firstDraw || triangles < target) && endDraw - draw > m_activeGroups - i - 1) {
+                triangles += m_draws[draw].indexCount / 3;
+                draw++;
+            }
+            if (i + 1 == m_activeGroups) {
+                draw = endDraw;
+            }
+            group.endDraw = draw;
+        }
+
+        Clock::time_point start = Clock::now();
+        parallelFor(m_activeGroups, [this, tilesX, tilesY](size_t i) {
+            binGroup(m_groups[i], tilesX, tilesY);
+        });
+        stats.binMs += elapsedMs(start);
+
+        start = Clock::now();
+        bool clear = firstPass;
+        parallelFor(tileCount, [this, tilesX, clear, &tilePixels](size_t tile) {
+            tilePixels[tile] += rasterizeTile(static_cast<int>(tile), tilesX, clear);
+        });
+        stats.rasterMs += elapsedMs(start);
+
+        for (size_t i = 0; i < m_activeGroups; i++) {
+            const BinGroup& group = m_groups[i];
+            stats.triangles += group.submitted;
+            stats.rasterized += group.triangles.size();
+            for (const std::vector<uint32_t>& tile : group.tiles) {
+                stats.binEntries += tile.size();
+            }
+        }
+        stats.passes++;
+
+        firstPass = false;
+        nextDraw = endDraw;
+    }
+
+    for (uint64_t pixels : tilePixels) {
+        stats.pixelsShaded += pixels;
+    }
+
+    m_lastStats = stats;
+    m_lastColor = m_colorHandle;
+    m_inFrame = false;
+    m_draws.clear();
+    m_renderTargets.endFrame();
+}
+
+// Copy the last frame
+bool SoftwareRenderBackend::readPixels(std::vector<uint32_t>& pixels) const {
+    auto it = m_textures.find(m_lastColor);
+    if (it == m_textures.end()) {
+        return false;
+    }
+
+    const Texture& color = it->second;
+    pixels.resize(static_cast<size_t>(color.width) * color.height);
+    for (int y = 0; y < color.height; y++) {
+        std::memcpy(&pixels[static_cast<size_t>(y) * color.width], &color.pixels[static_cast<size_t>(y) * color.stride],
+                    color.width * sizeof(uint32_t));
+    }
+    return true;
+}
+
+// Write the last frame as a binary PPM image
+bool SoftwareRenderBackend::writeImage(const std::string& filename) const {
+    auto it = m_textures.find(m_lastColor);
+    if (it == m_textures.end()) {
+        return false;
+    }
+
+    const Texture& color = it->second;
+    return ImageWriter::writePpm(filename, color.pixels.data(), color.width, color.height, color.stride);
+}
+
+// Record a draw
+void SoftwareRenderBackend::addDraw(const std::vector<uint8_t>& vertexBuffer, size_t vertexOffset, const std::vector<uint8_t>& indexBuffer,
+                                    uint32_t indexCount, const glm::mat4& model, const glm::mat4& modelViewProjection) {
+    if (vertexOffset >= vertexBuffer.size()) {
+        return;
+    }
+
+    Draw draw;
+    draw.modelViewProjection = modelViewProjection;
+    draw.model = model;
+    draw.vertices = vertexBuffer.data() + vertexOffset;
+    draw.vertexCount = static_cast<uint32_t>((vertexBuffer.size() - vertexOffset) / sizeof(ChunkVertex));
+    draw.indices = reinterpret_cast<const uint32_t*>(indexBuffer.data());
+    draw.indexCount = std::min(indexCount, static_cast<uint32_t>(indexBuffer.size() / sizeof(uint32_t))) / 3 * 3;
+    draw.texture = m_texture;
+    m_draws.push_back(draw);
+}
+
+// Transform, clip and bin the draws of a group
+void SoftwareRenderBackend::binGroup(BinGroup& group, int tilesX, int tilesY) {
+    PROFILE_ZONE("SoftwareRenderBackend::binGroup");
+
+    group.triangles.clear();
+    group.tiles.resize(static_cast<size_t>(tilesX) * tilesY);
+    for (std::vector<uint32_t>& tile : group.tiles) {
+        tile.clear();
+    }
+    group.submitted = 0;
+
+    for (size_t drawIndex = group.firstDraw; drawIndex < group.endDraw; drawIndex++) {
+        const Draw& draw = m_draws[drawIndex];
+
+        // Transform and light the vertices the draw uses
+        uint32_t vertexCount = 0;
+        for (uint32_t i = 0; i < draw.indexCount; i++) {
+            vertexCount = std::max(vertexCount, draw.indices[i] + 1);
+        }
+        vertexCount = std::min(vertexCount, draw.vertexCount);
+        group.vertices.resize(vertexCount);
+
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            ChunkVertex vertex;
+            std::memcpy(&vertex, draw.vertices + static_cast<size_t>(i) * sizeof(ChunkVertex), sizeof(ChunkVertex));
+
+            ClipVertex& out = group.vertices[i];
+            out.position = draw.modelViewProjection * glm::vec4(vertex.position[0], vertex.position[1], vertex.position[2], 1.0f);
+            out.u = vertex.texCoord[0];
+            out.v = vertex.texCoord[1];
+
+            glm::vec3 normal = glm::normalize(glm::vec3(draw.model * glm::vec4(vertex.normal[0], vertex.normal[1], vertex.normal[2], 0.0f)));
+            float light = vertex.color[3] * std::max(glm::dot(normal, LIGHT_DIRECTION), 0.2f);
+            out.red = vertex.color[0] * light;
+            out.green = vertex.color[1] * light;
+            out.blue = vertex.color[2] * light;
+        }
+
+        for (uint32_t i = 0; i + 2 < draw.indexCount; i += 3) {
+            uint32_t i0 = draw.indices[i];
+            uint32_t i1 = draw.indices[i + 1];
+            uint32_t i2 = draw.indices[i + 2];
+            if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) {
+                continue;
+            }
+            group.submitted++;
+
+            const glm::vec4& p0 = group.vertices[i0].position;
+            const glm::vec4& p1 = group.vertices[i1].position;
+            const glm::vec4& p2 = group.vertices[i2].position;
+
+            // Reject triangles entirely outside one frustum plane
+            if ((p0.x > p0.w && p1.x > p1.w && p2.x > p2.w) || (p0.x < -p0.w && p1.x < -p1.w && p2.x < -p2.w) ||
+                (p0.y > p0.w && p1.y > p1.w && p2.y > p2.w) || (p0.y < -p0.w && p1.y < -p1.w && p2.y < -p2.w) ||
+                (p0.z > p0.w && p1.z > p1.w && p2.z > p2.w) || (p0.z < -p0.w && p1.z < -p1.w && p2.z < -p2.w)) {
+                continue;
+            }
+
+            ClipVertex triangle[3] = {group.vertices[i0], group.vertices[i1], group.vertices[i2]};
+            if (p0.z >= -p0.w && p1.z >= -p1.w && p2.z >= -p2.w) {
+                binTriangle(group, triangle, draw.texture, tilesX);
+                continue;
+            }
+
+            // Clip against the near plane (z >= -w), leaving a triangle or a quad
+            ClipVertex polygon[4];
+            int count = 0;
+            for (int edge = 0; edge < 3; edge++) {
+                const ClipVertex& a = triangle[edge];
+                const ClipVertex& b = triangle[(edge + 1) % 3];
+                float distanceA = a.position.z + a.position.w;
+                float distanceB = b.position.z + b.position.w;
+
+                if (distanceA >= 0.0f) {
+                    polygon[count++] = a;
+                }
+                if ((distanceA >= 0.0f) != (distanceB >= 0.0f)) {
+                    float t = distanceA / (distanceA - distanceB);
+                    ClipVertex& crossing = polygon[count++];
+                    crossing.position = a.position + (b.position - a.position) * t;
+                    crossing.u = a.u + (b.u - a.u) * t;
+                    crossing.v = a.v + (b.v - a.v) * t;
+                    crossing.red = a.red + (b.red - a.red) * t;
+                    crossing.green = a.green + (b.green - a.green) * t;
+                    crossing.blue = a.blue + (b.blue - a.blue) * t;
+                }
+            }
+
+            for (int fan = 1; fan + 1 < count; fan++) {
+                ClipVertex clipped[3] = {polygon[0], polygon[fan], polygon[fan + 1]};
+                binTriangle(group, clipped, draw.texture, tilesX);
+            }
+        }
+    }
+}
+
+// Set up a triangle and bin it
+void SoftwareRenderBackend::binTriangle(BinGroup& group, const ClipVertex* vertices, const Texture* texture, int tilesX) {
+    float x[3], y[3];
+    Triangle triangle;
+
+    for (int i = 0; i < 3; i++) {
+        const glm::vec4& position = vertices[i].position;
+        float inverseW = 1.0f / position.w;
+        x[i] = (position.x * inverseW * 0.5f + 0.5f) * m_width;
+        y[i] = (0.5f - position.y * inverseW * 0.5f) * m_height;
+    }
+
+    // Both windings are drawn (like the Metal pipeline), turn them all counter-clockwise
+    int order[3] = {0, 1, 2};
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area < 0.0f) {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+    if (!(area > 0.0f) || !std::isfinite(area)) {
+        return;
+    }
+
+    float sx[3] = {x[order[0]], x[order[1]], x[order[2]]};
+    float sy[3] = {y[order[0]], y[order[1]], y[order[2]]};
+
+    // Pixels whose centers lie in the bounding box
+    triangle.minX = std::max(static_cast<int>(std::ceil(std::min(std::min(sx[0], sx[1]), sx[2]) - 0.5f)), 0);
+    triangle.maxX = std::min(static_cast<int>(std::floor(std::max(std::max(sx[0], sx[1]), sx[2]) - 0.5f)), m_width - 1);
+    triangle.minY = std::max(static_cast<int>(std::ceil(std::min(std::min(sy[0], sy[1]), sy[2]) - 0.5f)), 0);
+    triangle.maxY = std::min(static_cast<int>(std::floor(std::max(std::max(sy[0], sy[1]), sy[2]) - 0.5f)), m_height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+
+    // Edge i is opposite vertex i, positive inside
+    for (int i = 0; i < 3; i++) {
+        int a = (i + 1) % 3;
+        int b = (i + 2) % 3;
+        triangle.edgeA[i] = sy[a] - sy[b];
+        triangle.edgeB[i] = sx[b] - sx[a];
+        triangle.edgeC[i] = -(triangle.edgeA[i] * sx[a] + triangle.edgeB[i] * sy[a]);
+
+        // Shared edges run in opposite directions in their two triangles, so exactly one owns them
+        triangle.inclusive[i] = triangle.edgeA[i] > 0.0f || (triangle.edgeA[i] == 0.0f && triangle.edgeB[i] > 0.0f);
+    }
+
+    // Attribute planes from barycentric weights (depth is linear in screen space, the rest divided by w)
+    float values[7][3];
+    for (int i = 0; i < 3; i++) {
+        const ClipVertex& vertex = vertices[order[i]];
+        float inverseW = 1.0f / vertex.position.w;
+        values[0][i] = vertex.position.z * inverseW;
+        values[1][i] = inverseW;
+        values[2][i] = vertex.u * inverseW;
+        values[3][i] = vertex.v * inverseW;
+        values[4][i] = vertex.red * inverseW;
+        values[5][i] = vertex.green * inverseW;
+        values[6][i] = vertex.blue * inverseW;
+    }
+
+    float* planes[7] = {triangle.depth, triangle.inverseW, triangle.u, triangle.v, triangle.red, triangle.green, triangle.blue};
+    float inverseArea = 1.0f / area;
+    for (int attribute = 0; attribute < 7; attribute++) {
+        float delta1 = values[attribute][1] - values[attribute][0];
+        float delta2 = values[attribute][2] - values[attribute][0];
+        planes[attribute][0] = (triangle.edgeA[1] * delta1 + triangle.edgeA[2] * delta2) * inverseArea;
+        planes[attribute][1] = (triangle.edgeB[1] * delta1 + triangle.edgeB[2] * delta2) * inverseArea;
+        planes[attribute][2] = values[attribute][0] + (triangle.edgeC[1] * delta1 + triangle.edgeC[2] * delta2) * inverseArea;
+    }
+    triangle.texture = texture;
+
+    uint32_t index = static_cast<uint32_t>(group.triangles.size());
+    group.triangles.push_back(triangle);
+
+    for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; tileY++) {
+        for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; tileX++) {
+            group.tiles[static_cast<size_t>(tileY) * tilesX + tileX].push_back(index);
+        }
+    }
+}
+
+// Rasterize the binned triangles of a tile
+uint64_t SoftwareRenderBackend::rasterizeTile(int tile, int tilesX, bool clear) const {
+    int tileX = (tile % tilesX) * TILE_SIZE;
+    int tileY = (tile / tilesX) * TILE_SIZE;
+    int endX = std::min(tileX + TILE_SIZE, m_width);
+    int endY = std::min(tileY + TILE_SIZE, m_height);
+
+    Texture& color = *m_colorTarget;
+    Texture& depth = *m_depthTarget;
+
+    if (clear) {
+        for (int y = tileY; y < tileY + TILE_SIZE; y++) {
+            size_t row = static_cast<size_t>(y) * color.stride + tileX;
+            std::fill(&color.pixels[row], &color.pixels[row] + TILE_SIZE, m_clearColor);
+            std::fill(&depth.depth[row], &depth.depth[row] + TILE_SIZE, 1.0f);
+        }
+    }
+
+    const Float4 laneOffsets = {0.5f, 1.5f, 2.5f, 3.5f};
+    const Float4 zero = splat(0.0f);
+    const Float4 limitX = splat(static_cast<float>(endX));
+    uint64_t shaded = 0;
+
+    for (size_t groupIndex = 0; groupIndex < m_activeGroups; groupIndex++) {
+        const BinGroup& group = m_groups[groupIndex];
+
+        for (uint32_t index : group.tiles[tile]) {
+            const Triangle& triangle = group.triangles[index];
+
+            // Spans of four pixels start aligned, so they never cross the tile
+            int minX = std::max(triangle.minX, tileX) & ~3;
+            int maxX = std::min(triangle.maxX, endX - 1);
+            int minY = std::max(triangle.minY, tileY);
+            int maxY = std::min(triangle.maxY, endY - 1);
+
+            Float4 edgeA0 = splat(triangle.edgeA[0]), edgeA1 = splat(triangle.edgeA[1]), edgeA2 = splat(triangle.edgeA[2]);
+            Float4 depthA = splat(triangle.depth[0]);
+
+            for (int y = minY; y <= maxY; y++) {
+                float centerY = y + 0.5f;
+                Float4 row0 = splat(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+                Float4 row1 = splat(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+                Float4 row2 = splat(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+                Float4 rowDepth = splat(triangle.depth[1] * centerY + triangle.depth[2]);
+
+                float* depthRow = &depth.depth[static_cast<size_t>(y) * depth.stride];
+                uint32_t* colorRow = &color.pixels[static_cast<size_t>(y) * color.stride];
+
+                for (int x = minX; x <= maxX; x += 4) {
+                    Float4 centerX = splat(static_cast<float>(x)) + laneOffsets;
+                    Float4 w0 = edgeA0 * centerX + row0;
+                    Float4 w1 = edgeA1 * centerX + row1;
+                    Float4 w2 = edgeA2 * centerX + row2;
+
+                    Int4 inside = (triangle.inclusive[0] ? (w0 >= zero) : (w0 > zero)) &
+                                  (triangle.inclusive[1] ? (w1 >= zero) : (w1 > zero)) &
+                                  (triangle.inclusive[2] ? (w2 >= zero) : (w2 > zero)) & (centerX < limitX);
+                    if (!anyLane(inside)) {
+                        continue;
+                    }
+
+                    // Depth test and write
+                    Float4 z = depthA * centerX + rowDepth;
+                    Float4 stored;
+                    std::memcpy(&stored, depthRow + x, sizeof(Float4));
+                    Int4 pass = inside & (z < stored);
+                    if (!anyLane(pass)) {
+                        continue;
+                    }
+                    stored = select(pass, z, stored);
+                    std::memcpy(depthRow + x, &stored, sizeof(Float4));
+
+                    // Shade passing pixels with perspective correct attributes
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (!pass[lane]) {
+                            continue;
+                        }
+
+                        float px = centerX[lane];
+                        float w = 1.0f / (triangle.inverseW[0] * px + triangle.inverseW[1] * centerY + triangle.inverseW[2]);
+                        float red = (triangle.red[0] * px + triangle.red[1] * centerY + triangle.red[2]) * w;
+                        float green = (triangle.green[0] * px + triangle.green[1] * centerY + triangle.green[2]) * w;
+                        float blue = (triangle.blue[0] * px + triangle.blue[1] * centerY + triangle.blue[2]) * w;
+
+                        uint32_t texel = 0xFFFFFFFF;
+                        if (triangle.texture) {
+                            float u = (triangle.u[0] * px + triangle.u[1] * centerY + triangle.u[2]) * w;
+                            float v = (triangle.v[0] * px + triangle.v[1] * centerY + triangle.v[2]) * w;
+                            const Texture& texture = *triangle.texture;
+                            int texelX = static_cast<int>((u - std::floor(u)) * texture.width);
+                            int texelY = static_cast<int>((v - std::floor(v)) * texture.height);
+                            texelX = std::min(std::max(texelX, 0), texture.width - 1);
+                            texelY = std::min(std::max(texelY, 0), texture.height - 1);
+                            texel = texture.pixels[static_cast<size_t>(texelY) * texture.stride + texelX];
+                        }
+
+                        colorRow[x + lane] = packColor((texel & 0xFF) / 255.0f * red, ((texel >> 8) & 0xFF) / 255.0f * green,
+                                                       ((texel >> 16) & 0xFF) / 255.0f * blue, (texel >> 24) / 255.0f);
+                        shaded++;
+                    }
+                }
+            }
+        }
+    }
+
+    return shaded;
+}
+
+// Run body(i) for i in [0, count)
+void SoftwareRenderBackend::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (m_scheduler) {
+        m_scheduler->parallelFor(count, 1, body);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            body(i);
+        }
+    }
+}
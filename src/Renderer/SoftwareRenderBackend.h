@@ -0,0 +1,190 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include "RenderTargetPool.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+class TaskScheduler;
+
+// Software rasterizer counters of one frame
+struct SoftwareRasterStats {
+    uint64_t triangles;         // Triangles submitted
+    uint64_t rasterized;        // Triangles left after clipping, binned into tiles
+    uint64_t binEntries;        // Triangle references over all tiles
+    uint64_t pixelsShaded;      // Fragments passing the depth test
+    uint32_t passes;            // Bin and raster rounds (bins hold MAX_PASS_TRIANGLES at most)
+    double binMs;               // Transforming, clipping and binning
+    double rasterMs;            // Rasterizing and shading tiles
+};
+
+// Software render backend class
+//
+// Draws chunk meshes on the CPU for thumbnails, visual regression tests and
+// machines without a GPU. Draws are only recorded until endFrame. Then groups
+// of draws are transformed, clipped against the near plane and binned into
+// TILE_SIZE tiles in parallel, and the tiles are rasterized in parallel. Edge
+// functions and depth tests run on four pixels at a time, and pixels are
+// shaded like the voxel shader: atlas texel times vertex light and diffuse.
+// Draw order is kept within every tile, so front-to-back draw lists reject
+// most hidden pixels early. Output is RGBA8 and can be written as a PPM image.
+class SoftwareRenderBackend : public RenderBackend {
+public:
+    // Width and height of a tile rasterized by one task
+    static const int TILE_SIZE = 64;
+
+    // Triangles binned before tiles are rasterized, bounding bin memory
+    static const size_t MAX_PASS_TRIANGLES = 256 * 1024;
+
+    // Create a backend drawing width * height frames, across the scheduler's workers if given
+    SoftwareRenderBackend(int width, int height, TaskScheduler* scheduler = nullptr);
+
+    // Delete copy constructor and assignment operator
+    SoftwareRenderBackend(const SoftwareRenderBackend&) = delete;
+    SoftwareRenderBackend& operator=(const SoftwareRenderBackend&) = delete;
+
+    // RenderBackend
+    bool init() override;
+    RenderHandle createBuffer(const void* data, size_t size) override;
+    void updateBuffer(RenderHandle buffer, size_t offset, const void* data, size_t size) override;
+    void destroyBuffer(RenderHandle buffer) override;
+    RenderHandle createTexture(const uint32_t* pixels, int width, int height) override;
+    void destroyTexture(RenderHandle texture) override;
+    RenderHandle createRenderTarget(int width, int height, RenderTargetFormat format) override;
+    RenderTargetStats getRenderTargetStats() const override;
+    bool beginFrame(const glm::vec4& clearColor) override;
+    void setTexture(RenderHandle texture) override;
+    void setUniforms(const DrawUniforms& uniforms) override;
+    void drawIndexed(RenderHandle vertexBuffer, size_t vertexOffset, RenderHandle indexBuffer, uint32_t indexCount) override;
+    void setFrameUniforms(const FrameUniforms& uniforms) override;
+    void setInstanceBuffer(RenderHandle buffer, size_t offset) override;
+    void drawBatch(RenderHandle vertexBuffer, RenderHandle indexBuffer, const DrawCommand* commands, size_t count) override;
+    void endFrame() override;
+
+    // Set the size of the following frames
+    void setFrameSize(int width, int height);
+
+    // Get frame size
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    // Copy the last frame as width * height RGBA8 pixels (R in the lowest byte), returns false before the first frame
+    bool readPixels(std::vector<uint32_t>& pixels) const;
+
+    // Write the last frame as a binary PPM image, returns false on failure
+    bool writeImage(const std::string& filename) const;
+
+    // Get counters of the last frame
+    const SoftwareRasterStats& getLastFrameStats() const { return m_lastStats; }
+
+private:
+    // Texture or render target (rows padded to whole tiles for render targets)
+    struct Texture {
+        int width;
+        int height;
+        int stride;
+        std::vector<uint32_t> pixels;   // RGBA8 textures and color targets
+        std::vector<float> depth;       // Depth targets
+    };
+
+    // Vertex in clip space with attributes
+    struct ClipVertex {
+        glm::vec4 position;
+        float u, v;
+        float red, green, blue;         // Vertex light times ambient occlusion and diffuse
+    };
+
+    // Recorded draw
+    struct Draw {
+        glm::mat4 modelViewProjection;
+        glm::mat4 model;
+        const uint8_t* vertices;        // First vertex of the draw
+        uint32_t vertexCount;           // Vertices available from there
+        const uint32_t* indices;
+        uint32_t indexCount;
+        const Texture* texture;
+    };
+
+    // Triangle set up for rasterization (planes are a * x + b * y + c at pixel centers)
+    struct Triangle {
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        bool inclusive[3];              // Pixels exactly on the edge belong to this triangle
+        float depth[3];
+        float inverseW[3];
+        float u[3];                     // Attributes divided by w
+        float v[3];
+        float red[3];
+        float green[3];
+        float blue[3];
+        int minX, minY, maxX, maxY;
+        const Texture* texture;
+    };
+
+    // Draws binned by one task
+    struct BinGroup {
+        size_t firstDraw;
+        size_t endDraw;
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<uint32_t>> tiles;   // Triangle indices per tile, in draw order
+        std::vector<ClipVertex> vertices;           // Transformed vertices of the current draw
+        uint64_t submitted;
+    };
+
+    // Frame size
+    int m_width;
+    int m_height;
+
+    // Workers rasterizing (not owned, may be nullptr)
+    TaskScheduler* m_scheduler;
+
+    // Buffers, textures and render targets by handle
+    std::unordered_map<RenderHandle, std::vector<uint8_t>> m_buffers;
+    std::unordered_map<RenderHandle, Texture> m_textures;
+    RenderHandle m_nextHandle;
+
+    // Frame being recorded
+    bool m_inFrame;
+    RenderHandle m_colorHandle;
+    Texture* m_colorTarget;
+    Texture* m_depthTarget;
+    uint32_t m_clearColor;
+    const Texture* m_texture;
+    glm::mat4 m_modelViewProjection;
+    glm::mat4 m_model;
+    glm::mat4 m_viewProjection;
+    const uint8_t* m_instances;
+    size_t m_instanceCount;
+    std::vector<Draw> m_draws;
+
+    // Bin groups, kept to reuse their memory (the first m_activeGroups are used by the current pass)
+    std::vector<BinGroup> m_groups;
+    size_t m_activeGroups;
+
+    // Last finished frame
+    RenderHandle m_lastColor;
+    SoftwareRasterStats m_lastStats;
+
+    // Color and depth targets reused across frames (declared last, its destructor destroys textures)
+    RenderTargetPool m_renderTargets;
+
+    // Record a draw of indexCount indices with vertices starting at vertexOffset bytes
+    void addDraw(const std::vector<uint8_t>& vertexBuffer, size_t vertexOffset, const std::vector<uint8_t>& indexBuffer,
+                 uint32_t indexCount, const glm::mat4& model, const glm::mat4& modelViewProjection);
+
+    // Transform, clip and bin the draws of a group
+    void binGroup(BinGroup& group, int tilesX, int tilesY);
+
+    // Set up a screen space triangle and add it to the bins of the tiles it overlaps
+    void binTriangle(BinGroup& group, const ClipVertex* vertices, const Texture* texture, int tilesX);
+
+    // Rasterize the binned triangles of a tile, clearing it first if asked
+    uint64_t rasterizeTile(int tile, int tilesX, bool clear) const;
+
+    // Run body(i) for i in [0, count) on the workers, or inline without a scheduler
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+};
@@ -0,0 +1,104 @@
+#include "CameraRecording.h"
+#include <cstring>
+#include <fstream>
+
+// File magic
+static const char MAGIC[4] = {'T', 'C', 'A', 'M'};
+
+// File header
+struct RecordingHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t tickRate;
+    uint32_t frameCount;
+};
+
+// Pose as stored in the file
+struct RecordingFrame {
+    float position[3];
+    float yaw;
+    float pitch;
+};
+
+// Constructor
+CameraRecording::CameraRecording(int tickRate)
+    : m_tickRate(tickRate) {
+}
+
+// Append the pose of one tick
+void CameraRecording::addFrame(const CameraPose& pose) {
+    m_frames.push_back(pose);
+}
+
+// Remove all frames
+void CameraRecording::clear() {
+    m_frames.clear();
+}
+
+// Save to a file
+bool CameraRecording::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    RecordingHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.tickRate = static_cast<uint32_t>(m_tickRate);
+    header.frameCount = static_cast<uint32_t>(m_frames.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const CameraPose& pose : m_frames) {
+        RecordingFrame frame;
+        frame.position[0] = pose.position.x;
+        frame.position[1] = pose.position.y;
+        frame.position[2] = pose.position.z;
+        frame.yaw = pose.yaw;
+        frame.pitch = pose.pitch;
+        file.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+    }
+
+    return static_cast<bool>(file);
+}
+
+// Load from a file
+bool CameraRecording::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    RecordingHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION || header.tickRate == 0) {
+        return false;
+    }
+
+    // The frames must be in the file before they are allocated, a corrupt count could ask for gigabytes
+    std::streampos framesStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streampos fileEnd = file.tellg();
+    if (framesStart < 0 || fileEnd < framesStart ||
+        static_cast<uint64_t>(header.frameCount) * sizeof(RecordingFrame) > static_cast<uint64_t>(fileEnd - framesStart)) {
+        return false;
+    }
+    file.seekg(framesStart);
+
+    std::vector<CameraPose> frames(header.frameCount);
+    for (CameraPose& pose : frames) {
+        RecordingFrame frame;
+        if (!file.read(reinterpret_cast<char*>(&frame), sizeof(frame))) {
+            return false;
+        }
+
+        pose.position = glm::vec3(frame.position[0], frame.position[1], frame.position[2]);
+        pose.yaw = frame.yaw;
+        pose.pitch = frame.pitch;
+    }
+
+    m_tickRate = static_cast<int>(header.tickRate);
+    m_frames.swap(frames);
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Camera.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Camera recording class
+//
+// One camera pose per simulation tick, stored in a compact binary file
+// (header with magic, version and tick rate, then 20 bytes per tick). Replaying
+// sets the camera to the recorded pose tick by tick, so a replay visits exactly
+// the same positions regardless of frame rate or input devices.
+class CameraRecording {
+public:
+    // Current file format version
+    static const uint32_t FORMAT_VERSION = 1;
+
+    CameraRecording(int tickRate = 60);
+
+    // Append the pose of one tick
+    void addFrame(const CameraPose& pose);
+
+    // Remove all frames
+    void clear();
+
+    // Get number of recorded ticks
+    size_t getFrameCount() const { return m_frames.size(); }
+
+    // Get pose of a tick
+    const CameraPose& getFrame(size_t index) const { return m_frames[index]; }
+
+    // Get ticks per second the recording was made at
+    int getTickRate() const { return m_tickRate; }
+
+    // Save to a file, returns false on failure
+    bool save(const std::string& filename) const;
+
+    // Load from a file, returns false on failure
+    bool load(const std::string& filename);
+
+private:
+    // Ticks per second
+    int m_tickRate;
+
+    // Pose per tick
+    std::vector<CameraPose> m_frames;
+};
@@ -0,0 +1,97 @@
+#include "FrameTimings.h"
+#include <fstream>
+#include <iomanip>
+
+// Phase names, also used as CSV and JSON keys
+static const char* PHASE_NAMES[FrameTimings::PHASE_COUNT] = {
+    "generation",
+    "meshing",
+    "culling",
+    "draw_list",
+    "submit",
+    "total"
+};
+
+// Add a frame
+void FrameTimings::add(const FrameTiming& frame) {
+    m_frames.push_back(frame);
+
+    m_stats[GENERATION].add(frame.generationMs);
+    m_stats[MESHING].add(frame.meshingMs);
+    m_stats[CULLING].add(frame.cullingMs);
+    m_stats[DRAW_LIST].add(frame.drawListMs);
+    m_stats[SUBMIT].add(frame.submitMs);
+    m_stats[TOTAL].add(frame.generationMs + frame.meshingMs + frame.cullingMs + frame.drawListMs + frame.submitMs);
+}
+
+// Get name of a phase
+const char* FrameTimings::getPhaseName(Phase phase) {
+    return PHASE_NAMES[phase];
+}
+
+// Write one row per frame as CSV
+bool FrameTimings::writeCsv(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    file << "frame,generation_ms,meshing_ms,culling_ms,draw_list_ms,submit_ms,chunks_generated,chunks_meshed,chunks_visible,"
+         << "chunks_missing,draws,upload_bytes\n";
+    file << std::fixed << std::setprecision(4);
+
+    for (size_t i = 0; i < m_frames.size(); i++) {
+        const FrameTiming& frame = m_frames[i];
+        file << i << ',' << frame.generationMs << ',' << frame.meshingMs << ',' << frame.cullingMs << ','
+             << frame.drawListMs << ',' << frame.submitMs << ',' << frame.chunksGenerated << ',' << frame.chunksMeshed << ','
+             << frame.chunksVisible << ',' << frame.chunksMissing << ',' << frame.draws << ',' << frame.uploadBytes << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+// Write summary and frames as JSON
+bool FrameTimings::writeJson(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"frames\": " << m_frames.size() << ",\n  \"summary\": {\n";
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        const TimingStats& stats = m_stats[phase];
+        file << "    \"" << PHASE_NAMES[phase] << "\": {\"mean\": " << stats.getMean()
+             << ", \"p50\": " << stats.getPercentile(50.0) << ", \"p99\": " << stats.getPercentile(99.0)
+             << ", \"max\": " << stats.getMax() << "}" << (phase + 1 < PHASE_COUNT ? "," : "") << "\n";
+    }
+
+    file << "  },\n  \"timeline\": [\n";
+
+    for (size_t i = 0; i < m_frames.size(); i++) {
+        const FrameTiming& frame = m_frames[i];
+        file << "    [" << frame.generationMs << ", " << frame.meshingMs << ", " << frame.cullingMs << ", "
+             << frame.drawListMs << ", " << frame.submitMs << ", " << frame.chunksGenerated << ", " << frame.chunksMeshed << ", "
+             << frame.chunksVisible << ", " << frame.chunksMissing << ", " << frame.draws << ", " << frame.uploadBytes << "]" << (i + 1 < m_frames.size() ? "," : "") << "\n";
+    }
+
+    file << "  ],\n  \"timeline_columns\": [\"generation_ms\", \"meshing_ms\", \"culling_ms\", \"draw_list_ms\", \"submit_ms\", "
+         << "\"chunks_generated\", \"chunks_meshed\", \"chunks_visible\", \"chunks_missing\", \"draws\", \"upload_bytes\"]\n}\n";
+
+    return static_cast<bool>(file);
+}
+
+// Write the per-phase summary as text
+void FrameTimings::printSummary(std::ostream& out) const {
+    out << std::fixed << std::setprecision(3);
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        const TimingStats& stats = m_stats[phase];
+        out << "  " << std::left << std::setw(12) << PHASE_NAMES[phase] << std::right
+            << " mean " << std::setw(8) << stats.getMean()
+            << "  p50 " << std::setw(8) << stats.getPercentile(50.0)
+            << "  p99 " << std::setw(8) << stats.getPercentile(99.0)
+            << "  max " << std::setw(8) << stats.getMax() << " ms\n";
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Core/TimingStats.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Timing of one frame
+struct FrameTiming {
+    double generationMs;        // Simulation tick, including chunk streaming and generation
+    double meshingMs;           // Meshing dirty chunks
+    double cullingMs;           // Frustum culling
+    double drawListMs;          // Ordering the draw list
+    double submitMs;            // Submitting draws to the render backend
+    uint32_t chunksGenerated;
+    uint32_t chunksMeshed;
+    uint32_t chunksVisible;
+    uint32_t chunksMissing;     // Columns in range and view that are not loaded yet
+    uint32_t draws;             // Draw calls submitted
+    uint64_t uploadBytes;       // Bytes uploaded to the render backend
+};
+
+// Frame timings class
+//
+// Collects per-frame timings of a replay and writes them as CSV or JSON, with
+// p50/p99 summaries per phase for regression tracking.
+class FrameTimings {
+public:
+    // Timed phases
+    enum Phase {
+        GENERATION = 0,
+        MESHING,
+        CULLING,
+        DRAW_LIST,
+        SUBMIT,
+        TOTAL,
+        PHASE_COUNT
+    };
+
+    // Add a frame
+    void add(const FrameTiming& frame);
+
+    // Get number of frames
+    size_t getFrameCount() const { return m_frames.size(); }
+
+    // Get statistics of a phase
+    const TimingStats& getStats(Phase phase) const { return m_stats[phase]; }
+
+    // Get name of a phase
+    static const char* getPhaseName(Phase phase);
+
+    // Write one row per frame as CSV, returns false on failure
+    bool writeCsv(const std::string& filename) const;
+
+    // Write summary and frames as JSON, returns false on failure
+    bool writeJson(const std::string& filename) const;
+
+    // Write the per-phase summary (mean, p50, p99, max) as text
+    void printSummary(std::ostream& out) const;
+
+private:
+    // Frames in order
+    std::vector<FrameTiming> m_frames;
+
+    // Statistics per phase
+    TimingStats m_stats[PHASE_COUNT];
+};
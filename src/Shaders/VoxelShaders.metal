@@ -24,6 +24,17 @@ struct Uniforms {
     float4x4 projectionMatrix;
 };
 
+// Uniform buffer of batched draws
+struct BatchUniforms {
+    float4x4 viewMatrix;
+    float4x4 projectionMatrix;
+};
+
+// Per-draw data of batched draws
+struct DrawInstance {
+    float4 origin;
+};
+
 // Vertex shader
 vertex VertexOutput voxelVertexShader(VertexInput in [[stage_in]],
                                      constant Uniforms& uniforms [[buffer(1)]]) {
@@ -46,6 +57,25 @@ vertex VertexOutput voxelVertexShader(VertexInput in [[stage_in]],
     return out;
 }
 
+// Vertex shader of batched draws (chunk meshes are only translated)
+vertex VertexOutput voxelBatchVertexShader(VertexInput in [[stage_in]],
+                                          constant BatchUniforms& uniforms [[buffer(1)]],
+                                          const device DrawInstance* instances [[buffer(2)]],
+                                          uint instanceId [[instance_id]]) {
+    VertexOutput out;
+    
+    // Transform position (instance_id includes the base instance of the draw)
+    float4 worldPosition = float4(in.position + instances[instanceId].origin.xyz, 1.0);
+    out.position = uniforms.projectionMatrix * (uniforms.viewMatrix * worldPosition);
+    
+    // Pass through texture coordinates, normal and color
+    out.texCoord = in.texCoord;
+    out.normal = in.normal;
+    out.color = in.color;
+    
+    return out;
+}
+
 // Fragment shader
 fragment float4 voxelFragmentShader(VertexOutput in [[stage_in]],
                                    texture2d<float> textureAtlas [[texture(0)]],
@@ -57,8 +87,8 @@ fragment float4 voxelFragmentShader(VertexOutput in [[stage_in]],
     float3 lightDirection = normalize(float3(0.5, 1.0, 0.5));
     float diffuse = max(dot(in.normal, lightDirection), 0.2);
     
-    // Combine texture color, vertex color, and lighting
-    float4 finalColor = textureColor * in.color * diffuse;
+    // Combine texture color, baked light (rgb), ambient occlusion (alpha), and lighting
+    float4 finalColor = float4(textureColor.rgb * in.color.rgb * in.color.a * diffuse, textureColor.a);
     
     return finalColor;
 } 
\ No newline at end of file
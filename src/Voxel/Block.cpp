@@ -13,6 +13,7 @@ void Block::initBlockProperties() {
         true,   // transparent
         false,  // solid
         false,  // liquid
+        0,      // light emission
         "Air",  // name
         {
             {0.0f, 0.0f}, // Front
@@ -29,6 +30,7 @@ void Block::initBlockProperties() {
         false,  // transparent
         true,   // solid
         false,  // liquid
+        0,      // light emission
         "Grass", // name
         {
             {0.0f, 0.0f}, // Front - Side texture
@@ -45,6 +47,7 @@ void Block::initBlockProperties() {
         false,  // transparent
         true,   // solid
         false,  // liquid
+        0,      // light emission
         "Dirt", // name
         {
             {0.25f, 0.0f}, // Front
@@ -61,6 +64,7 @@ void Block::initBlockProperties() {
         false,  // transparent
         true,   // solid
         false,  // liquid
+        0,      // light emission
         "Stone", // name
         {
             {0.5f, 0.0f}, // Front
@@ -77,6 +81,7 @@ void Block::initBlockProperties() {
         false,  // transparent
         true,   // solid
         false,  // liquid
+        0,      // light emission
         "Sand", // name
         {
             {0.75f, 0.0f}, // Front
@@ -93,6 +98,7 @@ void Block::initBlockProperties() {
         true,   // transparent
         false,  // solid
         true,   // liquid
+        0,      // light emission
         "Water", // name
         {
             {0.0f, 0.25f}, // Front
@@ -109,6 +115,7 @@ void Block::initBlockProperties() {
         false,  // transparent
         true,   // solid
         false,  // liquid
+        0,      // light emission
         "Wood", // name
         {
             {0.25f, 0.25f}, // Front
@@ -125,6 +132,7 @@ void Block::initBlockProperties() {
         true,   // transparent (semi-transparent)
         true,   // solid
         false,  // liquid
+        0,      // light emission
         "Leaves", // name
         {
             {0.75f, 0.25f}, // Front
@@ -136,6 +144,23 @@ void Block::initBlockProperties() {
         }
     };
     
+    // Glowstone
+    s_blockProperties[BlockType::Glowstone] = {
+        false,  // transparent
+        true,   // solid
+        false,  // liquid
+        15,     // light emission
+        "Glowstone", // name
+        {
+            {0.0f, 0.5f}, // Front
+            {0.0f, 0.5f}, // Back
+            {0.0f, 0.5f}, // Left
+            {0.0f, 0.5f}, // Right
+            {0.0f, 0.5f}, // Top
+            {0.0f, 0.5f}  // Bottom
+        }
+    };
+    
     s_initialized = true;
 }
 
@@ -155,6 +180,12 @@ bool Block::isLiquid(BlockType type) {
     return s_blockProperties[type].liquid;
 }
 
+// Get emitted block light level
+uint8_t Block::getLightEmission(BlockType type) {
+    if (!s_initialized) initBlockProperties();
+    return s_blockProperties[type].lightEmission;
+}
+
 // Get texture coordinates for a specific face of a block
 void Block::getTextureCoords(BlockType type, BlockFace face, float& u, float& v) {
     if (!s_initialized) initBlockProperties();
@@ -14,6 +14,7 @@ enum class BlockType : uint8_t {
     Water,
     Wood,
     Leaves,
+    Glowstone,
     // Add more block types as needed
     Count
 };
@@ -37,6 +38,9 @@ public:
     static bool isSolid(BlockType type);
     static bool isLiquid(BlockType type);
     
+    // Get emitted block light level (0-15)
+    static uint8_t getLightEmission(BlockType type);
+    
     // Get texture coordinates for a specific face of a block
     static void getTextureCoords(BlockType type, BlockFace face, float& u, float& v);
     
@@ -49,6 +53,7 @@ private:
         bool transparent;
         bool solid;
         bool liquid;
+        uint8_t lightEmission;
         std::string name;
         // Texture coordinates for each face [face][u,v]
         float textureCoords[static_cast<size_t>(BlockFace::Count)][2];
@@ -1,83 +1,48 @@
 #include "Chunk.h"
+#include "ChunkMesher.h"
+#include "SectionPool.h"
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 
-// Noise library for terrain generation
-#include "FastNoise.h"
+// Column heights shared with the world map
+#include "TerrainGenerator.h"
 
-// Face normals
-const float FACE_NORMALS[6][3] = {
-    { 0.0f,  0.0f,  1.0f}, // Front
-    { 0.0f,  0.0f, -1.0f}, // Back
-    {-1.0f,  0.0f,  0.0f}, // Left
-    { 1.0f,  0.0f,  0.0f}, // Right
-    { 0.0f,  1.0f,  0.0f}, // Top
-    { 0.0f, -1.0f,  0.0f}  // Bottom
-};
-
-// Face vertices (positions relative to block origin)
-const float FACE_VERTICES[6][4][3] = {
-    // Front face (z+)
-    {
-        {0.0f, 0.0f, 1.0f}, // Bottom-left
-        {1.0f, 0.0f, 1.0f}, // Bottom-right
-        {1.0f, 1.0f, 1.0f}, // Top-right
-        {0.0f, 1.0f, 1.0f}  // Top-left
-    },
-    // Back face (z-)
-    {
-        {1.0f, 0.0f, 0.0f}, // Bottom-left
-        {0.0f, 0.0f, 0.0f}, // Bottom-right
-        {0.0f, 1.0f, 0.0f}, // Top-right
-        {1.0f, 1.0f, 0.0f}  // Top-left
-    },
-    // Left face (x-)
-    {
-        {0.0f, 0.0f, 0.0f}, // Bottom-left
-        {0.0f, 0.0f, 1.0f}, // Bottom-right
-        {0.0f, 1.0f, 1.0f}, // Top-right
-        {0.0f, 1.0f, 0.0f}  // Top-left
-    },
-    // Right face (x+)
-    {
-        {1.0f, 0.0f, 1.0f}, // Bottom-left
-        {1.0f, 0.0f, 0.0f}, // Bottom-right
-        {1.0f, 1.0f, 0.0f}, // Top-right
-        {1.0f, 1.0f, 1.0f}  // Top-left
-    },
-    // Top face (y+)
-    {
-        {0.0f, 1.0f, 1.0f}, // Bottom-left
-        {1.0f, 1.0f, 1.0f}, // Bottom-right
-        {1.0f, 1.0f, 0.0f}, // Top-right
-        {0.0f, 1.0f, 0.0f}  // Top-left
-    },
-    // Bottom face (y-)
-    {
-        {0.0f, 0.0f, 0.0f}, // Bottom-left
-        {1.0f, 0.0f, 0.0f}, // Bottom-right
-        {1.0f, 0.0f, 1.0f}, // Top-right
-        {0.0f, 0.0f, 1.0f}  // Top-left
-    }
-};
-
-// Face texture coordinates
-const float FACE_TEX_COORDS[4][2] = {
-    {0.0f, 1.0f}, // Bottom-left
-    {1.0f, 1.0f}, // Bottom-right
-    {1.0f, 0.0f}, // Top-right
-    {0.0f, 0.0f}  // Top-left
-};
+// Terrain generations so far, numbering the edits of every load
+static std::atomic<uint32_t> s_generationCount(0);
 
 // Constructor
 Chunk::Chunk(int x, int z)
-    : m_position({x, z}), m_dirty(true) {
-    // Initialize blocks to air
-    std::fill(m_blocks.begin(), m_blocks.end(), BlockType::Air);
+    : m_position({x, z}), m_dirtySections(ALL_SECTIONS), m_editCount(0), m_generation(0), m_dirtyQueue(nullptr), m_queued(false) {
+    // Initialize blocks to air, shared with every other empty section
+    SectionBlocks air;
+    air.fill(BlockType::Air);
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        m_sharedSections[section] = SectionPool::intern(air.data());
+        m_sectionBlocks[section] = m_sharedSections[section]->data();
+    }
+    
+    // Initialize light to dark (the light engine fills it in)
+    std::fill(m_light.begin(), m_light.end(), 0);
+    std::fill(m_sectionBlockCounts, m_sectionBlockCounts + CHUNK_SECTIONS, 0);
+    
+    // No neighbors until the world links them
+    std::fill(m_neighbors, m_neighbors + 4, nullptr);
+    
+    // Nothing meshed yet
+    std::fill(m_sectionMeshes, m_sectionMeshes + CHUNK_SECTIONS, getEmptyMesh());
 }
 
 // Destructor
 Chunk::~Chunk() {
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        if (m_sharedSections[section]) {
+            SectionPool::release(m_sharedSections[section]);
+        }
+    }
 }
 
 // Get block at position
@@ -86,8 +51,7 @@ BlockType Chunk::getBlock(int x, int y, int z) const {
         return BlockType::Air;
     }
     
-    int index = y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x;
-    return m_blocks[index];
+    return getBlockUnchecked(x, y, z);
 }
 
 // Set block at position
@@ -96,9 +60,59 @@ void Chunk::setBlock(int x, int y, int z, BlockType type) {
         return;
     }
     
-    int index = y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x;
-    m_blocks[index] = type;
-    m_dirty = true;
+    int section = y / SECTION_HEIGHT;
+    int index = (y % SECTION_HEIGHT) * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x;
+    BlockType oldType = m_sectionBlocks[section][index];
+    m_editCount++;
+    
+    // Copy a shared section before its first change
+    if (type != oldType) {
+        if (!m_ownedSections[section]) {
+            m_ownedSections[section].reset(new SectionBlocks(*m_sharedSections[section]));
+            SectionPool::release(m_sharedSections[section]);
+            m_sharedSections[section] = nullptr;
+            m_sectionBlocks[section] = m_ownedSections[section]->data();
+        }
+        (*m_ownedSections[section])[index] = type;
+    }
+    
+    // Keep the section block count in sync
+    if (oldType == BlockType::Air && type != BlockType::Air) {
+        m_sectionBlockCounts[section]++;
+    } else if (oldType != BlockType::Air && type == BlockType::Air) {
+        m_sectionBlockCounts[section]--;
+    }
+    
+    markSectionDirty(y);
+}
+
+// Set mesh dirty flag for all sections
+void Chunk::setDirty(bool dirty) {
+    m_dirtySections = dirty ? ALL_SECTIONS : 0;
+    
+    if (dirty) {
+        enqueueDirty();
+    }
+}
+
+// Mark the section containing y dirty
+void Chunk::markSectionDirty(int y) {
+    if (y < 0 || y >= CHUNK_HEIGHT) {
+        return;
+    }
+    
+    enqueueDirty();
+    
+    int section = y / SECTION_HEIGHT;
+    m_dirtySections |= 1u << section;
+    
+    // Blocks on a section border are visible from the adjacent section
+    int localY = y - section * SECTION_HEIGHT;
+    if (localY == 0 && section > 0) {
+        m_dirtySections |= 1u << (section - 1);
+    } else if (localY == SECTION_HEIGHT - 1 && section < CHUNK_SECTIONS - 1) {
+        m_dirtySections |= 1u << (section + 1);
+    }
 }
 
 // Check if position is valid
@@ -106,170 +120,177 @@ bool Chunk::isValidPosition(int x, int y, int z) const {
     return x >= 0 && x < CHUNK_SIZE && y >= 0 && y < CHUNK_HEIGHT && z >= 0 && z < CHUNK_SIZE;
 }
 
-// Generate mesh
-void Chunk::generateMesh() {
-    // Clear previous mesh
-    m_vertices.clear();
-    m_indices.clear();
+// Get the shared quad index pattern
+const std::vector<uint32_t>& Chunk::getQuadIndices() {
+    static std::vector<uint32_t> indices;
     
-    // Iterate through all blocks
-    for (int y = 0; y < CHUNK_HEIGHT; y++) {
-        for (int z = 0; z < CHUNK_SIZE; z++) {
-            for (int x = 0; x < CHUNK_SIZE; x++) {
-                BlockType type = getBlock(x, y, z);
-                
-                // Skip air blocks
-                if (type == BlockType::Air) {
-                    continue;
-                }
-                
-                // Check each face
-                for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
-                    if (isFaceVisible(x, y, z, static_cast<BlockFace>(face))) {
-                        addFace(type, static_cast<BlockFace>(face), x, y, z);
-                    }
-                }
-            }
+    if (indices.empty()) {
+        indices.resize(static_cast<size_t>(MAX_SECTION_QUADS) * 6);
+        
+        uint32_t* out = indices.data();
+        for (uint32_t quad = 0; quad < static_cast<uint32_t>(MAX_SECTION_QUADS); quad++) {
+            uint32_t base = quad * 4;
+            
+            // Two triangles per quad
+            *out++ = base;
+            *out++ = base + 1;
+            *out++ = base + 2;
+            *out++ = base;
+            *out++ = base + 2;
+            *out++ = base + 3;
         }
     }
     
-    m_dirty = false;
+    return indices;
+}
+
+// Get the shared empty section mesh
+const SectionMesh& Chunk::getEmptyMesh() {
+    static const SectionMesh empty(new std::vector<ChunkVertex>());
+    return empty;
 }
 
-// Add face to mesh
-void Chunk::addFace(BlockType type, BlockFace face, int x, int y, int z) {
-    // Get texture coordinates
-    float u, v;
-    Block::getTextureCoords(type, face, u, v);
+// Mark every section that can see the block dirty
+void Chunk::markBlockDirty(int x, int y, int z) {
+    markSectionDirty(y);
+    
+    // Blocks on the edge are visible from neighboring chunks
+    Chunk* sideNeighbor = nullptr;
+    if (x == 0) {
+        sideNeighbor = getNeighbor(BlockFace::Left);
+    } else if (x == CHUNK_SIZE - 1) {
+        sideNeighbor = getNeighbor(BlockFace::Right);
+    }
+    if (sideNeighbor) {
+        sideNeighbor->markSectionDirty(y);
+    }
+    
+    Chunk* depthNeighbor = nullptr;
+    if (z == 0) {
+        depthNeighbor = getNeighbor(BlockFace::Back);
+    } else if (z == CHUNK_SIZE - 1) {
+        depthNeighbor = getNeighbor(BlockFace::Front);
+    }
+    if (depthNeighbor) {
+        depthNeighbor->markSectionDirty(y);
+    }
     
-    // Get face normal
-    const float* normal = FACE_NORMALS[static_cast<int>(face)];
+    // Corner blocks shade the diagonal chunk's corner ambient occlusion too
+    if ((x == 0 || x == CHUNK_SIZE - 1) && (z == 0 || z == CHUNK_SIZE - 1)) {
+        BlockFace sideFace = x == 0 ? BlockFace::Left : BlockFace::Right;
+        BlockFace depthFace = z == 0 ? BlockFace::Back : BlockFace::Front;
+        Chunk* diagonal = sideNeighbor ? sideNeighbor->getNeighbor(depthFace) : (depthNeighbor ? depthNeighbor->getNeighbor(sideFace) : nullptr);
+        if (diagonal) {
+            diagonal->markSectionDirty(y);
+        }
+    }
+}
+
+// Add chunk to its dirty queue if not already queued
+void Chunk::enqueueDirty() {
+    if (m_dirtyQueue && !m_queued) {
+        m_queued = true;
+        m_dirtyQueue->push_back(this);
+    }
+}
+
+// Metrics reported by meshing
+static MetricCounter& s_chunksMeshed = Metrics::counter("tomicz_chunks_meshed_total", "Chunk mesh rebuilds");
+static MetricCounter& s_sectionsMeshed = Metrics::counter("tomicz_sections_meshed_total", "Chunk section meshes rebuilt");
+static MetricCounter& s_verticesMeshed = Metrics::counter("tomicz_mesh_vertices_total", "Vertices produced by meshing");
+static MetricHistogram& s_meshSeconds = Metrics::histogram("tomicz_chunk_mesh_seconds",
+    "Time to rebuild the dirty sections of a chunk", Metrics::exponentialBuckets(0.0001, 2.0, 12));
+
+// Regenerate the meshes of dirty sections
+uint32_t Chunk::generateMesh() {
+    PROFILE_ZONE("Chunk::generateMesh");
     
-    // Get face vertices
-    const float (*vertices)[3] = FACE_VERTICES[static_cast<int>(face)];
+    // Meshing scratch space is reused per thread
+    static thread_local ChunkMesher mesher;
     
-    // Add vertices
-    uint32_t indexOffset = static_cast<uint32_t>(m_vertices.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     
-    for (int i = 0; i < 4; i++) {
-        ChunkVertex vertex;
-        
-        // Position
-        vertex.position[0] = vertices[i][0] + static_cast<float>(x);
-        vertex.position[1] = vertices[i][1] + static_cast<float>(y);
-        vertex.position[2] = vertices[i][2] + static_cast<float>(z);
-        
-        // Texture coordinates
-        vertex.texCoord[0] = FACE_TEX_COORDS[i][0] * 0.25f + u;
-        vertex.texCoord[1] = FACE_TEX_COORDS[i][1] * 0.25f + v;
-        
-        // Normal
-        vertex.normal[0] = normal[0];
-        vertex.normal[1] = normal[1];
-        vertex.normal[2] = normal[2];
-        
-        // Color (white)
-        vertex.color[0] = 1.0f;
-        vertex.color[1] = 1.0f;
-        vertex.color[2] = 1.0f;
-        vertex.color[3] = 1.0f;
-        
-        m_vertices.push_back(vertex);
+    uint32_t rebuilt = m_dirtySections;
+    uint64_t sections = 0;
+    uint64_t vertices = 0;
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        if (rebuilt & (1u << section)) {
+            m_sectionMeshes[section] = mesher.generate(*this, section);
+            sections++;
+            vertices += m_sectionMeshes[section]->size();
+        }
     }
     
-    // Add indices (two triangles per face)
-    m_indices.push_back(indexOffset);
-    m_indices.push_back(indexOffset + 1);
-    m_indices.push_back(indexOffset + 2);
+    m_dirtySections = 0;
     
-    m_indices.push_back(indexOffset);
-    m_indices.push_back(indexOffset + 2);
-    m_indices.push_back(indexOffset + 3);
+    s_meshSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    s_chunksMeshed.add();
+    s_sectionsMeshed.add(sections);
+    s_verticesMeshed.add(vertices);
+    return rebuilt;
 }
 
-// Check if face is visible
-bool Chunk::isFaceVisible(int x, int y, int z, BlockFace face) const {
-    // Get adjacent block position
-    int nx = x, ny = y, nz = z;
+// Generate terrain
+void Chunk::generateTerrain() {
+    PROFILE_ZONE("Chunk::generateTerrain");
+    
+    // Surface heights from the shared generator, so world maps match the chunks
+    TerrainGenerator generator;
+    int heights[CHUNK_SIZE * CHUNK_SIZE];
+    generator.getChunkHeights(m_position.x, m_position.z, heights);
     
-    switch (face) {
-        case BlockFace::Front:  nz++; break;
-        case BlockFace::Back:   nz--; break;
-        case BlockFace::Left:   nx--; break;
-        case BlockFace::Right:  nx++; break;
-        case BlockFace::Top:    ny++; break;
-        case BlockFace::Bottom: ny--; break;
-        default: break;
+    // Fill blocks, then share the sections other chunks have too
+    std::vector<BlockType> blocks(CHUNK_VOLUME);
+    BlockType* out = blocks.data();
+    for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        for (int column = 0; column < CHUNK_SIZE * CHUNK_SIZE; column++) {
+            *out++ = TerrainGenerator::getBlockType(y, heights[column]);
+        }
     }
+    setBlocks(blocks.data());
     
-    // Get adjacent block
-    BlockType adjacentBlock = getBlockWorld(nx, ny, nz);
+    // Generated terrain is not an edit, later edits are told apart from those of earlier loads
+    m_editCount = 0;
+    m_generation = ++s_generationCount;
     
-    // Face is visible if adjacent block is air or transparent
-    return adjacentBlock == BlockType::Air || Block::isTransparent(adjacentBlock);
+    setDirty(true);
 }
 
-// Get block at position (including from neighboring chunks)
-BlockType Chunk::getBlockWorld(int x, int y, int z) const {
-    // Check if y is out of bounds
-    if (y < 0 || y >= CHUNK_HEIGHT) {
-        return BlockType::Air;
-    }
+// Restore blocks and light saved from a generated chunk
+void Chunk::restoreTerrain(const BlockType* blocks, const uint8_t* light) {
+    setBlocks(blocks);
+    std::copy(light, light + CHUNK_VOLUME, m_light.begin());
     
-    // Check if block is in this chunk
-    if (x >= 0 && x < CHUNK_SIZE && z >= 0 && z < CHUNK_SIZE) {
-        return getBlock(x, y, z);
-    }
+    // Counts as a new generation, like generateTerrain
+    m_editCount = 0;
+    m_generation = ++s_generationCount;
     
-    // Block is in a neighboring chunk
-    // In a real implementation, we would get the block from the neighboring chunk
-    // For now, just return air
-    return BlockType::Air;
+    setDirty(true);
 }
 
-// Generate terrain
-void Chunk::generateTerrain() {
-    // Create noise generator
-    FastNoise noise;
-    noise.SetNoiseType(FastNoise::SimplexFractal);
-    noise.SetSeed(12345);
-    noise.SetFrequency(0.01f);
-    noise.SetFractalOctaves(4);
-    
-    // Generate terrain
-    for (int z = 0; z < CHUNK_SIZE; z++) {
-        for (int x = 0; x < CHUNK_SIZE; x++) {
-            // Calculate world coordinates
-            float worldX = static_cast<float>(x + m_position.x * CHUNK_SIZE);
-            float worldZ = static_cast<float>(z + m_position.z * CHUNK_SIZE);
-            
-            // Generate height using noise
-            float heightValue = noise.GetNoise(worldX, worldZ);
-            int height = static_cast<int>((heightValue + 1.0f) * 32.0f + 64.0f);
-            height = std::min(height, CHUNK_HEIGHT - 1);
-            
-            // Fill blocks
-            for (int y = 0; y < CHUNK_HEIGHT; y++) {
-                BlockType type;
-                
-                if (y > height) {
-                    // Air above ground
-                    type = BlockType::Air;
-                } else if (y == height) {
-                    // Grass on top
-                    type = BlockType::Grass;
-                } else if (y > height - 4) {
-                    // Dirt below grass
-                    type = BlockType::Dirt;
-                } else {
-                    // Stone below dirt
-                    type = BlockType::Stone;
-                }
-                
-                setBlock(x, y, z, type);
-            }
+// Copy all blocks
+void Chunk::copyBlocks(BlockType* blocks) const {
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        std::copy(m_sectionBlocks[section], m_sectionBlocks[section] + SECTION_VOLUME, blocks + section * SECTION_VOLUME);
+    }
+}
+
+// Replace all blocks with interned sections
+void Chunk::setBlocks(const BlockType* blocks) {
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        const BlockType* first = blocks + section * SECTION_VOLUME;
+        if (m_sharedSections[section]) {
+            SectionPool::release(m_sharedSections[section]);
         }
+        m_sharedSections[section] = SectionPool::intern(first);
+        m_ownedSections[section].reset();
+        m_sectionBlocks[section] = m_sharedSections[section]->data();
+        m_sectionBlockCounts[section] = static_cast<uint16_t>(SECTION_VOLUME - std::count(first, first + SECTION_VOLUME, BlockType::Air));
     }
-    
-    m_dirty = true;
-} 
\ No newline at end of file
+}
+
+// Restore a section mesh saved from a meshed chunk
+void Chunk::restoreSectionMesh(int section, const SectionMesh& mesh) {
+    m_sectionMeshes[section] = mesh;
+    m_dirtySections &= ~(1u << section);
+}
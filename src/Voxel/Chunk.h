@@ -2,6 +2,7 @@
 
 #include "Block.h"
 #include <array>
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -10,6 +11,18 @@ constexpr int CHUNK_SIZE = 16;
 constexpr int CHUNK_HEIGHT = 256;
 constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_HEIGHT * CHUNK_SIZE;
 
+// Chunks are meshed in vertical sections so edits only rebuild what they touch
+constexpr int SECTION_HEIGHT = 16;
+constexpr int CHUNK_SECTIONS = CHUNK_HEIGHT / SECTION_HEIGHT;
+constexpr int SECTION_VOLUME = CHUNK_SIZE * SECTION_HEIGHT * CHUNK_SIZE;
+constexpr uint32_t ALL_SECTIONS = (1u << CHUNK_SECTIONS) - 1;
+
+// Blocks of one chunk section, indexed (y % SECTION_HEIGHT) * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x
+typedef std::array<BlockType, SECTION_VOLUME> SectionBlocks;
+
+// Upper bound on quads a single section mesh can hold (every face of every block, transparent blocks face each other)
+constexpr int MAX_SECTION_QUADS = SECTION_VOLUME * static_cast<int>(BlockFace::Count);
+
 // Chunk position
 struct ChunkPosition {
     int x;
@@ -34,6 +47,9 @@ struct ChunkVertex {
     float color[4];
 };
 
+// Immutable section mesh, shared between chunks and the mesh cache
+typedef std::shared_ptr<const std::vector<ChunkVertex>> SectionMesh;
+
 // Chunk class
 class Chunk {
 public:
@@ -46,50 +62,153 @@ public:
     // Set block at position
     void setBlock(int x, int y, int z, BlockType type);
     
+    // Get block at position without bounds checking (hot paths only)
+    BlockType getBlockUnchecked(int x, int y, int z) const {
+        uint32_t index = static_cast<uint32_t>(y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x);
+        return m_sectionBlocks[index / SECTION_VOLUME][index % SECTION_VOLUME];
+    }
+    
+    // Get packed light at position without bounds checking (sky light << 4 | block light)
+    uint8_t getLightUnchecked(int x, int y, int z) const {
+        return m_light[y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x];
+    }
+    
+    // Get sky light level (0-15)
+    uint8_t getSkyLight(int x, int y, int z) const { return getLightUnchecked(x, y, z) >> 4; }
+    
+    // Get block light level (0-15)
+    uint8_t getBlockLight(int x, int y, int z) const { return getLightUnchecked(x, y, z) & 0x0F; }
+    
+    // Set sky light level (0-15)
+    void setSkyLight(int x, int y, int z, uint8_t level) {
+        uint8_t& light = m_light[y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x];
+        light = static_cast<uint8_t>((light & 0x0F) | (level << 4));
+    }
+    
+    // Set block light level (0-15)
+    void setBlockLight(int x, int y, int z, uint8_t level) {
+        uint8_t& light = m_light[y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x];
+        light = static_cast<uint8_t>((light & 0xF0) | level);
+    }
+    
+    // Get neighboring chunk in a horizontal direction (Front, Back, Left or Right), null if not loaded
+    Chunk* getNeighbor(BlockFace face) const { return m_neighbors[static_cast<int>(face)]; }
+    
+    // Set neighboring chunk in a horizontal direction
+    void setNeighbor(BlockFace face, Chunk* neighbor) { m_neighbors[static_cast<int>(face)] = neighbor; }
+    
     // Check if position is valid
     bool isValidPosition(int x, int y, int z) const;
     
     // Get chunk position
     const ChunkPosition& getPosition() const { return m_position; }
     
-    // Generate mesh
-    void generateMesh();
+    // Regenerate the meshes of dirty sections, returns the mask of rebuilt sections
+    uint32_t generateMesh();
+    
+    // Get section mesh vertices
+    const std::vector<ChunkVertex>& getSectionVertices(int section) const { return *m_sectionMeshes[section]; }
+    
+    // Get section mesh (never null, unmeshed sections share an empty one)
+    const SectionMesh& getSectionMesh(int section) const { return m_sectionMeshes[section]; }
+    
+    // Get number of quads in a section mesh (4 vertices each)
+    uint32_t getQuadCount(int section) const { return static_cast<uint32_t>(m_sectionMeshes[section]->size() / 4); }
     
-    // Get mesh vertices
-    const std::vector<ChunkVertex>& getVertices() const { return m_vertices; }
+    // Get the shared empty section mesh
+    static const SectionMesh& getEmptyMesh();
     
-    // Get mesh indices
-    const std::vector<uint32_t>& getIndices() const { return m_indices; }
+    // Get the shared quad index pattern (0,1,2, 0,2,3 per quad) for MAX_SECTION_QUADS quads
+    static const std::vector<uint32_t>& getQuadIndices();
+    
+    // Get number of non-air blocks in a section
+    uint16_t getSectionBlockCount(int section) const { return m_sectionBlockCounts[section]; }
     
     // Check if mesh is dirty (needs to be regenerated)
-    bool isDirty() const { return m_dirty; }
+    bool isDirty() const { return m_dirtySections != 0; }
+    
+    // Set mesh dirty flag for all sections
+    void setDirty(bool dirty);
+    
+    // Mark the section containing y dirty, plus the section sharing its border
+    void markSectionDirty(int y);
+    
+    // Mark every section that can see the block dirty, including neighboring chunks on the edge
+    void markBlockDirty(int x, int y, int z);
+    
+    // Get mask of sections whose mesh is dirty
+    uint32_t getDirtySections() const { return m_dirtySections; }
     
-    // Set mesh dirty flag
-    void setDirty(bool dirty) { m_dirty = dirty; }
+    // Get edit version, 0 while unedited since terrain generation and unique across reloads after
+    uint64_t getEditVersion() const {
+        return m_editCount == 0 ? 0 : (static_cast<uint64_t>(m_generation) << 32) | m_editCount;
+    }
+    
+    // Set the queue this chunk adds itself to when it becomes dirty
+    void setDirtyQueue(std::vector<Chunk*>* queue) { m_dirtyQueue = queue; }
+    
+    // Check if chunk is in its dirty queue
+    bool isQueued() const { return m_queued; }
+    
+    // Mark chunk as taken out of its dirty queue
+    void clearQueued() { m_queued = false; }
     
     // Generate terrain
     void generateTerrain();
     
+    // Get the blocks of a section (SECTION_VOLUME of them)
+    const BlockType* getSectionBlocks(int section) const { return m_sectionBlocks[section]; }
+    
+    // Copy all blocks into blocks (CHUNK_VOLUME of them)
+    void copyBlocks(BlockType* blocks) const;
+    
+    // Get light data, indexed y * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + x
+    const uint8_t* getLightData() const { return m_light.data(); }
+    
+    // Restore blocks and light saved from a generated chunk, as if it had just been generated and lit
+    void restoreTerrain(const BlockType* blocks, const uint8_t* light);
+    
+    // Restore a section mesh saved from a meshed chunk, clearing its dirty bit
+    void restoreSectionMesh(int section, const SectionMesh& mesh);
+    
 private:
     // Chunk position
     ChunkPosition m_position;
     
-    // Blocks data
-    std::array<BlockType, CHUNK_VOLUME> m_blocks;
+    // Blocks per section: interned sections are shared with other chunks and
+    // never written, the first edit of a section copies it into an owned one
+    const SectionBlocks* m_sharedSections[CHUNK_SECTIONS];
+    std::unique_ptr<SectionBlocks> m_ownedSections[CHUNK_SECTIONS];
+    
+    // Blocks of each section, shared or owned
+    const BlockType* m_sectionBlocks[CHUNK_SECTIONS];
+    
+    // Light data (sky light in the high nibble, block light in the low nibble)
+    std::array<uint8_t, CHUNK_VOLUME> m_light;
+    
+    // Non-air blocks per section
+    uint16_t m_sectionBlockCounts[CHUNK_SECTIONS];
+    
+    // Neighboring chunks, indexed by horizontal BlockFace
+    Chunk* m_neighbors[4];
+    
+    // Mesh data per section (indexed with the shared quad index pattern)
+    SectionMesh m_sectionMeshes[CHUNK_SECTIONS];
     
-    // Mesh data
-    std::vector<ChunkVertex> m_vertices;
-    std::vector<uint32_t> m_indices;
+    // Dirty sections (bit per section)
+    uint32_t m_dirtySections;
     
-    // Dirty flag
-    bool m_dirty;
+    // Block changes since terrain generation, and the generation they apply to
+    uint32_t m_editCount;
+    uint32_t m_generation;
     
-    // Add face to mesh
-    void addFace(BlockType type, BlockFace face, int x, int y, int z);
+    // Intrusive dirty queue membership
+    std::vector<Chunk*>* m_dirtyQueue;
+    bool m_queued;
     
-    // Check if face is visible
-    bool isFaceVisible(int x, int y, int z, BlockFace face) const;
+    // Add chunk to its dirty queue if not already queued
+    void enqueueDirty();
     
-    // Get block at position (including from neighboring chunks)
-    BlockType getBlockWorld(int x, int y, int z) const;
+    // Replace all blocks with interned sections and recount them
+    void setBlocks(const BlockType* blocks);
 }; 
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "ChunkCuller.h"
+#include <algorithm>
+#include <cmath>
+
+// Extract planes from a view-projection matrix
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+    // Rows of the matrix (glm is column-major)
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0]; // Left
+    frustum.planes[1] = rows[3] - rows[0]; // Right
+    frustum.planes[2] = rows[3] + rows[1]; // Bottom
+    frustum.planes[3] = rows[3] - rows[1]; // Top
+    frustum.planes[4] = rows[3] + rows[2]; // Near
+    frustum.planes[5] = rows[3] - rows[2]; // Far
+    return frustum;
+}
+
+// Check if an axis-aligned box is at least partly inside
+bool Frustum::intersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4& plane = planes[i];
+
+        // Corner furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x,
+                         plane.y >= 0.0f ? max.y : min.y,
+                         plane.z >= 0.0f ? max.z : min.z);
+
+        if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Collect meshed chunk sections inside the frustum
+void ChunkCuller::cull(const World& world, const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<ChunkDraw>& draws) {
+    draws.clear();
+
+    for (const auto& pair : world.getChunks()) {
+        Chunk* chunk = pair.second;
+
+        // Sections with a mesh
+        uint32_t meshed = 0;
+        for (int section = 0; section < CHUNK_SECTIONS; section++) {
+            if (chunk->getQuadCount(section) > 0) {
+                meshed |= 1u << section;
+            }
+        }
+        if (meshed == 0) {
+            continue;
+        }
+
+        // Bounds of the meshed part of the column
+        glm::vec3 min(pair.first.x * CHUNK_SIZE, 0.0f, pair.first.z * CHUNK_SIZE);
+        glm::vec3 max = min + glm::vec3(CHUNK_SIZE, 0.0f, CHUNK_SIZE);
+        min.y = static_cast<float>(__builtin_ctz(meshed) * SECTION_HEIGHT);
+        max.y = static_cast<float>((32 - __builtin_clz(meshed)) * SECTION_HEIGHT);
+
+        if (!frustum.intersectsBox(min, max)) {
+            continue;
+        }
+
+        // Then each section of the column
+        uint32_t visible = 0;
+        for (uint32_t bits = meshed; bits != 0; bits &= bits - 1) {
+            int section = __builtin_ctz(bits);
+            glm::vec3 sectionMin(min.x, static_cast<float>(section * SECTION_HEIGHT), min.z);
+            glm::vec3 sectionMax(max.x, static_cast<float>((section + 1) * SECTION_HEIGHT), max.z);
+
+            if (frustum.intersectsBox(sectionMin, sectionMax)) {
+                visible |= 1u << section;
+            }
+        }
+
+        if (visible != 0) {
+            float dx = min.x + CHUNK_SIZE * 0.5f - cameraPosition.x;
+            float dz = min.z + CHUNK_SIZE * 0.5f - cameraPosition.z;
+
+            ChunkDraw draw;
+            draw.position = pair.first;
+            draw.sections = visible;
+            draw.distance = dx * dx + dz * dz;
+            draws.push_back(draw);
+        }
+    }
+}
+
+// Count chunk columns in range that are inside the frustum but not loaded
+uint32_t ChunkCuller::countMissing(const World& world, const Frustum& frustum, const glm::vec3& cameraPosition, int renderDistance) {
+    int cameraChunkX = static_cast<int>(std::floor(cameraPosition.x / CHUNK_SIZE));
+    int cameraChunkZ = static_cast<int>(std::floor(cameraPosition.z / CHUNK_SIZE));
+    const auto& chunks = world.getChunks();
+
+    uint32_t missing = 0;
+    for (int z = cameraChunkZ - renderDistance; z <= cameraChunkZ + renderDistance; z++) {
+        for (int x = cameraChunkX - renderDistance; x <= cameraChunkX + renderDistance; x++) {
+            if (chunks.find({x, z}) != chunks.end()) {
+                continue;
+            }
+
+            glm::vec3 min(x * CHUNK_SIZE, 0.0f, z * CHUNK_SIZE);
+            glm::vec3 max(min.x + CHUNK_SIZE, static_cast<float>(CHUNK_HEIGHT), min.z + CHUNK_SIZE);
+            if (frustum.intersectsBox(min, max)) {
+                missing++;
+            }
+        }
+    }
+
+    return missing;
+}
+
+// Order draws front to back
+void ChunkCuller::sortFrontToBack(std::vector<ChunkDraw>& draws) {
+    std::sort(draws.begin(), draws.end(), [](const ChunkDraw& a, const ChunkDraw& b) {
+        return a.distance < b.distance;
+    });
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "World.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// View frustum
+struct Frustum {
+    // Planes (xyz = inward normal, w = distance), a point p is inside when dot(xyz, p) + w >= 0 for all planes
+    glm::vec4 planes[6];
+
+    // Extract planes from a view-projection matrix
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+    // Check if an axis-aligned box is at least partly inside
+    bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+};
+
+// Chunk sections to draw, by position so the list stays valid while the world changes
+struct ChunkDraw {
+    ChunkPosition position;
+    uint32_t sections;      // Bit per visible section with a mesh
+    float distance;         // Squared horizontal distance from the camera to the chunk center
+};
+
+// Chunk culler class
+//
+// Builds the list of chunk sections to draw: frustum culling per chunk column
+// first, then per section of the columns that pass, skipping empty meshes.
+class ChunkCuller {
+public:
+    // Collect meshed chunk sections inside the frustum
+    static void cull(const World& world, const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<ChunkDraw>& draws);
+
+    // Count chunk columns within renderDistance of the camera that are inside the frustum but not loaded (holes)
+    static uint32_t countMissing(const World& world, const Frustum& frustum, const glm::vec3& cameraPosition, int renderDistance);
+
+    // Order draws front to back (less overdraw for opaque geometry)
+    static void sortFrontToBack(std::vector<ChunkDraw>& draws);
+};
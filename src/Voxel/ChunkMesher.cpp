@@ -0,0 +1,554 @@
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// Face normals
+static const float FACE_NORMALS[6][3] = {
+    { 0.0f,  0.0f,  1.0f}, // Front
+    { 0.0f,  0.0f, -1.0f}, // Back
+    {-1.0f,  0.0f,  0.0f}, // Left
+    { 1.0f,  0.0f,  0.0f}, // Right
+    { 0.0f,  1.0f,  0.0f}, // Top
+    { 0.0f, -1.0f,  0.0f}  // Bottom
+};
+
+// Face vertices (positions relative to block origin)
+static const float FACE_VERTICES[6][4][3] = {
+    // Front face (z+)
+    {
+        {0.0f, 0.0f, 1.0f}, // Bottom-left
+        {1.0f, 0.0f, 1.0f}, // Bottom-right
+        {1.0f, 1.0f, 1.0f}, // Top-right
+        {0.0f, 1.0f, 1.0f}  // Top-left
+    },
+    // Back face (z-)
+    {
+        {1.0f, 0.0f, 0.0f}, // Bottom-left
+        {0.0f, 0.0f, 0.0f}, // Bottom-right
+        {0.0f, 1.0f, 0.0f}, // Top-right
+        {1.0f, 1.0f, 0.0f}  // Top-left
+    },
+    // Left face (x-)
+    {
+        {0.0f, 0.0f, 0.0f}, // Bottom-left
+        {0.0f, 0.0f, 1.0f}, // Bottom-right
+        {0.0f, 1.0f, 1.0f}, // Top-right
+        {0.0f, 1.0f, 0.0f}  // Top-left
+    },
+    // Right face (x+)
+    {
+        {1.0f, 0.0f, 1.0f}, // Bottom-left
+        {1.0f, 0.0f, 0.0f}, // Bottom-right
+        {1.0f, 1.0f, 0.0f}, // Top-right
+        {1.0f, 1.0f, 1.0f}  // Top-left
+    },
+    // Top face (y+)
+    {
+        {0.0f, 1.0f, 1.0f}, // Bottom-left
+        {1.0f, 1.0f, 1.0f}, // Bottom-right
+        {1.0f, 1.0f, 0.0f}, // Top-right
+        {0.0f, 1.0f, 0.0f}  // Top-left
+    },
+    // Bottom face (y-)
+    {
+        {0.0f, 0.0f, 0.0f}, // Bottom-left
+        {1.0f, 0.0f, 0.0f}, // Bottom-right
+        {1.0f, 0.0f, 1.0f}, // Top-right
+        {0.0f, 0.0f, 1.0f}  // Top-left
+    }
+};
+
+// Face texture coordinates
+static const float FACE_TEX_COORDS[4][2] = {
+    {0.0f, 1.0f}, // Bottom-left
+    {1.0f, 1.0f}, // Bottom-right
+    {1.0f, 0.0f}, // Top-right
+    {0.0f, 0.0f}  // Top-left
+};
+
+// Block offsets per face
+static const int FACE_OFFSETS[6][3] = {
+    { 0,  0,  1}, // Front
+    { 0,  0, -1}, // Back
+    {-1,  0,  0}, // Left
+    { 1,  0,  0}, // Right
+    { 0,  1,  0}, // Top
+    { 0, -1,  0}  // Bottom
+};
+
+// Packed light of open sky (sky light 15, block light 0)
+static const uint8_t FULL_SKY_LIGHT = 0xF0;
+
+// Brightness of a face in complete darkness
+static const float MIN_BRIGHTNESS = 0.05f;
+
+// Brightness of a vertex by number of open neighbors around its corner (0-3)
+static const float AO_BRIGHTNESS[4] = {0.5f, 0.7f, 0.85f, 1.0f};
+
+// Ambient occlusion toggle shared by all meshers
+static std::atomic<bool> s_ambientOcclusion(true);
+
+// Mesh cache shared by all meshers
+static std::atomic<MeshCache*> s_cache(nullptr);
+
+// Per-block-type and per-face lookup tables, built once from Block properties and face geometry
+struct MeshTables {
+    bool opaque[static_cast<int>(BlockType::Count)];
+    float textureCoords[static_cast<int>(BlockType::Count)][static_cast<int>(BlockFace::Count)][2];
+    float brightness[16];
+    
+    // Blocks sampled for each face vertex: side 1, side 2 and the corner between them,
+    // as offsets from the block the face looks into
+    int aoOffsets[static_cast<int>(BlockFace::Count)][4][3][3];
+    
+    MeshTables() {
+        // Side directions point from the face center towards each vertex
+        for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
+            for (int vertex = 0; vertex < 4; vertex++) {
+                int side1[3] = {0, 0, 0};
+                int side2[3] = {0, 0, 0};
+                int* side = side1;
+                
+                for (int axis = 0; axis < 3; axis++) {
+                    if (FACE_OFFSETS[face][axis] != 0) {
+                        continue;
+                    }
+                    side[axis] = FACE_VERTICES[face][vertex][axis] > 0.5f ? 1 : -1;
+                    side = side2;
+                }
+                
+                for (int axis = 0; axis < 3; axis++) {
+                    aoOffsets[face][vertex][0][axis] = side1[axis];
+                    aoOffsets[face][vertex][1][axis] = side2[axis];
+                    aoOffsets[face][vertex][2][axis] = side1[axis] + side2[axis];
+                }
+            }
+        }
+        
+        // Each light level step is 80% as bright as the one above it
+        for (int level = 0; level < 16; level++) {
+            brightness[level] = std::max(MIN_BRIGHTNESS, std::pow(0.8f, static_cast<float>(15 - level)));
+        }
+        
+        for (int type = 0; type < static_cast<int>(BlockType::Count); type++) {
+            opaque[type] = !Block::isTransparent(static_cast<BlockType>(type));
+            
+            for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
+                Block::getTextureCoords(static_cast<BlockType>(type), static_cast<BlockFace>(face),
+                                        textureCoords[type][face][0], textureCoords[type][face][1]);
+            }
+        }
+    }
+};
+
+static const MeshTables& getMeshTables() {
+    static const MeshTables tables;
+    return tables;
+}
+
+// Number of set bits in a row mask
+static inline int countBits(uint32_t bits) {
+    return __builtin_popcount(bits);
+}
+
+// Index of the lowest set bit in a non-zero row mask
+static inline int lowestBit(uint32_t bits) {
+    return __builtin_ctz(bits);
+}
+
+// Constructor
+ChunkMesher::ChunkMesher() {
+}
+
+// Enable or disable ambient occlusion for all meshers
+void ChunkMesher::setAmbientOcclusion(bool enabled) {
+    s_ambientOcclusion = enabled;
+}
+
+// Check if ambient occlusion is enabled
+bool ChunkMesher::isAmbientOcclusionEnabled() {
+    return s_ambientOcclusion;
+}
+
+// Set the mesh cache used by all meshers
+void ChunkMesher::setCache(MeshCache* cache) {
+    s_cache = cache;
+}
+
+// Get the mesh cache used by all meshers
+MeshCache* ChunkMesher::getCache() {
+    return s_cache;
+}
+
+// Generate the mesh of one chunk section
+SectionMesh ChunkMesher::generate(const Chunk& chunk, int section) {
+    int baseY = section * SECTION_HEIGHT;
+    bool ambientOcclusion = s_ambientOcclusion;
+    
+    buildMasks(chunk, baseY);
+    
+    // Sections without visible faces (all air, or buried) share the empty mesh and never reach the cache
+    size_t faceCount = buildFaces();
+    if (faceCount == 0) {
+        return Chunk::getEmptyMesh();
+    }
+    
+    // Sections with the same blocks and padded surroundings get the same mesh
+    MeshCache* cache = s_cache;
+    MeshCacheKey key;
+    if (cache) {
+        key = computeKey(chunk, section, ambientOcclusion);
+        SectionMesh cached = cache->find(key);
+        if (cached) {
+            return cached;
+        }
+    }
+    
+    uint8_t ao[4] = {3, 3, 3, 3};
+    
+    // Size output once and write quads through a raw pointer
+    std::vector<ChunkVertex>* vertices = new std::vector<ChunkVertex>(faceCount * 4);
+    SectionMesh mesh(vertices);
+    ChunkVertex* out = vertices->data();
+    
+    for (int y = 0; y < SECTION_HEIGHT; y++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            if (m_filled[y][z] == 0) {
+                continue;
+            }
+            
+            for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
+                uint32_t bits = m_faces[face][y][z];
+                
+                while (bits != 0) {
+                    int x = lowestBit(bits);
+                    bits &= bits - 1;
+                    
+                    // Faces are lit by the block they look into
+                    uint8_t light = m_light[y + 1 + FACE_OFFSETS[face][1]][z + 1 + FACE_OFFSETS[face][2]][x + 1 + FACE_OFFSETS[face][0]];
+                    
+                    if (ambientOcclusion) {
+                        computeAO(face, x, y, z, ao);
+                    }
+                    
+                    out = writeFace(out, chunk.getBlockUnchecked(x, baseY + y, z), static_cast<BlockFace>(face),
+                                    x, baseY + y, z, light, ao);
+                }
+            }
+        }
+    }
+    
+    // The cache shares the mesh with the chunk instead of copying it
+    if (cache) {
+        cache->add(key, mesh);
+    }
+    return mesh;
+}
+
+// Packed face layout: x 4 bits, y 8, z 4, face 3, block type 5, light level 4, ambient occlusion 2 per vertex
+static const int PACKED_Y_SHIFT = 4;
+static const int PACKED_Z_SHIFT = 12;
+static const int PACKED_FACE_SHIFT = 16;
+static const int PACKED_TYPE_SHIFT = 19;
+static const int PACKED_LEVEL_SHIFT = 24;
+static const int PACKED_AO_SHIFT = 28;
+static_assert(static_cast<int>(BlockType::Count) <= 32, "block types are packed in 5 bits");
+
+// Pack the four vertices of a face
+bool ChunkMesher::packFace(const ChunkVertex* vertices, uint64_t& packed) {
+    const MeshTables& tables = getMeshTables();
+    
+    // The normal gives the face and the brightness the light level
+    int face = 0;
+    while (face < static_cast<int>(BlockFace::Count) &&
+           (vertices[0].normal[0] != FACE_NORMALS[face][0] || vertices[0].normal[1] != FACE_NORMALS[face][1] ||
+            vertices[0].normal[2] != FACE_NORMALS[face][2])) {
+        face++;
+    }
+    int level = 0;
+    while (level < 16 && vertices[0].color[0] != tables.brightness[level]) {
+        level++;
+    }
+    if (face == static_cast<int>(BlockFace::Count) || level == 16) {
+        return false;
+    }
+    
+    // The first vertex is corner 0 or 1, depending on the diagonal the quad was split along
+    for (int first = 0; first < 2; first++) {
+        float blockX = vertices[0].position[0] - FACE_VERTICES[face][first][0];
+        float blockY = vertices[0].position[1] - FACE_VERTICES[face][first][1];
+        float blockZ = vertices[0].position[2] - FACE_VERTICES[face][first][2];
+        if (!(blockX >= 0.0f && blockX < CHUNK_SIZE && blockY >= 0.0f && blockY < CHUNK_HEIGHT && blockZ >= 0.0f && blockZ < CHUNK_SIZE)) {
+            continue;
+        }
+        int x = static_cast<int>(blockX), y = static_cast<int>(blockY), z = static_cast<int>(blockZ);
+        
+        // Any block with the same texture on this face writes the same vertices
+        float u = vertices[0].texCoord[0] - FACE_TEX_COORDS[first][0] * 0.25f;
+        float v = vertices[0].texCoord[1] - FACE_TEX_COORDS[first][1] * 0.25f;
+        int type = 0;
+        while (type < static_cast<int>(BlockType::Count) &&
+               (tables.textureCoords[type][face][0] != u || tables.textureCoords[type][face][1] != v)) {
+            type++;
+        }
+        if (type == static_cast<int>(BlockType::Count)) {
+            continue;
+        }
+        
+        uint8_t ao[4] = {0, 0, 0, 0};
+        for (int n = 0; n < 4; n++) {
+            int i = (first + n) & 3;
+            while (ao[i] < 3 && vertices[n].color[3] != AO_BRIGHTNESS[ao[i]]) {
+                ao[i]++;
+            }
+        }
+        
+        // Only keep the packing if it rebuilds the vertices exactly
+        ChunkVertex rebuilt[4];
+        writeFace(rebuilt, static_cast<BlockType>(type), static_cast<BlockFace>(face), x, y, z, static_cast<uint8_t>(level), ao);
+        if (std::memcmp(rebuilt, vertices, sizeof(rebuilt)) != 0) {
+            continue;
+        }
+        
+        packed = static_cast<uint64_t>(x) | static_cast<uint64_t>(y) << PACKED_Y_SHIFT | static_cast<uint64_t>(z) << PACKED_Z_SHIFT |
+                 static_cast<uint64_t>(face) << PACKED_FACE_SHIFT | static_cast<uint64_t>(type) << PACKED_TYPE_SHIFT |
+                 static_cast<uint64_t>(level) << PACKED_LEVEL_SHIFT;
+        for (int i = 0; i < 4; i++) {
+            packed |= static_cast<uint64_t>(ao[i]) << (PACKED_AO_SHIFT + 2 * i);
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+// Unpack a face into four vertices
+ChunkVertex* ChunkMesher::unpackFace(ChunkVertex* out, uint64_t packed) {
+    int face = static_cast<int>(packed >> PACKED_FACE_SHIFT & 0x7);
+    int type = static_cast<int>(packed >> PACKED_TYPE_SHIFT & 0x1F);
+    if (face >= static_cast<int>(BlockFace::Count) || type >= static_cast<int>(BlockType::Count) || packed >> (PACKED_AO_SHIFT + 8) != 0) {
+        return nullptr;
+    }
+    
+    uint8_t ao[4];
+    for (int i = 0; i < 4; i++) {
+        ao[i] = static_cast<uint8_t>(packed >> (PACKED_AO_SHIFT + 2 * i) & 0x3);
+    }
+    
+    return writeFace(out, static_cast<BlockType>(type), static_cast<BlockFace>(face), static_cast<int>(packed & 0xF),
+                     static_cast<int>(packed >> PACKED_Y_SHIFT & 0xFF), static_cast<int>(packed >> PACKED_Z_SHIFT & 0xF),
+                     static_cast<uint8_t>(packed >> PACKED_LEVEL_SHIFT & 0xF), ao);
+}
+
+// Hash the inputs of the section mesh
+MeshCacheKey ChunkMesher::computeKey(const Chunk& chunk, int section, bool ambientOcclusion) const {
+    // Vertex positions are chunk-local, so the section index matters but the chunk position does not
+    uint64_t seed = static_cast<uint64_t>(VERSION) << 40 | static_cast<uint64_t>(sizeof(ChunkVertex)) << 16 |
+                    static_cast<uint64_t>(section) << 1 | (ambientOcclusion ? 1 : 0);
+    MeshCacheKey key = MeshCache::beginKey(seed);
+    
+    // Block types of the section, then opacity and light padded by the neighboring sections and chunks
+    MeshCache::hashBytes(key, chunk.getSectionBlocks(section), SECTION_VOLUME);
+    MeshCache::hashBytes(key, m_opaque, sizeof(m_opaque));
+    MeshCache::hashBytes(key, m_light, sizeof(m_light));
+    return key;
+}
+
+// Build filled and opacity rows and the light snapshot from block data
+void ChunkMesher::buildMasks(const Chunk& chunk, int baseY) {
+    const MeshTables& tables = getMeshTables();
+    
+    const Chunk* front = chunk.getNeighbor(BlockFace::Front);
+    const Chunk* back = chunk.getNeighbor(BlockFace::Back);
+    const Chunk* left = chunk.getNeighbor(BlockFace::Left);
+    const Chunk* right = chunk.getNeighbor(BlockFace::Right);
+    
+    // Diagonal neighbors only feed ambient occlusion at the corners
+    const Chunk* backLeft = back ? back->getNeighbor(BlockFace::Left) : (left ? left->getNeighbor(BlockFace::Back) : nullptr);
+    const Chunk* backRight = back ? back->getNeighbor(BlockFace::Right) : (right ? right->getNeighbor(BlockFace::Back) : nullptr);
+    const Chunk* frontLeft = front ? front->getNeighbor(BlockFace::Left) : (left ? left->getNeighbor(BlockFace::Front) : nullptr);
+    const Chunk* frontRight = front ? front->getNeighbor(BlockFace::Right) : (right ? right->getNeighbor(BlockFace::Front) : nullptr);
+    
+    // Missing neighbors and the space above the world are air in full sky light
+    std::fill(&m_opaque[0][0], &m_opaque[0][0] + (SECTION_HEIGHT + 2) * (CHUNK_SIZE + 2), 0u);
+    std::fill(&m_light[0][0][0], &m_light[0][0][0] + (SECTION_HEIGHT + 2) * (CHUNK_SIZE + 2) * (CHUNK_SIZE + 2), FULL_SKY_LIGHT);
+    
+    // Rows -1 and SECTION_HEIGHT come from the neighboring sections
+    for (int y = -1; y <= SECTION_HEIGHT; y++) {
+        int chunkY = baseY + y;
+        
+        // Below the world is dark
+        if (chunkY < 0) {
+            std::fill(&m_light[y + 1][0][0], &m_light[y + 1][0][0] + (CHUNK_SIZE + 2) * (CHUNK_SIZE + 2), 0);
+            continue;
+        }
+        if (chunkY >= CHUNK_HEIGHT) {
+            continue;
+        }
+        
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            uint32_t filled = 0;
+            uint32_t opaque = 0;
+            
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                BlockType type = chunk.getBlockUnchecked(x, chunkY, z);
+                filled |= static_cast<uint32_t>(type != BlockType::Air) << x;
+                opaque |= static_cast<uint32_t>(tables.opaque[static_cast<int>(type)]) << x;
+                m_light[y + 1][z + 1][x + 1] = chunk.getLightUnchecked(x, chunkY, z);
+            }
+            
+            if (y >= 0 && y < SECTION_HEIGHT) {
+                m_filled[y][z] = static_cast<uint16_t>(filled);
+            }
+            
+            // Padded row with the edge blocks of the left and right neighbors
+            uint32_t row = opaque << 1;
+            if (left) {
+                row |= static_cast<uint32_t>(tables.opaque[static_cast<int>(left->getBlockUnchecked(CHUNK_SIZE - 1, chunkY, z))]);
+                m_light[y + 1][z + 1][0] = left->getLightUnchecked(CHUNK_SIZE - 1, chunkY, z);
+            }
+            if (right) {
+                row |= static_cast<uint32_t>(tables.opaque[static_cast<int>(right->getBlockUnchecked(0, chunkY, z))]) << (CHUNK_SIZE + 1);
+                m_light[y + 1][z + 1][CHUNK_SIZE + 1] = right->getLightUnchecked(0, chunkY, z);
+            }
+            m_opaque[y + 1][z + 1] = row;
+        }
+        
+        // Edge rows of the back and front neighbors
+        if (back) {
+            uint32_t opaque = 0;
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                opaque |= static_cast<uint32_t>(tables.opaque[static_cast<int>(back->getBlockUnchecked(x, chunkY, CHUNK_SIZE - 1))]) << x;
+                m_light[y + 1][0][x + 1] = back->getLightUnchecked(x, chunkY, CHUNK_SIZE - 1);
+            }
+            m_opaque[y + 1][0] = opaque << 1;
+        }
+        if (front) {
+            uint32_t opaque = 0;
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                opaque |= static_cast<uint32_t>(tables.opaque[static_cast<int>(front->getBlockUnchecked(x, chunkY, 0))]) << x;
+                m_light[y + 1][CHUNK_SIZE + 1][x + 1] = front->getLightUnchecked(x, chunkY, 0);
+            }
+            m_opaque[y + 1][CHUNK_SIZE + 1] = opaque << 1;
+        }
+        
+        // Corner columns
+        if (backLeft) {
+            m_opaque[y + 1][0] |= static_cast<uint32_t>(tables.opaque[static_cast<int>(backLeft->getBlockUnchecked(CHUNK_SIZE - 1, chunkY, CHUNK_SIZE - 1))]);
+        }
+        if (backRight) {
+            m_opaque[y + 1][0] |= static_cast<uint32_t>(tables.opaque[static_cast<int>(backRight->getBlockUnchecked(0, chunkY, CHUNK_SIZE - 1))]) << (CHUNK_SIZE + 1);
+        }
+        if (frontLeft) {
+            m_opaque[y + 1][CHUNK_SIZE + 1] |= static_cast<uint32_t>(tables.opaque[static_cast<int>(frontLeft->getBlockUnchecked(CHUNK_SIZE - 1, chunkY, 0))]);
+        }
+        if (frontRight) {
+            m_opaque[y + 1][CHUNK_SIZE + 1] |= static_cast<uint32_t>(tables.opaque[static_cast<int>(frontRight->getBlockUnchecked(0, chunkY, 0))]) << (CHUNK_SIZE + 1);
+        }
+    }
+}
+
+// Derive visible face rows
+size_t ChunkMesher::buildFaces() {
+    const uint32_t ROW = (1u << CHUNK_SIZE) - 1;
+    size_t faceCount = 0;
+    
+    for (int y = 0; y < SECTION_HEIGHT; y++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            uint32_t filled = m_filled[y][z];
+            uint32_t row = m_opaque[y + 1][z + 1];
+            
+            // A face is visible where the block is not air and its neighbor is not opaque
+            uint32_t front  = filled & ~(m_opaque[y + 1][z + 2] >> 1) & ROW;
+            uint32_t back   = filled & ~(m_opaque[y + 1][z] >> 1) & ROW;
+            uint32_t left   = filled & ~row & ROW;
+            uint32_t right  = filled & ~(row >> 2) & ROW;
+            uint32_t top    = filled & ~(m_opaque[y + 2][z + 1] >> 1) & ROW;
+            uint32_t bottom = filled & ~(m_opaque[y][z + 1] >> 1) & ROW;
+            
+            m_faces[static_cast<int>(BlockFace::Front)][y][z]  = static_cast<uint16_t>(front);
+            m_faces[static_cast<int>(BlockFace::Back)][y][z]   = static_cast<uint16_t>(back);
+            m_faces[static_cast<int>(BlockFace::Left)][y][z]   = static_cast<uint16_t>(left);
+            m_faces[static_cast<int>(BlockFace::Right)][y][z]  = static_cast<uint16_t>(right);
+            m_faces[static_cast<int>(BlockFace::Top)][y][z]    = static_cast<uint16_t>(top);
+            m_faces[static_cast<int>(BlockFace::Bottom)][y][z] = static_cast<uint16_t>(bottom);
+            
+            faceCount += countBits(front) + countBits(back) + countBits(left) +
+                         countBits(right) + countBits(top) + countBits(bottom);
+        }
+    }
+    
+    return faceCount;
+}
+
+// Compute ambient occlusion of the four face vertices
+void ChunkMesher::computeAO(int face, int x, int y, int z, uint8_t ao[4]) const {
+    const MeshTables& tables = getMeshTables();
+    
+    // Block the face looks into, in padded coordinates
+    int px = x + 1 + FACE_OFFSETS[face][0];
+    int py = y + 1 + FACE_OFFSETS[face][1];
+    int pz = z + 1 + FACE_OFFSETS[face][2];
+    
+    for (int vertex = 0; vertex < 4; vertex++) {
+        const int (*offsets)[3] = tables.aoOffsets[face][vertex];
+        
+        int side1 = (m_opaque[py + offsets[0][1]][pz + offsets[0][2]] >> (px + offsets[0][0])) & 1;
+        int side2 = (m_opaque[py + offsets[1][1]][pz + offsets[1][2]] >> (px + offsets[1][0])) & 1;
+        int corner = (m_opaque[py + offsets[2][1]][pz + offsets[2][2]] >> (px + offsets[2][0])) & 1;
+        
+        // Two blocking sides fully occlude the corner
+        ao[vertex] = static_cast<uint8_t>(side1 && side2 ? 0 : 3 - side1 - side2 - corner);
+    }
+}
+
+// Write face vertices
+ChunkVertex* ChunkMesher::writeFace(ChunkVertex* out, BlockType type, BlockFace face, int x, int y, int z,
+                                    uint8_t light, const uint8_t ao[4]) {
+    const MeshTables& tables = getMeshTables();
+    
+    // Brightest of sky and block light
+    float brightness = tables.brightness[std::max(light >> 4, light & 0x0F)];
+    
+    // Get texture coordinates
+    float u = tables.textureCoords[static_cast<int>(type)][static_cast<int>(face)][0];
+    float v = tables.textureCoords[static_cast<int>(type)][static_cast<int>(face)][1];
+    
+    // Get face normal
+    const float* normal = FACE_NORMALS[static_cast<int>(face)];
+    
+    // Get face vertices
+    const float (*vertices)[3] = FACE_VERTICES[static_cast<int>(face)];
+    
+    // Split the quad along the brighter diagonal so occlusion doesn't streak across it
+    int first = ao[0] + ao[2] < ao[1] + ao[3] ? 1 : 0;
+    
+    for (int n = 0; n < 4; n++) {
+        int i = (first + n) & 3;
+        ChunkVertex& vertex = out[n];
+        
+        // Position
+        vertex.position[0] = vertices[i][0] + static_cast<float>(x);
+        vertex.position[1] = vertices[i][1] + static_cast<float>(y);
+        vertex.position[2] = vertices[i][2] + static_cast<float>(z);
+        
+        // Texture coordinates
+        vertex.texCoord[0] = FACE_TEX_COORDS[i][0] * 0.25f + u;
+        vertex.texCoord[1] = FACE_TEX_COORDS[i][1] * 0.25f + v;
+        
+        // Normal
+        vertex.normal[0] = normal[0];
+        vertex.normal[1] = normal[1];
+        vertex.normal[2] = normal[2];
+        
+        // Color (light level, ambient occlusion in alpha)
+        vertex.color[0] = brightness;
+        vertex.color[1] = brightness;
+        vertex.color[2] = brightness;
+        vertex.color[3] = AO_BRIGHTNESS[ao[i]];
+    }
+    
+    return out + 4;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Chunk.h"
+#include "MeshCache.h"
+#include <cstdint>
+#include <vector>
+
+// Chunk mesher class
+//
+// Builds per-row opacity bitmasks (one word per x row of 16 blocks) and derives
+// the visible faces of a whole row with a shift and an AND-NOT per direction,
+// instead of looking up six neighbors for every block. Neighboring chunks are
+// read through the chunk neighbor links, and each face takes the light of the
+// block it looks into. Vertices get classic corner ambient occlusion sampled
+// from the same opacity rows. With a mesh cache set, sections whose padded
+// blocks and light hash to a cached mesh reuse it.
+class ChunkMesher {
+public:
+    // Mesher version, bump whenever the output changes so cached meshes are not reused
+    static const uint32_t VERSION = 1;
+
+    ChunkMesher();
+
+    // Enable or disable ambient occlusion for all meshers (enabled by default)
+    static void setAmbientOcclusion(bool enabled);
+
+    // Check if ambient occlusion is enabled
+    static bool isAmbientOcclusionEnabled();
+
+    // Set the mesh cache used by all meshers (nullptr to mesh every section, not owned)
+    static void setCache(MeshCache* cache);
+
+    // Get the mesh cache used by all meshers
+    static MeshCache* getCache();
+
+    // Generate the mesh of one chunk section (4 vertices per quad, shared quad indices)
+    SectionMesh generate(const Chunk& chunk, int section);
+
+    // Pack the four vertices of a face written by the mesher into 8 bytes, false if they are not such a face
+    //
+    // A packed face holds the block, position, light level and ambient occlusion
+    // the vertices were built from, so unpacking rebuilds them bit for bit.
+    static bool packFace(const ChunkVertex* vertices, uint64_t& packed);
+
+    // Unpack a face into four vertices at out, returns pointer past the quad or nullptr if packed is not a valid face
+    static ChunkVertex* unpackFace(ChunkVertex* out, uint64_t packed);
+
+private:
+    // Opacity rows of the section padded by one block on every side:
+    // bit 0 = x -1, bits 1..16 = x 0..15, bit 17 = x 16
+    uint32_t m_opaque[SECTION_HEIGHT + 2][CHUNK_SIZE + 2];
+
+    // Non-air blocks per row (bit x = block x)
+    uint16_t m_filled[SECTION_HEIGHT][CHUNK_SIZE];
+
+    // Packed light of the section padded by one block on every side [y][z][x]
+    uint8_t m_light[SECTION_HEIGHT + 2][CHUNK_SIZE + 2][CHUNK_SIZE + 2];
+
+    // Visible faces per row, per face direction
+    uint16_t m_faces[static_cast<int>(BlockFace::Count)][SECTION_HEIGHT][CHUNK_SIZE];
+
+    // Build filled and opacity rows and the light snapshot, starting at chunk height baseY
+    void buildMasks(const Chunk& chunk, int baseY);
+
+    // Hash the inputs of the section mesh, after buildMasks
+    MeshCacheKey computeKey(const Chunk& chunk, int section, bool ambientOcclusion) const;
+
+    // Derive visible face rows, returns total face count
+    size_t buildFaces();
+
+    // Compute ambient occlusion (0 = fully occluded, 3 = open) of the four vertices of a face at section position
+    void computeAO(int face, int x, int y, int z, uint8_t ao[4]) const;
+
+    // Write face vertices to out, returns pointer past the written quad
+    static ChunkVertex* writeFace(ChunkVertex* out, BlockType type, BlockFace face, int x, int y, int z,
+                                  uint8_t light, const uint8_t ao[4]);
+};
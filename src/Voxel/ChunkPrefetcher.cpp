@@ -0,0 +1,123 @@
+#include "ChunkPrefetcher.h"
+#include "../Camera.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+constexpr float ChunkPrefetcher::DEFAULT_LOOKAHEAD;
+constexpr float ChunkPrefetcher::DEFAULT_CONE_ANGLE;
+const int ChunkPrefetcher::DEFAULT_BUDGET;
+constexpr float ChunkPrefetcher::MIN_SPEED;
+constexpr float ChunkPrefetcher::VELOCITY_SMOOTHING;
+
+// Constructor
+ChunkPrefetcher::ChunkPrefetcher()
+    : m_lookahead(DEFAULT_LOOKAHEAD),
+      m_coneAngle(DEFAULT_CONE_ANGLE),
+      m_budget(DEFAULT_BUDGET),
+      m_hasSample(false),
+      m_time(0.0),
+      m_position(0.0f),
+      m_front(0.0f),
+      m_velocity(0.0f) {
+}
+
+// Add a camera sample
+void ChunkPrefetcher::update(const Camera& camera, double time) {
+    glm::vec3 position = camera.getPosition();
+    m_front = camera.getFront();
+
+    if (m_hasSample && time > m_time) {
+        glm::vec3 velocity = (position - m_position) / static_cast<float>(time - m_time);
+        velocity.y = 0.0f;
+        m_velocity = glm::mix(m_velocity, velocity, VELOCITY_SMOOTHING);
+    }
+
+    m_hasSample = true;
+    m_time = time;
+    m_position = position;
+}
+
+// Forget the motion history
+void ChunkPrefetcher::reset() {
+    m_hasSample = false;
+    m_velocity = glm::vec3(0.0f);
+}
+
+// Collect chunks to generate ahead of the render distance square
+void ChunkPrefetcher::getPrefetchChunks(int renderDistance, std::vector<ChunkPosition>& chunks) {
+    PROFILE_ZONE("ChunkPrefetcher::getPrefetchChunks");
+
+    chunks.clear();
+    float speed = std::sqrt(m_velocity.x * m_velocity.x + m_velocity.z * m_velocity.z);
+    if (!m_hasSample || m_lookahead <= 0.0f || m_budget <= 0 || speed < MIN_SPEED) {
+        return;
+    }
+
+    int playerChunkX = static_cast<int>(std::floor(m_position.x / CHUNK_SIZE));
+    int playerChunkZ = static_cast<int>(std::floor(m_position.z / CHUNK_SIZE));
+
+    // Cone around the horizontal view direction, or the heading when looking straight up or down
+    glm::vec3 axis(m_front.x, 0.0f, m_front.z);
+    float axisLength = std::sqrt(axis.x * axis.x + axis.z * axis.z);
+    if (axisLength < 1e-3f) {
+        axis = m_velocity;
+        axisLength = speed;
+    }
+    float minCosine = std::cos(glm::radians(std::min(m_coneAngle, 180.0f)));
+
+    // Squares around points on the predicted path, at most half a chunk apart
+    int steps = std::max(static_cast<int>(std::ceil(speed * m_lookahead / (CHUNK_SIZE * 0.5f))), 1);
+    std::unordered_set<ChunkPosition, ChunkPosition::Hash> seen;
+    m_candidates.clear();
+
+    for (int step = 1; step <= steps; step++) {
+        float seconds = m_lookahead * step / steps;
+        glm::vec3 predicted = getPredictedPosition(seconds);
+        int centerX = static_cast<int>(std::floor(predicted.x / CHUNK_SIZE));
+        int centerZ = static_cast<int>(std::floor(predicted.z / CHUNK_SIZE));
+
+        for (int z = centerZ - renderDistance; z <= centerZ + renderDistance; z++) {
+            for (int x = centerX - renderDistance; x <= centerX + renderDistance; x++) {
+                // The world loads the current square itself
+                if (std::abs(x - playerChunkX) <= renderDistance && std::abs(z - playerChunkZ) <= renderDistance) {
+                    continue;
+                }
+
+                ChunkPosition position = {x, z};
+                if (!seen.insert(position).second) {
+                    continue;
+                }
+
+                float dx = (x + 0.5f) * CHUNK_SIZE - m_position.x;
+                float dz = (z + 0.5f) * CHUNK_SIZE - m_position.z;
+                float distance = std::sqrt(dx * dx + dz * dz);
+                if (distance > 1e-3f && (dx * axis.x + dz * axis.z) < minCosine * distance * axisLength) {
+                    continue;
+                }
+
+                m_candidates.push_back(std::make_pair(seconds, position));
+            }
+        }
+    }
+
+    // Soonest first (the first step a chunk showed up in), ties nearest to the path first
+    size_t count = std::min(m_candidates.size(), static_cast<size_t>(m_budget));
+    std::partial_sort(m_candidates.begin(), m_candidates.begin() + count, m_candidates.end(),
+                      [this](const std::pair<float, ChunkPosition>& a, const std::pair<float, ChunkPosition>& b) {
+                          if (a.first != b.first) {
+                              return a.first < b.first;
+                          }
+                          glm::vec3 predicted = getPredictedPosition(a.first);
+                          float ax = (a.second.x + 0.5f) * CHUNK_SIZE - predicted.x;
+                          float az = (a.second.z + 0.5f) * CHUNK_SIZE - predicted.z;
+                          float bx = (b.second.x + 0.5f) * CHUNK_SIZE - predicted.x;
+                          float bz = (b.second.z + 0.5f) * CHUNK_SIZE - predicted.z;
+                          return ax * ax + az * az < bx * bx + bz * bz;
+                      });
+
+    for (size_t i = 0; i < count; i++) {
+        chunks.push_back(m_candidates[i].second);
+    }
+}
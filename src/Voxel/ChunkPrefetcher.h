@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Chunk.h"
+#include <vector>
+#include <glm/glm.hpp>
+
+// Forward declarations
+class Camera;
+
+// Chunk prefetcher class
+//
+// Predicts where the camera is heading so chunks can be generated before
+// they enter the render distance. Camera samples give a smoothed horizontal
+// velocity, and the path is extrapolated over the lookahead time. Chunks are
+// collected from the render-distance squares around points along that path,
+// skipping the current square and any outside a cone around the view
+// direction. They are ordered by when the camera is expected to reach them,
+// and at most the budget is returned per update.
+class ChunkPrefetcher {
+public:
+    // Default seconds of motion to look ahead
+    static constexpr float DEFAULT_LOOKAHEAD = 2.0f;
+
+    // Default half angle (degrees) of the cone around the view direction
+    static constexpr float DEFAULT_CONE_ANGLE = 60.0f;
+
+    // Default chunks requested per update
+    static const int DEFAULT_BUDGET = 32;
+
+    // Slowest horizontal speed (blocks/s) that is extrapolated
+    static constexpr float MIN_SPEED = 2.0f;
+
+    // Weight of the newest velocity sample
+    static constexpr float VELOCITY_SMOOTHING = 0.25f;
+
+    // Constructor
+    ChunkPrefetcher();
+
+    // Set seconds of motion to look ahead (0 disables prefetching)
+    void setLookahead(float seconds) { m_lookahead = seconds; }
+    float getLookahead() const { return m_lookahead; }
+
+    // Set half angle of the cone around the view direction in degrees (180 = all around)
+    void setConeAngle(float degrees) { m_coneAngle = degrees; }
+    float getConeAngle() const { return m_coneAngle; }
+
+    // Set maximum chunks requested per update
+    void setBudget(int chunks) { m_budget = chunks; }
+    int getBudget() const { return m_budget; }
+
+    // Add a camera sample taken at time (seconds)
+    void update(const Camera& camera, double time);
+
+    // Forget the motion history (after a teleport)
+    void reset();
+
+    // Get smoothed velocity (blocks/s, horizontal)
+    const glm::vec3& getVelocity() const { return m_velocity; }
+
+    // Get the position expected after seconds
+    glm::vec3 getPredictedPosition(float seconds) const { return m_position + m_velocity * seconds; }
+
+    // Collect chunks to generate ahead of the renderDistance square around the camera, soonest needed first
+    void getPrefetchChunks(int renderDistance, std::vector<ChunkPosition>& chunks);
+
+private:
+    // Settings
+    float m_lookahead;
+    float m_coneAngle;
+    int m_budget;
+
+    // Last sample
+    bool m_hasSample;
+    double m_time;
+    glm::vec3 m_position;
+    glm::vec3 m_front;
+
+    // Smoothed velocity
+    glm::vec3 m_velocity;
+
+    // Candidates by expected arrival time, reused between updates
+    std::vector<std::pair<float, ChunkPosition>> m_candidates;
+};
@@ -0,0 +1,319 @@
+#include "LightEngine.h"
+#include <algorithm>
+
+// Maximum light level
+static const uint8_t MAX_LIGHT = 15;
+
+// Block offsets per face
+static const int FACE_OFFSETS[6][3] = {
+    { 0,  0,  1}, // Front
+    { 0,  0, -1}, // Back
+    {-1,  0,  0}, // Left
+    { 1,  0,  0}, // Right
+    { 0,  1,  0}, // Top
+    { 0, -1,  0}  // Bottom
+};
+
+// Constructor
+LightEngine::LightEngine() {
+    for (int type = 0; type < static_cast<int>(BlockType::Count); type++) {
+        m_transparent[type] = Block::isTransparent(static_cast<BlockType>(type));
+        m_emission[type] = Block::getLightEmission(static_cast<BlockType>(type));
+    }
+}
+
+// Light a freshly generated chunk on its own
+void LightEngine::lightChunk(Chunk* chunk) {
+    // Sky light falls straight down each column until the first opaque block
+    int skyTop[CHUNK_SIZE][CHUNK_SIZE];
+
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            uint8_t level = MAX_LIGHT;
+            skyTop[z][x] = 0;
+
+            for (int y = CHUNK_HEIGHT - 1; y >= 0 && level > 0; y--) {
+                BlockType type = chunk->getBlockUnchecked(x, y, z);
+
+                if (!m_transparent[static_cast<int>(type)]) {
+                    level = 0;
+                } else if (type != BlockType::Air) {
+                    level--;
+                }
+
+                if (level == MAX_LIGHT) {
+                    skyTop[z][x] = y;
+                }
+
+                chunk->setSkyLight(x, y, z, level);
+            }
+        }
+    }
+
+    // Spread sideways from columns that reach deeper than their neighbors
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            int highestNeighbor = skyTop[z][x];
+            if (x > 0) highestNeighbor = std::max(highestNeighbor, skyTop[z][x - 1]);
+            if (x < CHUNK_SIZE - 1) highestNeighbor = std::max(highestNeighbor, skyTop[z][x + 1]);
+            if (z > 0) highestNeighbor = std::max(highestNeighbor, skyTop[z - 1][x]);
+            if (z < CHUNK_SIZE - 1) highestNeighbor = std::max(highestNeighbor, skyTop[z + 1][x]);
+
+            for (int y = skyTop[z][x]; y < highestNeighbor; y++) {
+                LightNode node = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), MAX_LIGHT};
+                m_addQueue[SKY].push_back(node);
+            }
+        }
+    }
+
+    // Block light starts at emissive blocks, scanned straight through the block storage of each section
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        const BlockType* blocks = chunk->getSectionBlocks(section);
+
+        for (int i = 0; i < SECTION_VOLUME; i++) {
+            uint8_t emission = m_emission[static_cast<int>(blocks[i])];
+
+            if (emission > 0) {
+                int x = i % CHUNK_SIZE;
+                int y = section * SECTION_HEIGHT + i / (CHUNK_SIZE * CHUNK_SIZE);
+                int z = i / CHUNK_SIZE % CHUNK_SIZE;
+                chunk->setBlockLight(x, y, z, emission);
+                LightNode node = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), emission};
+                m_addQueue[BLOCK].push_back(node);
+            }
+        }
+    }
+
+    // Not linked yet, so the light stays inside the chunk
+    propagateAdd(SKY);
+    propagateAdd(BLOCK);
+}
+
+// Exchange light between a chunk and its loaded neighbors
+void LightEngine::linkChunk(Chunk* chunk) {
+    // Seed light across each loaded border wherever the levels differ by more than one step
+    for (int face = 0; face < 4; face++) {
+        Chunk* neighbor = chunk->getNeighbor(static_cast<BlockFace>(face));
+        if (!neighbor) {
+            continue;
+        }
+
+        for (int i = 0; i < CHUNK_SIZE; i++) {
+            // Border cell inside this chunk and the touching cell in the neighbor
+            int x = i, z = i, nx = i, nz = i;
+            switch (static_cast<BlockFace>(face)) {
+                case BlockFace::Front: z = CHUNK_SIZE - 1; nz = 0; break;
+                case BlockFace::Back:  z = 0; nz = CHUNK_SIZE - 1; break;
+                case BlockFace::Left:  x = 0; nx = CHUNK_SIZE - 1; break;
+                case BlockFace::Right: x = CHUNK_SIZE - 1; nx = 0; break;
+                default: break;
+            }
+
+            for (int y = 0; y < CHUNK_HEIGHT; y++) {
+                for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
+                    uint8_t inside = getLight(chunk, x, y, z, channel);
+                    uint8_t outside = getLight(neighbor, nx, y, nz, channel);
+
+                    if (inside > outside + 1) {
+                        LightNode node = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), inside};
+                        m_addQueue[channel].push_back(node);
+                    } else if (outside > inside + 1) {
+                        LightNode node = {neighbor, static_cast<int16_t>(nx), static_cast<int16_t>(y), static_cast<int16_t>(nz), outside};
+                        m_addQueue[channel].push_back(node);
+                    }
+                }
+            }
+        }
+    }
+
+    propagateAdd(SKY);
+    propagateAdd(BLOCK);
+}
+
+// Update light around a changed block
+void LightEngine::updateBlock(Chunk* chunk, int x, int y, int z, BlockType oldType, BlockType newType) {
+    if (oldType == newType) {
+        return;
+    }
+
+    bool transparent = m_transparent[static_cast<int>(newType)];
+
+    for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
+        // Take out whatever light passed through or came from the old block
+        uint8_t level = getLight(chunk, x, y, z, channel);
+        if (level > 0) {
+            setLight(chunk, x, y, z, channel, 0);
+            LightNode node = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), level};
+            m_removeQueue[channel].push_back(node);
+            propagateRemove(channel);
+        }
+
+        // Let the surroundings flow back in if the new block lets light through
+        if (transparent) {
+            for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
+                Chunk* neighbor = chunk;
+                int nx = x, ny = y, nz = z;
+
+                if (!step(neighbor, nx, ny, nz, face)) {
+                    // Open sky above the top of the world
+                    if (channel == SKY && ny >= CHUNK_HEIGHT) {
+                        setLight(chunk, x, y, z, SKY, MAX_LIGHT);
+                        LightNode node = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), MAX_LIGHT};
+                        m_addQueue[SKY].push_back(node);
+                    }
+                    continue;
+                }
+
+                uint8_t neighborLevel = getLight(neighbor, nx, ny, nz, channel);
+                if (neighborLevel > 1) {
+                    LightNode node = {neighbor, static_cast<int16_t>(nx), static_cast<int16_t>(ny), static_cast<int16_t>(nz), neighborLevel};
+                    m_addQueue[channel].push_back(node);
+                }
+            }
+        }
+    }
+
+    // New light source
+    uint8_t emission = m_emission[static_cast<int>(newType)];
+    if (emission > 0) {
+        setLight(chunk, x, y, z, BLOCK, emission);
+        LightNode node = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), emission};
+        m_addQueue[BLOCK].push_back(node);
+    }
+
+    propagateAdd(SKY);
+    propagateAdd(BLOCK);
+}
+
+// Spread light from the add queue
+void LightEngine::propagateAdd(int channel) {
+    std::vector<LightNode>& queue = m_addQueue[channel];
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        LightNode node = queue[head];
+
+        // Skip nodes whose light changed after they were queued
+        if (getLight(node.chunk, node.x, node.y, node.z, channel) != node.level || node.level <= 1) {
+            continue;
+        }
+
+        for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
+            Chunk* chunk = node.chunk;
+            int x = node.x, y = node.y, z = node.z;
+
+            if (!step(chunk, x, y, z, face)) {
+                continue;
+            }
+
+            BlockType type = chunk->getBlockUnchecked(x, y, z);
+            if (!m_transparent[static_cast<int>(type)]) {
+                continue;
+            }
+
+            // Full sky light keeps falling through air without fading
+            uint8_t level = node.level - 1;
+            if (channel == SKY && node.level == MAX_LIGHT && face == static_cast<int>(BlockFace::Bottom) && type == BlockType::Air) {
+                level = MAX_LIGHT;
+            }
+
+            if (getLight(chunk, x, y, z, channel) < level) {
+                setLight(chunk, x, y, z, channel, level);
+                LightNode next = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), level};
+                queue.push_back(next);
+            }
+        }
+    }
+
+    queue.clear();
+}
+
+// Darken everything lit through the remove queue
+void LightEngine::propagateRemove(int channel) {
+    std::vector<LightNode>& queue = m_removeQueue[channel];
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        LightNode node = queue[head];
+
+        for (int face = 0; face < static_cast<int>(BlockFace::Count); face++) {
+            Chunk* chunk = node.chunk;
+            int x = node.x, y = node.y, z = node.z;
+
+            if (!step(chunk, x, y, z, face)) {
+                continue;
+            }
+
+            uint8_t level = getLight(chunk, x, y, z, channel);
+            if (level == 0) {
+                continue;
+            }
+
+            bool fellFromRemoved = channel == SKY && node.level == MAX_LIGHT && level == MAX_LIGHT &&
+                                   face == static_cast<int>(BlockFace::Bottom);
+
+            if (level < node.level || fellFromRemoved) {
+                // Lit through the removed node
+                setLight(chunk, x, y, z, channel, 0);
+                LightNode next = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), level};
+                queue.push_back(next);
+
+                // Emitters relight themselves
+                uint8_t emission = m_emission[static_cast<int>(chunk->getBlockUnchecked(x, y, z))];
+                if (channel == BLOCK && emission > 0) {
+                    setLight(chunk, x, y, z, BLOCK, emission);
+                    LightNode source = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), emission};
+                    m_addQueue[BLOCK].push_back(source);
+                }
+            } else {
+                // Lit independently, spread it back into the darkened area
+                LightNode border = {chunk, static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z), level};
+                m_addQueue[channel].push_back(border);
+            }
+        }
+    }
+
+    queue.clear();
+}
+
+// Get light level of a channel
+uint8_t LightEngine::getLight(const Chunk* chunk, int x, int y, int z, int channel) {
+    return channel == SKY ? chunk->getSkyLight(x, y, z) : chunk->getBlockLight(x, y, z);
+}
+
+// Set light level of a channel
+void LightEngine::setLight(Chunk* chunk, int x, int y, int z, int channel, uint8_t level) {
+    if (channel == SKY) {
+        chunk->setSkyLight(x, y, z, level);
+    } else {
+        chunk->setBlockLight(x, y, z, level);
+    }
+
+    // Light is baked into the meshes of every face that sees this block
+    chunk->markBlockDirty(x, y, z);
+}
+
+// Step one block towards face
+bool LightEngine::step(Chunk*& chunk, int& x, int& y, int& z, int face) {
+    x += FACE_OFFSETS[face][0];
+    y += FACE_OFFSETS[face][1];
+    z += FACE_OFFSETS[face][2];
+
+    if (y < 0 || y >= CHUNK_HEIGHT) {
+        return false;
+    }
+
+    if (x < 0) {
+        chunk = chunk->getNeighbor(BlockFace::Left);
+        x += CHUNK_SIZE;
+    } else if (x >= CHUNK_SIZE) {
+        chunk = chunk->getNeighbor(BlockFace::Right);
+        x -= CHUNK_SIZE;
+    } else if (z < 0) {
+        chunk = chunk->getNeighbor(BlockFace::Back);
+        z += CHUNK_SIZE;
+    } else if (z >= CHUNK_SIZE) {
+        chunk = chunk->getNeighbor(BlockFace::Front);
+        z -= CHUNK_SIZE;
+    }
+
+    return chunk != nullptr;
+}
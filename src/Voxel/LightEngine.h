@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Chunk.h"
+#include <cstdint>
+#include <vector>
+
+// Light engine class
+//
+// Flood-fills sky light (down from column tops) and block light (out from emissive
+// blocks) breadth-first through transparent blocks. Light is stored as 4-bit levels
+// in the chunks and crosses chunk borders through the chunk neighbor links, so
+// propagation never touches the world's chunk map.
+class LightEngine {
+public:
+    LightEngine();
+
+    // Light a freshly generated chunk on its own, before it is linked into the world
+    //
+    // Only touches the chunk, so generation tasks run it on their own engine.
+    void lightChunk(Chunk* chunk);
+
+    // Exchange light between a chunk lit by lightChunk and its loaded neighbors
+    void linkChunk(Chunk* chunk);
+
+    // Update light around a block that changed from oldType to newType
+    void updateBlock(Chunk* chunk, int x, int y, int z, BlockType oldType, BlockType newType);
+
+private:
+    // Light channels
+    enum Channel {
+        SKY = 0,
+        BLOCK = 1,
+        CHANNEL_COUNT
+    };
+
+    // Queued light node (chunk-local position)
+    struct LightNode {
+        Chunk* chunk;
+        int16_t x;
+        int16_t y;
+        int16_t z;
+        uint8_t level;
+    };
+
+    // Propagation queues per channel
+    std::vector<LightNode> m_addQueue[CHANNEL_COUNT];
+    std::vector<LightNode> m_removeQueue[CHANNEL_COUNT];
+
+    // Block property tables
+    bool m_transparent[static_cast<int>(BlockType::Count)];
+    uint8_t m_emission[static_cast<int>(BlockType::Count)];
+
+    // Spread light from the add queue
+    void propagateAdd(int channel);
+
+    // Darken everything lit through the remove queue, re-queuing brighter borders
+    void propagateRemove(int channel);
+
+    // Get light level of a channel
+    static uint8_t getLight(const Chunk* chunk, int x, int y, int z, int channel);
+
+    // Set light level of a channel and mark the affected meshes dirty
+    static void setLight(Chunk* chunk, int x, int y, int z, int channel, uint8_t level);
+
+    // Step one block towards face, following neighbor links; false if outside the loaded world
+    static bool step(Chunk*& chunk, int& x, int& y, int& z, int face);
+};
@@ -0,0 +1,250 @@
+#include "MeshCache.h"
+#include "../Core/Metrics.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+// Metrics reported by the mesh cache
+static MetricCounter& s_hits = Metrics::counter("tomicz_mesh_cache_hits_total", "Section meshes reused from the mesh cache");
+static MetricCounter& s_diskHits = Metrics::counter("tomicz_mesh_cache_disk_hits_total", "Section meshes reused from spilled mesh cache files");
+static MetricCounter& s_misses = Metrics::counter("tomicz_mesh_cache_misses_total", "Section meshes not found in the mesh cache");
+static MetricCounter& s_evictions = Metrics::counter("tomicz_mesh_cache_evictions_total", "Section meshes evicted from the mesh cache");
+static MetricGauge& s_bytes = Metrics::gauge("tomicz_mesh_cache_bytes", "Vertex bytes held by the mesh cache");
+
+// Spilled file magic
+static const char MAGIC[4] = {'T', 'M', 'S', 'H'};
+
+// Spilled file header, followed by the vertices
+struct SpillHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexSize;
+    uint32_t vertexCount;
+};
+
+// Hash multipliers
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+
+// Rotate left
+static inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Final avalanche of a lane
+static inline uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= PRIME2;
+    value ^= value >> 29;
+    value *= PRIME3;
+    value ^= value >> 32;
+    return value;
+}
+
+// Check that a spill file holds exactly the vertices its header counts, before they are allocated
+static bool hasSize(std::ifstream& file, const SpillHeader& header) {
+    file.seekg(0, std::ios::end);
+    std::streampos fileEnd = file.tellg();
+    if (fileEnd < 0 || static_cast<uint64_t>(fileEnd) != sizeof(SpillHeader) + static_cast<uint64_t>(header.vertexCount) * sizeof(ChunkVertex)) {
+        return false;
+    }
+    file.seekg(sizeof(SpillHeader));
+    return static_cast<bool>(file);
+}
+
+// Constructor
+MeshCache::MeshCache(size_t maxBytes, const std::string& directory)
+    : m_maxBytes(maxBytes), m_directory(directory), m_stats() {
+    // An existing directory is fine, spilled meshes of earlier runs are reused
+    if (!m_directory.empty()) {
+        mkdir(m_directory.c_str(), 0755);
+    }
+}
+
+// Find the mesh of key
+SectionMesh MeshCache::find(const MeshCacheKey& key) {
+    SectionMesh found;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+            found = it->second.mesh;
+            m_stats.hits++;
+        }
+    }
+
+    if (found) {
+        s_hits.add();
+        return found;
+    }
+
+    // Then the spill directory, read back into memory
+    if (!m_directory.empty()) {
+        std::ifstream file(getFilename(key), std::ios::binary);
+        SpillHeader header;
+        if (file && file.read(reinterpret_cast<char*>(&header), sizeof(header)) && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+            header.version == FORMAT_VERSION && header.vertexSize == sizeof(ChunkVertex) && header.vertexCount > 0 && hasSize(file, header)) {
+            std::shared_ptr<std::vector<ChunkVertex>> loaded(new std::vector<ChunkVertex>(header.vertexCount));
+            if (file.read(reinterpret_cast<char*>(loaded->data()), loaded->size() * sizeof(ChunkVertex))) {
+                std::vector<std::pair<MeshCacheKey, SectionMesh>> evicted;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.hits++;
+                    m_stats.diskHits++;
+                    insert(key, loaded, evicted);
+                }
+                spill(evicted);
+
+                s_hits.add();
+                s_diskHits.add();
+                return loaded;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.misses++;
+    }
+    s_misses.add();
+    return nullptr;
+}
+
+// Add the mesh of key
+void MeshCache::add(const MeshCacheKey& key, const SectionMesh& mesh) {
+    std::vector<std::pair<MeshCacheKey, SectionMesh>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        insert(key, mesh, evicted);
+    }
+    spill(evicted);
+}
+
+// Drop all meshes in memory
+void MeshCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_stats.bytes = 0;
+    s_bytes.set(0.0);
+}
+
+// Get counters
+MeshCacheStats MeshCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MeshCacheStats stats = m_stats;
+    stats.entries = m_entries.size();
+    return stats;
+}
+
+// Start a key from a seed
+MeshCacheKey MeshCache::beginKey(uint64_t seed) {
+    MeshCacheKey key;
+    key.low = seed ^ PRIME1;
+    key.high = rotateLeft(seed, 32) ^ PRIME2;
+    return key;
+}
+
+// Hash size bytes into key
+void MeshCache::hashBytes(MeshCacheKey& key, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t low = key.low;
+    uint64_t high = key.high;
+
+    // Two independent lanes over 8-byte words give a 128-bit key
+    size_t words = size / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(word));
+        low = rotateLeft(low ^ (word * PRIME1), 31) * PRIME2;
+        high = rotateLeft(high ^ (word * PRIME3), 27) * PRIME1 + low;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, bytes + words * sizeof(uint64_t), size % sizeof(uint64_t));
+    low = rotateLeft(low ^ (tail * PRIME1), 31) * PRIME2;
+    high = rotateLeft(high ^ (tail * PRIME3), 27) * PRIME1 + low;
+
+    key.low = mix(low ^ size);
+    key.high = mix(high + size);
+}
+
+// Add a mesh while holding the lock
+void MeshCache::insert(const MeshCacheKey& key, const SectionMesh& mesh,
+                       std::vector<std::pair<MeshCacheKey, SectionMesh>>& evicted) {
+    // Another worker may have meshed the same section meanwhile
+    if (m_entries.find(key) != m_entries.end()) {
+        return;
+    }
+
+    size_t bytes = mesh->size() * sizeof(ChunkVertex);
+    if (bytes > m_maxBytes) {
+        return;
+    }
+
+    m_lru.push_front(key);
+    Entry& entry = m_entries[key];
+    entry.mesh = mesh;
+    entry.lruPosition = m_lru.begin();
+    m_stats.bytes += bytes;
+
+    // Least recently used meshes make room
+    while (m_stats.bytes > m_maxBytes) {
+        auto it = m_entries.find(m_lru.back());
+        m_stats.bytes -= it->second.mesh->size() * sizeof(ChunkVertex);
+        m_stats.evictions++;
+        s_evictions.add();
+
+        if (!m_directory.empty()) {
+            evicted.push_back(std::make_pair(it->first, it->second.mesh));
+        }
+        m_entries.erase(it);
+        m_lru.pop_back();
+    }
+
+    s_bytes.set(static_cast<double>(m_stats.bytes));
+}
+
+// Write evicted meshes to the spill directory
+void MeshCache::spill(const std::vector<std::pair<MeshCacheKey, SectionMesh>>& evicted) {
+    for (const auto& mesh : evicted) {
+        std::string filename = getFilename(mesh.first);
+
+        // Same key, same content: a file written earlier stays valid
+        if (std::ifstream(filename, std::ios::binary)) {
+            continue;
+        }
+
+        SpillHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = FORMAT_VERSION;
+        header.vertexSize = sizeof(ChunkVertex);
+        header.vertexCount = static_cast<uint32_t>(mesh.second->size());
+
+        // Written next to the target and renamed, so readers never see a partial file
+        std::string temporary = filename + ".tmp";
+        std::ofstream file(temporary, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mesh.second->data()), mesh.second->size() * sizeof(ChunkVertex));
+        file.close();
+
+        if (!file || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.spills++;
+    }
+}
+
+// Get the spill file of a key
+std::string MeshCache::getFilename(const MeshCacheKey& key) const {
+    char name[40];
+    std::snprintf(name, sizeof(name), "%016llx%016llx.mesh", static_cast<unsigned long long>(key.high), static_cast<unsigned long long>(key.low));
+    return m_directory + "/" + name;
+}
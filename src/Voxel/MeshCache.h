@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Chunk.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Content hash of everything a section mesh is built from
+struct MeshCacheKey {
+    uint64_t low;
+    uint64_t high;
+
+    bool operator==(const MeshCacheKey& other) const {
+        return low == other.low && high == other.high;
+    }
+
+    struct Hash {
+        size_t operator()(const MeshCacheKey& key) const {
+            return static_cast<size_t>(key.low);
+        }
+    };
+};
+
+// Mesh cache counters
+struct MeshCacheStats {
+    uint64_t hits;          // Lookups answered from memory or disk
+    uint64_t diskHits;      // Lookups answered from disk
+    uint64_t misses;
+    uint64_t evictions;     // Meshes dropped from memory
+    uint64_t spills;        // Evicted meshes written to disk
+    uint64_t bytes;         // Vertex bytes of cached meshes (shared with loaded chunks)
+    size_t entries;
+};
+
+// Mesh cache class
+//
+// Keeps section meshes by a 128-bit hash of the mesher's inputs (the blocks of
+// the section, opacity and light of the section padded by its neighbors'
+// borders, mesher version and settings), so a section whose surroundings did
+// not change reuses its mesh instead of being meshed again, e.g. when an area
+// is unloaded and entered again. Meshes are immutable and shared with the
+// chunks using them, so a hit costs no copy and meshes of loaded chunks take no
+// extra memory. Meshes are kept up to a byte budget and the least recently
+// used are evicted. With a directory, evicted meshes are written there and
+// read back on a later miss. Thread safe: meshing workers look up and add
+// concurrently.
+class MeshCache {
+public:
+    // Default memory budget
+    static const size_t DEFAULT_MAX_BYTES = 256 * 1024 * 1024;
+
+    // Spilled mesh file format version
+    static const uint32_t FORMAT_VERSION = 1;
+
+    // Create a cache keeping up to maxBytes of vertices in memory, spilling evicted meshes to directory if not empty
+    explicit MeshCache(size_t maxBytes = DEFAULT_MAX_BYTES, const std::string& directory = "");
+
+    // Delete copy constructor and assignment operator
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    // Find the mesh of key, returns nullptr if it is neither in memory nor on disk
+    SectionMesh find(const MeshCacheKey& key);
+
+    // Add the mesh of key
+    void add(const MeshCacheKey& key, const SectionMesh& mesh);
+
+    // Drop all meshes in memory (spilled files are kept)
+    void clear();
+
+    // Get counters
+    MeshCacheStats getStats() const;
+
+    // Start a key from a seed
+    static MeshCacheKey beginKey(uint64_t seed);
+
+    // Hash size bytes into key
+    static void hashBytes(MeshCacheKey& key, const void* data, size_t size);
+
+private:
+    // Cached mesh
+    struct Entry {
+        SectionMesh mesh;
+        std::list<MeshCacheKey>::iterator lruPosition;
+    };
+
+    // Memory budget
+    size_t m_maxBytes;
+
+    // Spill directory (empty = memory only)
+    std::string m_directory;
+
+    // Meshes and their use order, most recent first
+    mutable std::mutex m_mutex;
+    std::unordered_map<MeshCacheKey, Entry, MeshCacheKey::Hash> m_entries;
+    std::list<MeshCacheKey> m_lru;
+
+    // Counters
+    MeshCacheStats m_stats;
+
+    // Add a mesh while holding the lock, collecting meshes evicted to make room
+    void insert(const MeshCacheKey& key, const SectionMesh& mesh,
+                std::vector<std::pair<MeshCacheKey, SectionMesh>>& evicted);
+
+    // Write evicted meshes to the spill directory
+    void spill(const std::vector<std::pair<MeshCacheKey, SectionMesh>>& evicted);
+
+    // Get the spill file of a key
+    std::string getFilename(const MeshCacheKey& key) const;
+};
@@ -0,0 +1,127 @@
+#include "SectionPool.h"
+#include "../Core/Metrics.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Metrics reported by the section pool
+static MetricGauge& s_poolSections = Metrics::gauge("tomicz_section_pool_sections", "Distinct chunk sections in the section pool");
+static MetricGauge& s_dedupRatio = Metrics::gauge("tomicz_section_dedup_ratio", "Chunk sections per distinct pooled section");
+
+// Pooled section, the blocks come first so a section pointer is also the entry pointer
+struct PooledSection {
+    SectionBlocks blocks;
+    uint64_t hash;
+    size_t references;
+};
+
+// Pool state, created on first use
+struct PoolState {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<PooledSection*>> sections;
+    size_t sectionCount;
+    size_t references;
+
+    PoolState() : sectionCount(0), references(0) {}
+};
+
+// Get the pool state
+static PoolState& getState() {
+    static PoolState state;
+    return state;
+}
+
+// Update the gauges while holding the lock
+static void updateGauges(const PoolState& state) {
+    s_poolSections.set(static_cast<double>(state.sectionCount));
+    s_dedupRatio.set(state.sectionCount > 0 ? static_cast<double>(state.references) / state.sectionCount : 0.0);
+}
+
+// Hash the blocks of a section
+static uint64_t hashBlocks(const BlockType* blocks) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(blocks);
+    uint64_t hash = 0x9E3779B185EBCA87ULL;
+    for (size_t i = 0; i < sizeof(SectionBlocks); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0xC2B2AE3D27D4EB4FULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// Get the shared section holding blocks
+const SectionBlocks* SectionPool::intern(const BlockType* blocks) {
+    static_assert(sizeof(SectionBlocks) % sizeof(uint64_t) == 0, "sections are hashed in 8 byte words");
+
+    PoolState& state = getState();
+    uint64_t hash = hashBlocks(blocks);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::vector<PooledSection*>& bucket = state.sections[hash];
+    PooledSection* found = nullptr;
+    for (PooledSection* section : bucket) {
+        if (std::memcmp(section->blocks.data(), blocks, sizeof(SectionBlocks)) == 0) {
+            found = section;
+            break;
+        }
+    }
+
+    if (!found) {
+        found = new PooledSection();
+        std::copy(blocks, blocks + SECTION_VOLUME, found->blocks.begin());
+        found->hash = hash;
+        found->references = 0;
+        bucket.push_back(found);
+        state.sectionCount++;
+    }
+
+    found->references++;
+    state.references++;
+    updateGauges(state);
+    return &found->blocks;
+}
+
+// Release a reference returned by intern
+void SectionPool::release(const SectionBlocks* blocks) {
+    PooledSection* section = reinterpret_cast<PooledSection*>(const_cast<SectionBlocks*>(blocks));
+    PoolState& state = getState();
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.references--;
+
+        if (--section->references > 0) {
+            updateGauges(state);
+            return;
+        }
+
+        // Last reference, the section leaves the pool
+        auto it = state.sections.find(section->hash);
+        std::vector<PooledSection*>& bucket = it->second;
+        bucket.erase(std::find(bucket.begin(), bucket.end(), section));
+        if (bucket.empty()) {
+            state.sections.erase(it);
+        }
+        state.sectionCount--;
+        updateGauges(state);
+    }
+
+    delete section;
+}
+
+// Get counters
+SectionPoolStats SectionPool::getStats() {
+    PoolState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    SectionPoolStats stats;
+    stats.sections = state.sectionCount;
+    stats.references = state.references;
+    stats.bytes = state.sectionCount * sizeof(SectionBlocks);
+    return stats;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Chunk.h"
+#include <cstddef>
+
+// Section pool counters
+struct SectionPoolStats {
+    size_t sections;        // Distinct sections in the pool
+    size_t references;      // Chunk sections sharing them
+    size_t bytes;           // Block bytes of the distinct sections
+};
+
+// Section pool class
+//
+// Interns the blocks of chunk sections, so chunks whose sections hold the same
+// blocks share one copy (generated worlds are mostly all-air sky and all-stone
+// ground). Interned sections are immutable: a chunk copies a section into its
+// own storage before the first edit. Sections are reference counted and leave
+// the pool when their last reference is released. Thread safe: chunks are
+// generated on worker threads.
+class SectionPool {
+public:
+    // Get the shared section holding blocks (SECTION_VOLUME of them), adding one if none matches
+    //
+    // Every call adds a reference, to be given back with release.
+    static const SectionBlocks* intern(const BlockType* blocks);
+
+    // Release a reference returned by intern
+    static void release(const SectionBlocks* section);
+
+    // Get counters
+    static SectionPoolStats getStats();
+};
@@ -0,0 +1,296 @@
+#include "SpawnSnapshot.h"
+#include "ChunkMesher.h"
+#include "TerrainGenerator.h"
+#include "../Core/MappedFile.h"
+#include "../Core/Profiler.h"
+#include "../Core/TaskScheduler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// File magic
+static const char MAGIC[4] = {'T', 'S', 'P', 'N'};
+
+// File header
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t seed;
+    int32_t generatorVersion;
+    uint32_t chunkSize;
+    uint32_t chunkHeight;
+    uint32_t meshVersion;
+    int32_t centerX;
+    int32_t centerZ;
+    int32_t radius;
+    uint32_t chunkCount;
+    uint32_t reserved;
+    uint64_t fileSize;
+};
+
+// Chunk table entry, the header is followed by one per chunk
+struct SnapshotChunk {
+    int32_t x;
+    int32_t z;
+    uint32_t blockRuns;
+    uint32_t lightRuns;
+    uint32_t faceCounts[CHUNK_SECTIONS];
+    uint32_t meshed;
+    uint32_t reserved;
+    uint64_t offset;        // Block runs, light runs, then the packed faces of each section
+};
+
+// Runs are value | (length - 1) << 8, so every section of the file stays 4 byte aligned
+static const uint32_t MAX_RUN_LENGTH = 1u << 24;
+
+// Run-length encode CHUNK_VOLUME bytes
+static void encodeRuns(const uint8_t* data, std::vector<uint32_t>& runs) {
+    runs.clear();
+
+    int start = 0;
+    while (start < CHUNK_VOLUME) {
+        int end = start + 1;
+        while (end < CHUNK_VOLUME && data[end] == data[start] && static_cast<uint32_t>(end - start) < MAX_RUN_LENGTH) {
+            end++;
+        }
+        runs.push_back(data[start] | static_cast<uint32_t>(end - start - 1) << 8);
+        start = end;
+    }
+}
+
+// Decode runs into CHUNK_VOLUME bytes, returns false if they do not add up to exactly that
+static bool decodeRuns(const uint32_t* runs, uint32_t count, uint8_t* data) {
+    size_t position = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t length = (runs[i] >> 8) + 1;
+        if (position + length > CHUNK_VOLUME) {
+            return false;
+        }
+        std::memset(data + position, static_cast<int>(runs[i] & 0xFF), length);
+        position += length;
+    }
+    return position == CHUNK_VOLUME;
+}
+
+// Check if a chunk is within radius of center
+static bool isWithin(int x, int z, const ChunkPosition& center, int radius) {
+    return std::abs(x - center.x) <= radius && std::abs(z - center.z) <= radius;
+}
+
+// Save the loaded chunks within radius of center
+bool SpawnSnapshot::save(const std::string& filename, const World& world, const ChunkPosition& center, int radius, bool meshes) {
+    PROFILE_ZONE("SpawnSnapshot::save");
+
+    // Chunks in a fixed order, so equal worlds give equal files
+    std::vector<const Chunk*> chunks;
+    for (const auto& pair : world.getChunks()) {
+        if (isWithin(pair.first.x, pair.first.z, center, radius)) {
+            chunks.push_back(pair.second);
+        }
+    }
+    std::sort(chunks.begin(), chunks.end(), [](const Chunk* a, const Chunk* b) {
+        return a->getPosition().z != b->getPosition().z ? a->getPosition().z < b->getPosition().z : a->getPosition().x < b->getPosition().x;
+    });
+
+    // Encode everything first, the table needs the offsets
+    std::vector<SnapshotChunk> table(chunks.size());
+    std::vector<std::vector<uint32_t>> blockRuns(chunks.size());
+    std::vector<std::vector<uint32_t>> lightRuns(chunks.size());
+    std::vector<std::vector<uint64_t>> faces(chunks.size());
+    uint64_t offset = sizeof(SnapshotHeader) + sizeof(SnapshotChunk) * chunks.size();
+
+    std::vector<BlockType> blocks(CHUNK_VOLUME);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const Chunk* chunk = chunks[i];
+        chunk->copyBlocks(blocks.data());
+        encodeRuns(reinterpret_cast<const uint8_t*>(blocks.data()), blockRuns[i]);
+        encodeRuns(chunk->getLightData(), lightRuns[i]);
+
+        SnapshotChunk& entry = table[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.x = chunk->getPosition().x;
+        entry.z = chunk->getPosition().z;
+        entry.blockRuns = static_cast<uint32_t>(blockRuns[i].size());
+        entry.lightRuns = static_cast<uint32_t>(lightRuns[i].size());
+        entry.meshed = meshes && chunk->getDirtySections() == 0 ? 1 : 0;
+        entry.offset = offset;
+
+        // A chunk with any face the mesher cannot pack is saved without meshes
+        for (int section = 0; entry.meshed && section < CHUNK_SECTIONS; section++) {
+            const std::vector<ChunkVertex>& vertices = chunk->getSectionVertices(section);
+            entry.faceCounts[section] = static_cast<uint32_t>(vertices.size() / 4);
+            if (vertices.size() % 4 != 0) {
+                entry.meshed = 0;
+            }
+
+            uint64_t packed;
+            for (size_t vertex = 0; entry.meshed && vertex < vertices.size(); vertex += 4) {
+                if (ChunkMesher::packFace(&vertices[vertex], packed)) {
+                    faces[i].push_back(packed);
+                } else {
+                    entry.meshed = 0;
+                }
+            }
+        }
+        if (!entry.meshed) {
+            std::memset(entry.faceCounts, 0, sizeof(entry.faceCounts));
+            faces[i].clear();
+        }
+
+        offset += (blockRuns[i].size() + lightRuns[i].size()) * sizeof(uint32_t) + faces[i].size() * sizeof(uint64_t);
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.seed = TerrainGenerator::SEED;
+    header.generatorVersion = TerrainGenerator::VERSION;
+    header.chunkSize = CHUNK_SIZE;
+    header.chunkHeight = CHUNK_HEIGHT;
+    header.meshVersion = ChunkMesher::VERSION;
+    header.centerX = center.x;
+    header.centerZ = center.z;
+    header.radius = radius;
+    header.chunkCount = static_cast<uint32_t>(chunks.size());
+    header.fileSize = offset;
+
+    // Write next to the target and rename, so a crash never leaves a partial snapshot
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), sizeof(SnapshotChunk) * table.size());
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            file.write(reinterpret_cast<const char*>(blockRuns[i].data()), blockRuns[i].size() * sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(lightRuns[i].data()), lightRuns[i].size() * sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(faces[i].data()), faces[i].size() * sizeof(uint64_t));
+        }
+
+        if (!file) {
+            file.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    return std::rename(temporary.c_str(), filename.c_str()) == 0;
+}
+
+// Restore the saved chunks within radius of center
+size_t SpawnSnapshot::load(const std::string& filename, World* world, const ChunkPosition& center, int radius, TaskScheduler* scheduler) {
+    PROFILE_ZONE("SpawnSnapshot::load");
+
+    // Restored light and meshes assume the neighbors they were saved with
+    if (!world->getChunks().empty()) {
+        return 0;
+    }
+
+    MappedFile file;
+    if (!file.open(filename) || file.getSize() < sizeof(SnapshotHeader)) {
+        return 0;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+        header.seed != TerrainGenerator::SEED || header.generatorVersion != TerrainGenerator::VERSION ||
+        header.chunkSize != CHUNK_SIZE || header.chunkHeight != CHUNK_HEIGHT || header.meshVersion != ChunkMesher::VERSION ||
+        header.centerX != center.x || header.centerZ != center.z || header.fileSize != file.getSize() ||
+        header.chunkCount > (file.getSize() - sizeof(SnapshotHeader)) / sizeof(SnapshotChunk)) {
+        return 0;
+    }
+
+    // The mapping is page aligned and every part of the file 4 byte aligned, so it is read in place
+    const SnapshotChunk* table = reinterpret_cast<const SnapshotChunk*>(file.getData() + sizeof(SnapshotHeader));
+    uint64_t dataStart = sizeof(SnapshotHeader) + sizeof(SnapshotChunk) * static_cast<uint64_t>(header.chunkCount);
+
+    // Wanted chunks whose data lies inside the file
+    std::vector<const SnapshotChunk*> entries;
+    for (uint32_t i = 0; i < header.chunkCount; i++) {
+        const SnapshotChunk& entry = table[i];
+        if (!isWithin(entry.x, entry.z, center, radius)) {
+            continue;
+        }
+
+        uint64_t size = (static_cast<uint64_t>(entry.blockRuns) + entry.lightRuns) * sizeof(uint32_t);
+        for (int section = 0; section < CHUNK_SECTIONS; section++) {
+            size += static_cast<uint64_t>(entry.faceCounts[section]) * sizeof(uint64_t);
+        }
+        if (entry.offset < dataStart || entry.offset % sizeof(uint32_t) != 0 || entry.offset > file.getSize() || size > file.getSize() - entry.offset) {
+            return 0;
+        }
+        entries.push_back(&entry);
+    }
+
+    // Decode into new chunks, each task only touches its own chunk
+    std::vector<Chunk*> chunks(entries.size(), nullptr);
+    const uint8_t* data = file.getData();
+    auto restore = [&entries, &chunks, data](size_t i) {
+        const SnapshotChunk& entry = *entries[i];
+        const uint32_t* runs = reinterpret_cast<const uint32_t*>(data + entry.offset);
+
+        std::vector<uint8_t> blocks(CHUNK_VOLUME);
+        std::vector<uint8_t> light(CHUNK_VOLUME);
+        if (!decodeRuns(runs, entry.blockRuns, blocks.data()) || !decodeRuns(runs + entry.blockRuns, entry.lightRuns, light.data())) {
+            return;
+        }
+        if (*std::max_element(blocks.begin(), blocks.end()) >= static_cast<uint8_t>(BlockType::Count)) {
+            return;
+        }
+
+        Chunk* chunk = new Chunk(entry.x, entry.z);
+        chunk->restoreTerrain(reinterpret_cast<const BlockType*>(blocks.data()), light.data());
+
+        // Packed faces are only 4 byte aligned, so they are copied out one by one
+        const uint8_t* faces = reinterpret_cast<const uint8_t*>(runs + entry.blockRuns + entry.lightRuns);
+        for (int section = 0; entry.meshed && section < CHUNK_SECTIONS; section++) {
+            uint32_t faceCount = entry.faceCounts[section];
+            if (faceCount == 0) {
+                chunk->restoreSectionMesh(section, Chunk::getEmptyMesh());
+                continue;
+            }
+
+            // Unpack straight into the mesh the chunk keeps, a corrupt section is left dirty for meshing
+            std::vector<ChunkVertex>* vertices = new std::vector<ChunkVertex>(static_cast<size_t>(faceCount) * 4);
+            SectionMesh mesh(vertices);
+            ChunkVertex* out = vertices->data();
+            for (uint32_t face = 0; face < faceCount && out; face++) {
+                uint64_t packed;
+                std::memcpy(&packed, faces + face * sizeof(uint64_t), sizeof(packed));
+                out = ChunkMesher::unpackFace(out, packed);
+            }
+            if (out) {
+                chunk->restoreSectionMesh(section, mesh);
+            }
+            faces += faceCount * sizeof(uint64_t);
+        }
+        chunks[i] = chunk;
+    };
+
+    if (scheduler) {
+        scheduler->parallelFor(chunks.size(), 1, restore, TaskPriority::High);
+    } else {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            restore(i);
+        }
+    }
+
+    // Chunks that failed to decode are generated by the world instead
+    size_t restored = 0;
+    for (Chunk* chunk : chunks) {
+        if (chunk) {
+            world->addRestoredChunk(chunk);
+            restored++;
+        }
+    }
+    return restored;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "World.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Forward declarations
+class TaskScheduler;
+
+// Spawn snapshot class
+//
+// Saves the generated, lit and meshed chunks around the spawn point in a
+// compact binary file and restores them on the next start, so the first frame
+// does not wait for generation, lighting and meshing. The file is memory
+// mapped. Blocks and light are run-length encoded (terrain is mostly long runs
+// of stone, air and full sky light), and section meshes are packed faces (8
+// bytes instead of four 48 byte vertices) that unpack into the chunks' meshes.
+// A chunk table lets chunks be decoded in parallel. Snapshots of another
+// terrain seed, generator or mesher version, or chunk layout are ignored.
+class SpawnSnapshot {
+public:
+    // File format version, bump whenever the layout changes
+    static const uint32_t FORMAT_VERSION = 2;
+
+    // Save the loaded chunks within radius of center, returns false on failure
+    //
+    // With meshes, the meshes of chunks without dirty sections are saved too.
+    // They skip meshing on restore but take most of the file.
+    static bool save(const std::string& filename, const World& world, const ChunkPosition& center, int radius, bool meshes = false);
+
+    // Restore the saved chunks within radius of center into a world without loaded chunks, decoding on the scheduler's workers if given
+    //
+    // Returns the number of chunks restored: 0 if the file is missing, stale,
+    // corrupt or saved around another center. Chunks the snapshot does not
+    // cover are left for the world to generate.
+    static size_t load(const std::string& filename, World* world, const ChunkPosition& center, int radius, TaskScheduler* scheduler = nullptr);
+};
@@ -0,0 +1,28 @@
+#include "TerrainGenerator.h"
+#include <algorithm>
+
+const int TerrainGenerator::SEED;
+
+// Constructor
+TerrainGenerator::TerrainGenerator() {
+    m_noise.SetNoiseType(FastNoise::SimplexFractal);
+    m_noise.SetSeed(SEED);
+    m_noise.SetFrequency(0.01f);
+    m_noise.SetFractalOctaves(4);
+}
+
+// Get surface height at a world column
+int TerrainGenerator::getHeight(int worldX, int worldZ) {
+    float heightValue = m_noise.GetNoise(static_cast<float>(worldX), static_cast<float>(worldZ));
+    int height = static_cast<int>((heightValue + 1.0f) * 32.0f + 64.0f);
+    return std::min(height, CHUNK_HEIGHT - 1);
+}
+
+// Get surface heights of the columns of a chunk
+void TerrainGenerator::getChunkHeights(int chunkX, int chunkZ, int* heights) {
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            heights[z * CHUNK_SIZE + x] = getHeight(chunkX * CHUNK_SIZE + x, chunkZ * CHUNK_SIZE + z);
+        }
+    }
+}
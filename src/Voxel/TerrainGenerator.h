@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Chunk.h"
+#include "FastNoise.h"
+
+// Terrain generator class
+//
+// Surface height and block types of terrain columns, shared by chunk
+// generation and the world map so both produce the same world. Heights only
+// depend on 2D noise of the column, so any column can be evaluated without
+// generating its chunk. Not thread safe (the noise object is mutable): use
+// one generator per thread, construction is cheap.
+class TerrainGenerator {
+public:
+    // World seed
+    static const int SEED = 12345;
+
+    // Version of the terrain shape, bump whenever generation changes so saved terrain is regenerated
+    static const int VERSION = 1;
+
+    // Constructor
+    TerrainGenerator();
+
+    // Get surface height (y of the top block, negative for an empty column) at a world column
+    int getHeight(int worldX, int worldZ);
+
+    // Get surface heights of the columns of a chunk, indexed z * CHUNK_SIZE + x
+    void getChunkHeights(int chunkX, int chunkZ, int* heights);
+
+    // Get block type at y of a column with the given surface height
+    static BlockType getBlockType(int y, int height) {
+        if (y > height) {
+            return BlockType::Air;
+        } else if (y == height) {
+            return BlockType::Grass;
+        } else if (y > height - 4) {
+            return BlockType::Dirt;
+        }
+        return BlockType::Stone;
+    }
+
+private:
+    // Height noise
+    FastNoise m_noise;
+};
@@ -0,0 +1,424 @@
+#include "VoxelRenderer.h"
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Metrics reported by the renderer
+static MetricCounter& s_uploadedBytes = Metrics::counter("tomicz_mesh_upload_bytes_total", "Vertex bytes uploaded to the GPU");
+static MetricCounter& s_uploadedVertices = Metrics::counter("tomicz_mesh_upload_vertices_total", "Vertices uploaded to the GPU");
+static MetricGauge& s_meshBytes = Metrics::gauge("tomicz_mesh_resident_bytes", "Vertex bytes of chunk meshes held on the GPU");
+static MetricGauge& s_drawnSections = Metrics::gauge("tomicz_drawn_sections", "Chunk sections drawn in the last frame");
+static MetricGauge& s_drawBatches = Metrics::gauge("tomicz_draw_batches", "Draw batches submitted in the last frame");
+static MetricGauge& s_heapCapacity = Metrics::gauge("tomicz_mesh_heap_capacity_bytes", "Bytes of mesh heap pages");
+static MetricGauge& s_heapUsed = Metrics::gauge("tomicz_mesh_heap_used_bytes", "Bytes of mesh heap ranges holding meshes");
+static MetricGauge& s_heapFragmentation = Metrics::gauge("tomicz_mesh_heap_fragmentation", "Share of free mesh heap bytes outside the largest free range");
+
+// Sky color the frame is cleared to
+static const glm::vec4 CLEAR_COLOR(0.2f, 0.3f, 0.8f, 1.0f);
+
+// Greatest common divisor
+static constexpr uint32_t greatestCommonDivisor(uint32_t a, uint32_t b) {
+    return b == 0 ? a : greatestCommonDivisor(b, a % b);
+}
+
+// Mesh ranges start at whole vertices, so batched draws address them with a base vertex
+static const uint32_t MESH_ALIGNMENT =
+    MeshHeap::ALIGNMENT / greatestCommonDivisor(MeshHeap::ALIGNMENT, sizeof(ChunkVertex)) * sizeof(ChunkVertex);
+
+// Instances of the first instance ring
+static const size_t MIN_INSTANCE_CAPACITY = 1024;
+
+// Constructor
+VoxelRenderer::VoxelRenderer(RenderBackend* backend)
+    : m_backend(backend),
+      m_quadIndexBuffer(0),
+      m_textureAtlas(0),
+      m_meshHeap(MeshHeap::DEFAULT_PAGE_SIZE, RenderBackend::MAX_FRAMES_IN_FLIGHT, MESH_ALIGNMENT),
+      m_batching(true),
+      m_instanceRing(0),
+      m_instanceCapacity(0),
+      m_frameIndex(0),
+      m_unloadedChunkCount(0) {
+}
+
+// Destructor
+VoxelRenderer::~VoxelRenderer() {
+    for (auto& pair : m_chunkMeshes) {
+        destroyChunkMesh(pair.second);
+    }
+    for (RenderHandle buffer : m_pageBuffers) {
+        m_backend->destroyBuffer(buffer);
+    }
+    m_backend->destroyBuffer(m_instanceRing);
+    m_backend->destroyBuffer(m_quadIndexBuffer);
+    m_backend->destroyTexture(m_textureAtlas);
+}
+
+// Initialize the renderer
+bool VoxelRenderer::init() {
+    if (!m_backend->init()) {
+        std::cerr << "Failed to initialize render backend!" << std::endl;
+        return false;
+    }
+    
+    // Load texture atlas
+    if (!loadTextureAtlas()) {
+        std::cerr << "Failed to load texture atlas!" << std::endl;
+        return false;
+    }
+    
+    // Create shared quad index buffer
+    const std::vector<uint32_t>& quadIndices = Chunk::getQuadIndices();
+    m_quadIndexBuffer = m_backend->createBuffer(quadIndices.data(), quadIndices.size() * sizeof(uint32_t));
+    if (!m_quadIndexBuffer) {
+        std::cerr << "Failed to create quad index buffer!" << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+// Render the world
+void VoxelRenderer::render(World* world, const Camera& camera) {
+    PROFILE_ZONE("VoxelRenderer::render");
+    
+    prepareFrame(world, camera);
+    submitFrame(camera);
+}
+
+// Cull and sort the visible chunk sections
+void VoxelRenderer::prepareFrame(const World* world, const Camera& camera) {
+    PROFILE_ZONE("VoxelRenderer::prepareFrame");
+    
+    // Cull chunks outside the view and draw the rest front to back
+    Frustum frustum = Frustum::fromMatrix(camera.getProjectionMatrix() * camera.getViewMatrix());
+    ChunkCuller::cull(*world, frustum, camera.getPosition(), m_drawList);
+    ChunkCuller::sortFrontToBack(m_drawList);
+}
+
+// Submit the sections found by the last prepareFrame
+void VoxelRenderer::submitFrame(const Camera& camera) {
+    submitDrawList(m_drawList, camera);
+}
+
+// Submit the sections of a culled draw list
+void VoxelRenderer::submitDrawList(const std::vector<ChunkDraw>& drawList, const Camera& camera) {
+    PROFILE_ZONE("VoxelRenderer::submitDrawList");
+    
+    if (!m_backend->beginFrame(CLEAR_COLOR)) {
+        return;
+    }
+    
+    // Set texture
+    m_backend->setTexture(m_textureAtlas);
+    
+    size_t drawnSections = 0;
+    for (const ChunkDraw& draw : drawList) {
+        drawnSections += __builtin_popcount(draw.sections);
+    }
+    s_drawnSections.set(static_cast<double>(drawnSections));
+    
+    if (m_batching) {
+        submitBatches(drawList, camera);
+    } else {
+        // View and projection are the same for every chunk
+        DrawUniforms uniforms;
+        uniforms.viewMatrix = camera.getViewMatrix();
+        uniforms.projectionMatrix = camera.getProjectionMatrix();
+        
+        // Render chunks
+        for (const ChunkDraw& draw : drawList) {
+            renderChunk(draw.position, draw.sections, uniforms);
+        }
+        s_drawBatches.set(0.0);
+    }
+    
+    // End encoding and present
+    m_backend->endFrame();
+    m_frameIndex++;
+    
+    // Ranges freed MAX_FRAMES_IN_FLIGHT frames ago are no longer read
+    m_meshHeap.endFrame();
+    
+    MeshHeap::Stats heapStats = m_meshHeap.getStats();
+    s_heapCapacity.set(static_cast<double>(heapStats.capacityBytes));
+    s_heapUsed.set(static_cast<double>(heapStats.usedBytes));
+    s_heapFragmentation.set(m_meshHeap.getFragmentation());
+}
+
+// Update chunk meshes
+void VoxelRenderer::updateChunkMeshes(World* world, const glm::vec3& viewerPosition, size_t maxChunks) {
+    PROFILE_ZONE("VoxelRenderer::updateChunkMeshes");
+    
+    // Drop meshes of chunks the world unloaded
+    if (world->getUnloadedChunkCount() != m_unloadedChunkCount) {
+        m_unloadedChunkCount = world->getUnloadedChunkCount();
+        
+        for (auto it = m_chunkMeshes.begin(); it != m_chunkMeshes.end();) {
+            if (!world->findChunk(it->first.x, it->first.z)) {
+                destroyChunkMesh(it->second);
+                it = m_chunkMeshes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    // Get the nearest dirty chunks within budget
+    world->getDirtyChunks(viewerPosition, maxChunks, m_dirtyChunks);
+    
+    // Regenerate dirty sections on the world's workers (clears the dirty masks)
+    world->meshChunks(m_dirtyChunks, m_rebuiltSections);
+    
+    // Upload the rebuilt sections
+    for (size_t i = 0; i < m_dirtyChunks.size(); i++) {
+        createChunkMesh(m_dirtyChunks[i], m_rebuiltSections[i]);
+    }
+}
+
+// Upload the current meshes of loaded chunks without one, nearest first
+void VoxelRenderer::uploadChunkMeshes(World* world, const glm::vec3& viewerPosition) {
+    std::vector<std::pair<float, Chunk*>> chunks;
+    for (const auto& pair : world->getChunks()) {
+        if (m_chunkMeshes.find(pair.first) == m_chunkMeshes.end()) {
+            float dx = (pair.first.x + 0.5f) * CHUNK_SIZE - viewerPosition.x;
+            float dz = (pair.first.z + 0.5f) * CHUNK_SIZE - viewerPosition.z;
+            chunks.push_back(std::make_pair(dx * dx + dz * dz, pair.second));
+        }
+    }
+    
+    // Nearby meshes share the first pages, so batches stay roughly front to back
+    std::sort(chunks.begin(), chunks.end(),
+              [](const std::pair<float, Chunk*>& a, const std::pair<float, Chunk*>& b) { return a.first < b.first; });
+    
+    for (const auto& entry : chunks) {
+        createChunkMesh(entry.second, ALL_SECTIONS);
+    }
+}
+
+// Upload the meshes of the given chunk sections
+void VoxelRenderer::createChunkMesh(Chunk* chunk, uint32_t sections) {
+    PROFILE_ZONE("VoxelRenderer::createChunkMesh");
+    
+    // Get chunk position
+    ChunkPosition position = chunk->getPosition();
+    ChunkMeshData& meshData = m_chunkMeshes[position];
+    
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        if (!(sections & (1u << section))) {
+            continue;
+        }
+        
+        SectionMeshData& sectionData = meshData.sections[section];
+        
+        // Get vertices
+        const std::vector<ChunkVertex>& vertices = chunk->getSectionVertices(section);
+        
+        // The old mesh is replaced or dropped below (frames in flight may still read it)
+        m_meshHeap.free(sectionData.vertices);
+        s_meshBytes.add(-static_cast<double>(sectionData.vertices.size));
+        sectionData = SectionMeshData();
+        
+        // Nothing to draw if the section is now empty
+        if (vertices.empty()) {
+            continue;
+        }
+        
+        // Allocate a vertex range, creating the buffer of a new page
+        size_t bytes = vertices.size() * sizeof(ChunkVertex);
+        MeshAllocation allocation = m_meshHeap.allocate(static_cast<uint32_t>(bytes));
+        while (m_pageBuffers.size() < m_meshHeap.getPageCount()) {
+            uint32_t page = static_cast<uint32_t>(m_pageBuffers.size());
+            m_pageBuffers.push_back(m_backend->createBuffer(nullptr, m_meshHeap.getPageSize(page)));
+        }
+        if (!m_pageBuffers[allocation.page]) {
+            m_meshHeap.free(allocation);
+            continue;
+        }
+        
+        // Upload vertices into the range
+        m_backend->updateBuffer(m_pageBuffers[allocation.page], allocation.offset, vertices.data(), bytes);
+        sectionData.vertices = allocation;
+        sectionData.indexCount = chunk->getQuadCount(section) * 6;
+        
+        s_uploadedBytes.add(bytes);
+        s_uploadedVertices.add(vertices.size());
+        s_meshBytes.add(static_cast<double>(allocation.size));
+    }
+}
+
+// Free the vertex ranges of a chunk mesh
+void VoxelRenderer::destroyChunkMesh(ChunkMeshData& meshData) {
+    for (SectionMeshData& sectionData : meshData.sections) {
+        m_meshHeap.free(sectionData.vertices);
+        s_meshBytes.add(-static_cast<double>(sectionData.vertices.size));
+        sectionData = SectionMeshData();
+    }
+}
+
+// Render chunk
+void VoxelRenderer::renderChunk(const ChunkPosition& position, uint32_t sections, DrawUniforms& uniforms) {
+    // Check if mesh exists
+    auto it = m_chunkMeshes.find(position);
+    if (it == m_chunkMeshes.end()) {
+        return;
+    }
+    
+    // Get mesh data
+    const ChunkMeshData& meshData = it->second;
+    
+    // Calculate model matrix
+    uniforms.modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(position.x * CHUNK_SIZE, 0.0f, position.z * CHUNK_SIZE));
+    
+    // Set uniforms (shared by all sections of the chunk)
+    m_backend->setUniforms(uniforms);
+    
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        const SectionMeshData& sectionData = meshData.sections[section];
+        
+        // Skip culled and empty sections
+        if (!(sections & (1u << section)) || sectionData.indexCount == 0) {
+            continue;
+        }
+        
+        // Draw indexed primitives
+        m_backend->drawIndexed(m_pageBuffers[sectionData.vertices.page], sectionData.vertices.offset, m_quadIndexBuffer,
+                               sectionData.indexCount);
+    }
+}
+
+// Submit the draw list as one batch per mesh heap page
+void VoxelRenderer::submitBatches(const std::vector<ChunkDraw>& drawList, const Camera& camera) {
+    // One instance per chunk, draws bucketed by page (front to back within a page)
+    m_instances.clear();
+    m_pageDraws.resize(m_pageBuffers.size());
+    for (std::vector<DrawCommand>& draws : m_pageDraws) {
+        draws.clear();
+    }
+    
+    for (const ChunkDraw& draw : drawList) {
+        const ChunkPosition& position = draw.position;
+        auto it = m_chunkMeshes.find(position);
+        if (it == m_chunkMeshes.end()) {
+            continue;
+        }
+        
+        DrawCommand command;
+        command.instance = static_cast<uint32_t>(m_instances.size());
+        bool drawn = false;
+        
+        for (int section = 0; section < CHUNK_SECTIONS; section++) {
+            const SectionMeshData& sectionData = it->second.sections[section];
+            
+            // Skip culled and empty sections
+            if (!(draw.sections & (1u << section)) || sectionData.indexCount == 0) {
+                continue;
+            }
+            
+            command.indexCount = sectionData.indexCount;
+            command.baseVertex = sectionData.vertices.offset / sizeof(ChunkVertex);
+            m_pageDraws[sectionData.vertices.page].push_back(command);
+            drawn = true;
+        }
+        
+        if (drawn) {
+            DrawInstance instance;
+            instance.origin = glm::vec4(position.x * CHUNK_SIZE, 0.0f, position.z * CHUNK_SIZE, 0.0f);
+            m_instances.push_back(instance);
+        }
+    }
+    
+    s_drawBatches.set(0.0);
+    if (m_instances.empty()) {
+        return;
+    }
+    
+    // Grow the ring (frames in flight keep reading the old one)
+    if (m_instances.size() > m_instanceCapacity) {
+        m_backend->destroyBuffer(m_instanceRing);
+        m_instanceCapacity = std::max(std::max(m_instances.size(), m_instanceCapacity * 2), MIN_INSTANCE_CAPACITY);
+        m_instanceRing = m_backend->createBuffer(nullptr, m_instanceCapacity * sizeof(DrawInstance) * RenderBackend::MAX_FRAMES_IN_FLIGHT);
+        if (!m_instanceRing) {
+            m_instanceCapacity = 0;
+            return;
+        }
+    }
+    
+    // Write this frame's slot, the device finished reading it MAX_FRAMES_IN_FLIGHT frames ago
+    size_t slotOffset = (m_frameIndex % RenderBackend::MAX_FRAMES_IN_FLIGHT) * m_instanceCapacity * sizeof(DrawInstance);
+    m_backend->updateBuffer(m_instanceRing, slotOffset, m_instances.data(), m_instances.size() * sizeof(DrawInstance));
+    
+    FrameUniforms uniforms;
+    uniforms.viewMatrix = camera.getViewMatrix();
+    uniforms.projectionMatrix = camera.getProjectionMatrix();
+    m_backend->setFrameUniforms(uniforms);
+    m_backend->setInstanceBuffer(m_instanceRing, slotOffset);
+    
+    size_t batches = 0;
+    for (size_t page = 0; page < m_pageDraws.size(); page++) {
+        if (!m_pageDraws[page].empty()) {
+            m_backend->drawBatch(m_pageBuffers[page], m_quadIndexBuffer, m_pageDraws[page].data(), m_pageDraws[page].size());
+            batches++;
+        }
+    }
+    s_drawBatches.set(static_cast<double>(batches));
+}
+
+// Load texture atlas
+bool VoxelRenderer::loadTextureAtlas() {
+    // In a real implementation, we would load a texture atlas from a file
+    // For now, just create a simple texture with colors
+    
+    // Create texture data
+    std::vector<uint32_t> textureData(256 * 256);
+    
+    // Fill texture with colors
+    for (int y = 0; y < 256; y++) {
+        for (int x = 0; x < 256; x++) {
+            uint32_t color;
+            
+            // Grass block
+            if (x < 64 && y < 64) {
+                // Grass side
+                color = 0xFF7F5F3F; // Brown
+            } else if (x < 64 && y < 128) {
+                // Grass top
+                color = 0xFF00FF00; // Green
+            } else if (x < 128 && y < 64) {
+                // Dirt
+                color = 0xFF7F3F1F; // Dark brown
+            } else if (x < 128 && y < 128) {
+                // Stone
+                color = 0xFF7F7F7F; // Gray
+            } else if (x < 192 && y < 64) {
+                // Sand
+                color = 0xFFFFFF00; // Yellow
+            } else if (x < 192 && y < 128) {
+                // Water
+                color = 0x7F0000FF; // Semi-transparent blue
+            } else if (x < 256 && y < 64) {
+                // Wood
+                color = 0xFF7F3F00; // Brown
+            } else if (x < 256 && y < 128) {
+                // Leaves
+                color = 0x7F00FF00; // Semi-transparent green
+            } else if (x < 64 && y < 192) {
+                // Glowstone
+                color = 0xFF80E0FF; // Warm yellow
+            } else {
+                // Default
+                color = 0xFFFFFFFF; // White
+            }
+            
+            textureData[y * 256 + x] = color;
+        }
+    }
+    
+    // Upload texture data (the backend generates mipmaps)
+    m_textureAtlas = m_backend->createTexture(textureData.data(), 256, 256);
+    return m_textureAtlas != 0;
+}
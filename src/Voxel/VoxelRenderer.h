@@ -1,41 +1,133 @@
 #pragma once
 
 #include "World.h"
+#include "ChunkCuller.h"
 #include "../Camera.h"
+#include "../Renderer/MeshHeap.h"
+#include "../Renderer/RenderBackend.h"
 #include <unordered_map>
-
-// Forward declarations
-class Window;
+#include <vector>
 
 // Voxel renderer class
+//
+// Keeps chunk meshes uploaded and submits the visible chunk sections each
+// frame through a render backend (Metal in the game, recording when headless).
+// Section meshes are sub-allocated from a few large page buffers of a mesh
+// heap instead of one buffer each, and their ranges are reused only after the
+// frames in flight finished. By default draws are batched: chunk origins of a
+// frame are written into one slot of an instance ring buffer and sections are
+// drawn in one batch per page, without per-chunk uniform updates.
 class VoxelRenderer {
 public:
-    VoxelRenderer(Window* window);
+    VoxelRenderer(RenderBackend* backend);
     ~VoxelRenderer();
     
-    // Initialize the renderer
+    // Delete copy constructor and assignment operator
+    VoxelRenderer(const VoxelRenderer&) = delete;
+    VoxelRenderer& operator=(const VoxelRenderer&) = delete;
+    
+    // Initialize the backend and upload shared resources
     bool init();
     
-    // Render the world
+    // Render the world (prepareFrame, then submitFrame)
     void render(World* world, const Camera& camera);
     
-    // Update chunk meshes
-    void updateChunkMeshes(World* world);
+    // Cull and sort the visible chunk sections of the world for the next submitFrame
+    void prepareFrame(const World* world, const Camera& camera);
+    
+    // Submit the sections found by the last prepareFrame as one frame (does not read the world)
+    void submitFrame(const Camera& camera);
+    
+    // Submit the sections of a culled draw list as one frame
+    void submitDrawList(const std::vector<ChunkDraw>& drawList, const Camera& camera);
+    
+    // Submit batches per mesh heap page (default) or one draw per section with per-chunk uniforms
+    void setBatching(bool batching) { m_batching = batching; }
+    bool isBatching() const { return m_batching; }
+    
+    // Default number of chunks meshed per frame
+    static const size_t MESH_BUDGET_PER_FRAME = 8;
+    
+    // Update chunk meshes, nearest dirty chunks first, at most maxChunks per call
+    void updateChunkMeshes(World* world, const glm::vec3& viewerPosition, size_t maxChunks = MESH_BUDGET_PER_FRAME);
     
+    // Upload the current meshes of loaded chunks without one, nearest first (for a renderer created after meshing)
+    void uploadChunkMeshes(World* world, const glm::vec3& viewerPosition);
+    
+    // Get number of chunks meshed by the last updateChunkMeshes
+    size_t getMeshedChunkCount() const { return m_dirtyChunks.size(); }
+    
+    // Get the heap chunk meshes are allocated from
+    const MeshHeap& getMeshHeap() const { return m_meshHeap; }
+
 private:
-    // Window reference
-    Window* m_window;
+    // Section mesh data (indices come from the shared quad index buffer)
+    struct SectionMeshData {
+        MeshAllocation vertices;
+        uint32_t indexCount;
+    };
+    
+    // Chunk mesh data
+    struct ChunkMeshData {
+        SectionMeshData sections[CHUNK_SECTIONS];
+    };
+    
+    // Backend the renderer draws with (not owned)
+    RenderBackend* m_backend;
+    
+    // Quad index pattern shared by every chunk mesh
+    RenderHandle m_quadIndexBuffer;
+    
+    // Block texture atlas
+    RenderHandle m_textureAtlas;
+    
+    // Vertex ranges of chunk meshes
+    MeshHeap m_meshHeap;
+    
+    // Backend buffer of each mesh heap page
+    std::vector<RenderHandle> m_pageBuffers;
+    
+    // Whether draws are batched
+    bool m_batching;
+    
+    // Instance ring with MAX_FRAMES_IN_FLIGHT slots of m_instanceCapacity instances
+    RenderHandle m_instanceRing;
+    size_t m_instanceCapacity;
+    
+    // Frames submitted so far, selects the ring slot
+    uint64_t m_frameIndex;
+    
+    // Instances and draws per page of the frame being batched
+    std::vector<DrawInstance> m_instances;
+    std::vector<std::vector<DrawCommand>> m_pageDraws;
+    
+    // Chunk meshes
+    std::unordered_map<ChunkPosition, ChunkMeshData, ChunkPosition::Hash> m_chunkMeshes;
+    
+    // Dirty chunks taken from the world each frame
+    std::vector<Chunk*> m_dirtyChunks;
+    
+    // Sections rebuilt per dirty chunk
+    std::vector<uint32_t> m_rebuiltSections;
+    
+    // Chunk sections passing culling this frame
+    std::vector<ChunkDraw> m_drawList;
+    
+    // World unload count when meshes of unloaded chunks were last dropped
+    uint64_t m_unloadedChunkCount;
+    
+    // Upload the meshes of the given chunk sections
+    void createChunkMesh(Chunk* chunk, uint32_t sections);
     
-    // Implementation details are hidden in the .mm file
-    struct Impl;
-    Impl* m_impl;
+    // Free the vertex ranges of a chunk mesh
+    void destroyChunkMesh(ChunkMeshData& meshData);
     
-    // Create chunk mesh
-    void createChunkMesh(Chunk* chunk);
+    // Render the given sections of a chunk
+    void renderChunk(const ChunkPosition& position, uint32_t sections, DrawUniforms& uniforms);
     
-    // Render chunk
-    void renderChunk(Chunk* chunk, const Camera& camera);
+    // Submit the draw list as one batch per mesh heap page
+    void submitBatches(const std::vector<ChunkDraw>& drawList, const Camera& camera);
     
     // Load texture atlas
     bool loadTextureAtlas();
-}; 
\ No newline at end of file
+};
@@ -1,16 +1,63 @@
 #include "World.h"
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <unordered_set>
+
+// Metrics reported by all worlds
+static MetricCounter& s_chunksGenerated = Metrics::counter("tomicz_chunks_generated_total", "Chunks generated");
+static MetricCounter& s_chunksUnloaded = Metrics::counter("tomicz_chunks_unloaded_total", "Chunks unloaded");
+static MetricGauge& s_chunksLoaded = Metrics::gauge("tomicz_chunks_loaded", "Chunks resident in memory");
+static MetricGauge& s_dirtyQueueDepth = Metrics::gauge("tomicz_dirty_queue_depth", "Chunks waiting to be meshed");
+static MetricCounter& s_chunksCancelled = Metrics::counter("tomicz_chunks_cancelled_total", "Chunk generations dropped after leaving the range");
+static MetricGauge& s_chunksPending = Metrics::gauge("tomicz_chunks_pending", "Chunks being generated on workers");
+static MetricCounter& s_chunksRestored = Metrics::counter("tomicz_chunks_restored_total", "Chunks restored from snapshots instead of generated");
+static MetricCounter& s_prefetchHits = Metrics::counter("tomicz_chunks_prefetch_hits_total", "Chunks that came into range already prefetched");
+static MetricGauge& s_chunksPrefetched = Metrics::gauge("tomicz_chunks_prefetched", "Prefetched chunks waiting to come into range");
+static MetricHistogram& s_forwardChunkLatency = Metrics::histogram("tomicz_forward_chunk_latency_seconds",
+    "Time from entering the range to joining the world for chunks ahead of the viewer", Metrics::exponentialBuckets(0.001, 2.0, 12));
+static MetricHistogram& s_generationSeconds = Metrics::histogram("tomicz_chunk_generation_seconds",
+    "Time to generate the terrain of a chunk", Metrics::exponentialBuckets(0.0005, 2.0, 10));
+
+constexpr float World::VIEW_DIRECTION_WEIGHT;
+const size_t World::MAX_PREFETCHED_CHUNKS;
 
 // Constructor
-World::World() {
+World::World()
+    : m_scheduler(nullptr),
+      m_playerChunk({0, 0}),
+      m_unloadDistance(0),
+      m_viewerPosition(0.0f),
+      m_viewDirection(0.0f),
+      m_generatedChunkCount(0),
+      m_restoredChunkCount(0),
+      m_unloadedChunkCount(0),
+      m_prefetchHitCount(0) {
 }
 
 // Destructor
 World::~World() {
+    // Stop generation, running tasks still write their chunk
+    for (auto& pair : m_pendingChunks) {
+        pair.second.task.cancel();
+    }
+    for (auto& pair : m_pendingChunks) {
+        m_scheduler->wait(pair.second.task);
+        delete pair.second.chunk;
+    }
+    for (auto& pair : m_prefetchedChunks) {
+        delete pair.second;
+    }
+    
     // Delete all chunks
     for (auto& pair : m_chunks) {
         delete pair.second;
     }
+    s_chunksLoaded.add(-static_cast<double>(m_chunks.size()));
     m_chunks.clear();
 }
 
@@ -28,6 +75,12 @@ Chunk* World::getChunk(int x, int z) {
     return createChunk(x, z);
 }
 
+// Get chunk at position if it is loaded
+Chunk* World::findChunk(int x, int z) const {
+    auto it = m_chunks.find({x, z});
+    return it != m_chunks.end() ? it->second : nullptr;
+}
+
 // Get block at world position
 BlockType World::getBlock(int x, int y, int z) {
     // Convert world position to chunk position
@@ -52,58 +105,529 @@ void World::setBlock(int x, int y, int z, BlockType type) {
     ChunkPosition chunkPos = worldToChunkPosition(x, z);
     Chunk* chunk = getChunk(chunkPos.x, chunkPos.z);
     
+    // Ignore positions above or below the world
+    if (!chunk->isValidPosition(localX, localY, localZ)) {
+        return;
+    }
+    
     // Set block
+    BlockType oldType = chunk->getBlock(localX, localY, localZ);
     chunk->setBlock(localX, localY, localZ, type);
     
-    // Mark neighboring chunks as dirty if the block is on the edge
-    if (localX == 0) {
-        Chunk* neighbor = getChunk(chunkPos.x - 1, chunkPos.z);
-        neighbor->setDirty(true);
-    } else if (localX == CHUNK_SIZE - 1) {
-        Chunk* neighbor = getChunk(chunkPos.x + 1, chunkPos.z);
-        neighbor->setDirty(true);
+    // Mark the touching sections of neighboring chunks as dirty if the block is on the edge
+    chunk->markBlockDirty(localX, localY, localZ);
+    
+    // Relight around the changed block
+    m_lightEngine.updateBlock(chunk, localX, localY, localZ, oldType, type);
+}
+
+// Find the first solid block along a ray
+RaycastHit World::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+    ChunkPosition chunkPos = worldToChunkPosition(static_cast<int>(std::floor(origin.x)), static_cast<int>(std::floor(origin.z)));
+    return castRay(findChunk(chunkPos.x, chunkPos.z), origin, direction, maxDistance);
+}
+
+// Cast many rays
+void World::raycast(const Ray* rays, size_t count, RaycastHit* hits) const {
+    // Rays from the same chunk share one map lookup
+    ChunkPosition lastPos = {0, 0};
+    const Chunk* lastChunk = nullptr;
+    bool haveLast = false;
+    
+    for (size_t i = 0; i < count; i++) {
+        const Ray& ray = rays[i];
+        ChunkPosition chunkPos = worldToChunkPosition(static_cast<int>(std::floor(ray.origin.x)), static_cast<int>(std::floor(ray.origin.z)));
+        
+        if (!haveLast || !(chunkPos == lastPos)) {
+            lastPos = chunkPos;
+            lastChunk = findChunk(chunkPos.x, chunkPos.z);
+            haveLast = true;
+        }
+        
+        hits[i] = castRay(lastChunk, ray.origin, ray.direction, ray.maxDistance);
     }
+}
+
+// Walk a ray through the blocks of loaded chunks starting in chunk
+RaycastHit World::castRay(const Chunk* chunk, const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+    // Blocks a ray stops at, built once from Block properties
+    static const struct PickTable {
+        bool solid[static_cast<int>(BlockType::Count)];
+        
+        PickTable() {
+            for (int type = 0; type < static_cast<int>(BlockType::Count); type++) {
+                solid[type] = Block::isSolid(static_cast<BlockType>(type));
+            }
+        }
+    } pickTable;
+    
+    RaycastHit result;
+    result.hit = false;
+    result.block = glm::ivec3(0);
+    result.face = BlockFace::Count;
+    result.type = BlockType::Air;
+    result.distance = maxDistance;
+    
+    float length = glm::length(direction);
+    if (length <= 0.0f) {
+        return result;
+    }
+    glm::vec3 dir = direction / length;
+    
+    // Current block and the chunk holding it
+    glm::ivec3 block(static_cast<int>(std::floor(origin.x)),
+                     static_cast<int>(std::floor(origin.y)),
+                     static_cast<int>(std::floor(origin.z)));
+    ChunkPosition chunkPos = worldToChunkPosition(block.x, block.z);
+    int localX = block.x - chunkPos.x * CHUNK_SIZE;
+    int localZ = block.z - chunkPos.z * CHUNK_SIZE;
     
-    if (localZ == 0) {
-        Chunk* neighbor = getChunk(chunkPos.x, chunkPos.z - 1);
-        neighbor->setDirty(true);
-    } else if (localZ == CHUNK_SIZE - 1) {
-        Chunk* neighbor = getChunk(chunkPos.x, chunkPos.z + 1);
-        neighbor->setDirty(true);
+    // Amanatides-Woo traversal: distance to the next boundary and between boundaries per axis
+    int step[3];
+    float tMax[3];
+    float tDelta[3];
+    for (int axis = 0; axis < 3; axis++) {
+        if (dir[axis] > 0.0f) {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / dir[axis];
+            tMax[axis] = (block[axis] + 1.0f - origin[axis]) * tDelta[axis];
+        } else if (dir[axis] < 0.0f) {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / dir[axis];
+            tMax[axis] = (origin[axis] - block[axis]) * tDelta[axis];
+        } else {
+            step[axis] = 0;
+            tDelta[axis] = std::numeric_limits<float>::infinity();
+            tMax[axis] = std::numeric_limits<float>::infinity();
+        }
     }
+    
+    // Face entered when stepping along each axis in the ray's direction
+    const BlockFace enterFace[3] = {
+        step[0] > 0 ? BlockFace::Left : BlockFace::Right,
+        step[1] > 0 ? BlockFace::Bottom : BlockFace::Top,
+        step[2] > 0 ? BlockFace::Back : BlockFace::Front
+    };
+    
+    BlockFace face = BlockFace::Count;
+    float distance = 0.0f;
+    
+    while (chunk && distance <= maxDistance) {
+        // Below the world nothing can be hit, above it is open air
+        if (block.y < 0 && step[1] <= 0) {
+            break;
+        }
+        if (block.y >= CHUNK_HEIGHT && step[1] >= 0) {
+            break;
+        }
+        
+        if (block.y >= 0 && block.y < CHUNK_HEIGHT) {
+            BlockType type = chunk->getBlockUnchecked(localX, block.y, localZ);
+            
+            if (pickTable.solid[static_cast<int>(type)]) {
+                result.hit = true;
+                result.block = block;
+                result.face = face;
+                result.type = type;
+                result.distance = distance;
+                return result;
+            }
+        }
+        
+        // Step to the nearest boundary
+        int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        distance = tMax[axis];
+        tMax[axis] += tDelta[axis];
+        block[axis] += step[axis];
+        face = enterFace[axis];
+        
+        // Follow neighbor links across chunk borders
+        if (axis == 0) {
+            localX += step[0];
+            if (localX < 0) {
+                chunk = chunk->getNeighbor(BlockFace::Left);
+                localX += CHUNK_SIZE;
+            } else if (localX >= CHUNK_SIZE) {
+                chunk = chunk->getNeighbor(BlockFace::Right);
+                localX -= CHUNK_SIZE;
+            }
+        } else if (axis == 2) {
+            localZ += step[2];
+            if (localZ < 0) {
+                chunk = chunk->getNeighbor(BlockFace::Back);
+                localZ += CHUNK_SIZE;
+            } else if (localZ >= CHUNK_SIZE) {
+                chunk = chunk->getNeighbor(BlockFace::Front);
+                localZ -= CHUNK_SIZE;
+            }
+        }
+    }
+    
+    return result;
 }
 
 // Update chunks around player
-void World::updateChunks(const glm::vec3& playerPosition, int renderDistance) {
+void World::updateChunks(const glm::vec3& playerPosition, int renderDistance, const glm::vec3& viewDirection) {
+    PROFILE_ZONE("World::updateChunks");
+    
     // Convert player position to chunk position
     int playerChunkX = static_cast<int>(std::floor(playerPosition.x / CHUNK_SIZE));
     int playerChunkZ = static_cast<int>(std::floor(playerPosition.z / CHUNK_SIZE));
+    int unloadDistance = renderDistance + UNLOAD_MARGIN;
+    
+    m_viewerPosition = playerPosition;
+    m_viewDirection = viewDirection;
+    m_playerChunk = {playerChunkX, playerChunkZ};
+    m_unloadDistance = unloadDistance;
     
-    // Load chunks within render distance
+    // Drop generation of chunks that left the range, queued tasks never run (prefetchChunks manages its own)
+    for (auto it = m_pendingChunks.begin(); it != m_pendingChunks.end();) {
+        const ChunkPosition& position = it->first;
+        
+        // Prefetches that came into render distance are treated like range requests from now on
+        if (it->second.prefetch && std::abs(position.x - playerChunkX) <= renderDistance && std::abs(position.z - playerChunkZ) <= renderDistance) {
+            it->second.prefetch = false;
+        }
+        
+        if (!it->second.prefetch && isOutOfRange(position)) {
+            it->second.task.cancel();
+            
+            // Running tasks are dropped once they finish
+            if (it->second.task.isCancelled()) {
+                delete it->second.chunk;
+                it = m_pendingChunks.erase(it);
+                s_chunksCancelled.add();
+                continue;
+            }
+        }
+        ++it;
+    }
+    
+    // Add chunks whose terrain is ready
+    addFinishedChunks(playerChunkX, playerChunkZ, unloadDistance);
+    
+    // Find missing chunks within render distance, most wanted first
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    m_missingChunks.clear();
     for (int z = -renderDistance; z <= renderDistance; z++) {
         for (int x = -renderDistance; x <= renderDistance; x++) {
-            int chunkX = playerChunkX + x;
-            int chunkZ = playerChunkZ + z;
-            
-            // Get or create chunk
-            getChunk(chunkX, chunkZ);
+            ChunkPosition position = {playerChunkX + x, playerChunkZ + z};
+            if (m_chunks.find(position) == m_chunks.end() && m_pendingChunks.find(position) == m_pendingChunks.end() &&
+                !addPrefetchedChunk(position)) {
+                m_missingChunks.push_back(std::make_pair(getChunkPriority(position), position));
+            }
         }
     }
+    std::sort(m_missingChunks.begin(), m_missingChunks.end(), [](const std::pair<float, ChunkPosition>& a, const std::pair<float, ChunkPosition>& b) {
+        return a.first < b.first;
+    });
     
-    // TODO: Unload chunks outside render distance
+    // Generate on the workers, a few chunks per worker at a time so each tick picks the most wanted ones again
+    size_t maxPending = 0;
+    size_t pendingCount = 0;
+    if (m_scheduler) {
+        maxPending = static_cast<size_t>(std::max(m_scheduler->getWorkerCount() * PENDING_CHUNKS_PER_WORKER, static_cast<int>(MIN_PENDING_CHUNKS)));
+        for (const auto& pair : m_pendingChunks) {
+            pendingCount += pair.second.prefetch ? 0 : 1;
+        }
+    }
+    for (const std::pair<float, ChunkPosition>& missing : m_missingChunks) {
+        const ChunkPosition& position = missing.second;
+        if (m_scheduler && pendingCount >= maxPending) {
+            break;
+        }
+        
+        PendingChunk pending;
+        pending.chunk = new Chunk(position.x, position.z);
+        pending.requestTime = now;
+        pending.forward = isForward(position);
+        pending.prefetch = false;
+        
+        if (!m_scheduler) {
+            // Without workers everything in range is generated right away
+            generateChunkTerrain(pending.chunk);
+            addPendingChunk(pending);
+            continue;
+        }
+        
+        // Terrain only touches its own chunk, so it is generated before the chunk joins the world
+        Chunk* chunk = pending.chunk;
+        pending.task = m_scheduler->submit([this, chunk]() {
+            generateChunkTerrain(chunk);
+        }, TaskPriority::Normal);
+        m_pendingChunks[position] = pending;
+        pendingCount++;
+    }
+    
+    // Unload chunks outside render distance
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        const ChunkPosition& position = it->first;
+        
+        if (std::abs(position.x - playerChunkX) > unloadDistance || std::abs(position.z - playerChunkZ) > unloadDistance) {
+            unloadChunk(it->second);
+            it = m_chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    s_dirtyQueueDepth.set(static_cast<double>(m_dirtyQueue.size()));
+    s_chunksPending.set(static_cast<double>(m_pendingChunks.size()));
 }
 
-// Get dirty chunks (need mesh update)
-std::vector<Chunk*> World::getDirtyChunks() {
-    std::vector<Chunk*> dirtyChunks;
+// Generate chunks beyond the range ahead of time
+void World::prefetchChunks(const std::vector<ChunkPosition>& positions) {
+    PROFILE_ZONE("World::prefetchChunks");
     
-    for (auto& pair : m_chunks) {
-        if (pair.second->isDirty()) {
-            dirtyChunks.push_back(pair.second);
+    if (!m_scheduler) {
+        return;
+    }
+    
+    // Cancel queued prefetches that are no longer wanted, running ones finish and wait outside the world
+    std::unordered_set<ChunkPosition, ChunkPosition::Hash> wanted(positions.begin(), positions.end());
+    size_t prefetchCount = 0;
+    for (auto it = m_pendingChunks.begin(); it != m_pendingChunks.end();) {
+        if (it->second.prefetch && wanted.find(it->first) == wanted.end()) {
+            it->second.task.cancel();
+            if (it->second.task.isCancelled()) {
+                delete it->second.chunk;
+                it = m_pendingChunks.erase(it);
+                s_chunksCancelled.add();
+                continue;
+            }
         }
+        prefetchCount += it->second.prefetch ? 1 : 0;
+        ++it;
     }
     
-    return dirtyChunks;
+    // Request the rest in order, below the chunks in range and as many at a time as range requests
+    size_t maxPending = static_cast<size_t>(std::max(m_scheduler->getWorkerCount() * PENDING_CHUNKS_PER_WORKER, static_cast<int>(MIN_PENDING_CHUNKS)));
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    int renderDistance = m_unloadDistance - UNLOAD_MARGIN;
+    for (const ChunkPosition& position : positions) {
+        if (prefetchCount >= maxPending) {
+            break;
+        }
+        
+        // Chunks within render distance are requested by updateChunks
+        bool inRange = std::abs(position.x - m_playerChunk.x) <= renderDistance && std::abs(position.z - m_playerChunk.z) <= renderDistance;
+        if (inRange || m_chunks.find(position) != m_chunks.end() ||
+            m_pendingChunks.find(position) != m_pendingChunks.end() || m_prefetchedChunks.find(position) != m_prefetchedChunks.end()) {
+            continue;
+        }
+        
+        PendingChunk pending;
+        pending.chunk = new Chunk(position.x, position.z);
+        pending.requestTime = now;
+        pending.forward = false;
+        pending.prefetch = true;
+        
+        Chunk* chunk = pending.chunk;
+        pending.task = m_scheduler->submit([this, chunk]() {
+            generateChunkTerrain(chunk);
+        }, TaskPriority::Low);
+        m_pendingChunks[position] = pending;
+        prefetchCount++;
+    }
+    
+    // Keep the prefetched chunks nearest to the player
+    if (m_prefetchedChunks.size() > MAX_PREFETCHED_CHUNKS) {
+        std::vector<std::pair<int, ChunkPosition>> byDistance;
+        for (const auto& pair : m_prefetchedChunks) {
+            int distance = std::max(std::abs(pair.first.x - m_playerChunk.x), std::abs(pair.first.z - m_playerChunk.z));
+            byDistance.push_back(std::make_pair(distance, pair.first));
+        }
+        std::nth_element(byDistance.begin(), byDistance.begin() + MAX_PREFETCHED_CHUNKS, byDistance.end(),
+                         [](const std::pair<int, ChunkPosition>& a, const std::pair<int, ChunkPosition>& b) { return a.first < b.first; });
+        for (size_t i = MAX_PREFETCHED_CHUNKS; i < byDistance.size(); i++) {
+            auto it = m_prefetchedChunks.find(byDistance[i].second);
+            delete it->second;
+            m_prefetchedChunks.erase(it);
+        }
+    }
+    
+    s_chunksPending.set(static_cast<double>(m_pendingChunks.size()));
+    s_chunksPrefetched.set(static_cast<double>(m_prefetchedChunks.size()));
+}
+
+// Load every chunk within renderDistance
+void World::loadChunks(const glm::vec3& playerPosition, int renderDistance) {
+    // Each update harvests the finished chunks and requests the next ones
+    while (true) {
+        updateChunks(playerPosition, renderDistance, m_viewDirection);
+        if (m_pendingChunks.empty()) {
+            break;
+        }
+        
+        for (auto& pair : m_pendingChunks) {
+            m_scheduler->wait(pair.second.task);
+        }
+    }
+}
+
+// Add pending chunks whose generation finished, dropping those beyond unloadDistance
+void World::addFinishedChunks(int playerChunkX, int playerChunkZ, int unloadDistance) {
+    for (auto it = m_pendingChunks.begin(); it != m_pendingChunks.end();) {
+        const ChunkPosition& position = it->first;
+        PendingChunk& pending = it->second;
+        
+        if (!pending.task.isFinished()) {
+            ++it;
+            continue;
+        }
+        
+        bool outOfRange = std::abs(position.x - playerChunkX) > unloadDistance || std::abs(position.z - playerChunkZ) > unloadDistance;
+        
+        // Chunks can also have been created directly by getChunk meanwhile
+        if (!pending.task.isCancelled() && pending.prefetch && outOfRange && m_chunks.find(position) == m_chunks.end()) {
+            m_prefetchedChunks[position] = pending.chunk;
+        } else if (pending.task.isCancelled() || outOfRange || m_chunks.find(position) != m_chunks.end()) {
+            delete pending.chunk;
+            s_chunksCancelled.add();
+        } else {
+            addPendingChunk(pending);
+        }
+        it = m_pendingChunks.erase(it);
+    }
+}
+
+// Add a generated pending chunk to the world and record its latency
+void World::addPendingChunk(const PendingChunk& pending) {
+    addChunk(pending.chunk);
+    
+    if (pending.forward) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - pending.requestTime).count();
+        m_forwardChunkLatency.add(seconds * 1000.0);
+        s_forwardChunkLatency.observe(seconds);
+    }
+}
+
+// Add a prefetched chunk to the world
+bool World::addPrefetchedChunk(const ChunkPosition& position) {
+    auto it = m_prefetchedChunks.find(position);
+    if (it == m_prefetchedChunks.end()) {
+        return false;
+    }
+    
+    Chunk* chunk = it->second;
+    m_prefetchedChunks.erase(it);
+    addChunk(chunk);
+    
+    // Ready the moment it came into range
+    if (isForward(position)) {
+        m_forwardChunkLatency.add(0.0);
+        s_forwardChunkLatency.observe(0.0);
+    }
+    m_prefetchHitCount++;
+    s_prefetchHits.add();
+    s_chunksPrefetched.set(static_cast<double>(m_prefetchedChunks.size()));
+    return true;
+}
+
+// Get generation and meshing priority of a chunk (lower is sooner)
+float World::getChunkPriority(const ChunkPosition& position) const {
+    float dx = (position.x + 0.5f) * CHUNK_SIZE - m_viewerPosition.x;
+    float dz = (position.z + 0.5f) * CHUNK_SIZE - m_viewerPosition.z;
+    float distance = std::sqrt(dx * dx + dz * dz);
+    
+    // Chunks behind the viewer count as further away
+    float directionLength = std::sqrt(m_viewDirection.x * m_viewDirection.x + m_viewDirection.z * m_viewDirection.z);
+    if (directionLength < 1e-4f || distance < 1e-4f) {
+        return distance;
+    }
+    
+    float cosine = (dx * m_viewDirection.x + dz * m_viewDirection.z) / (distance * directionLength);
+    return distance * (1.0f + VIEW_DIRECTION_WEIGHT * 0.5f * (1.0f - cosine));
+}
+
+// Check if a chunk is ahead of the viewer, within 45 degrees of the view direction
+bool World::isForward(const ChunkPosition& position) const {
+    float dx = (position.x + 0.5f) * CHUNK_SIZE - m_viewerPosition.x;
+    float dz = (position.z + 0.5f) * CHUNK_SIZE - m_viewerPosition.z;
+    float dot = dx * m_viewDirection.x + dz * m_viewDirection.z;
+    float lengths = std::sqrt((dx * dx + dz * dz) * (m_viewDirection.x * m_viewDirection.x + m_viewDirection.z * m_viewDirection.z));
+    return lengths > 1e-4f && dot >= 0.7071f * lengths;
+}
+
+// Unlink and delete a chunk
+void World::unloadChunk(Chunk* chunk) {
+    static const BlockFace faces[4] = {BlockFace::Front, BlockFace::Back, BlockFace::Left, BlockFace::Right};
+    static const BlockFace opposite[4] = {BlockFace::Back, BlockFace::Front, BlockFace::Right, BlockFace::Left};
+    
+    for (int i = 0; i < 4; i++) {
+        Chunk* neighbor = chunk->getNeighbor(faces[i]);
+        if (neighbor) {
+            neighbor->setNeighbor(opposite[i], nullptr);
+        }
+    }
+    
+    if (chunk->isQueued()) {
+        m_dirtyQueue.erase(std::find(m_dirtyQueue.begin(), m_dirtyQueue.end(), chunk));
+    }
+    
+    delete chunk;
+    m_unloadedChunkCount++;
+    s_chunksUnloaded.add();
+    s_chunksLoaded.add(-1.0);
+}
+
+// Take dirty chunks out of the dirty queue, nearest first
+void World::getDirtyChunks(const glm::vec3& viewerPosition, size_t maxChunks, std::vector<Chunk*>& dirtyChunks) {
+    dirtyChunks.clear();
+    
+    if (m_dirtyQueue.empty() || maxChunks == 0) {
+        return;
+    }
+    
+    // Drop entries that were meshed outside the queue
+    for (size_t i = 0; i < m_dirtyQueue.size();) {
+        if (!m_dirtyQueue[i]->isDirty()) {
+            m_dirtyQueue[i]->clearQueued();
+            m_dirtyQueue[i] = m_dirtyQueue.back();
+            m_dirtyQueue.pop_back();
+        } else {
+            i++;
+        }
+    }
+    
+    // Distance weighted by the view direction of the last update
+    m_viewerPosition = viewerPosition;
+    auto nearer = [this](const Chunk* a, const Chunk* b) {
+        return getChunkPriority(a->getPosition()) < getChunkPriority(b->getPosition());
+    };
+    
+    // Only the chunks within budget need to be ordered
+    size_t count = std::min(maxChunks, m_dirtyQueue.size());
+    if (count < m_dirtyQueue.size()) {
+        std::nth_element(m_dirtyQueue.begin(), m_dirtyQueue.begin() + count, m_dirtyQueue.end(), nearer);
+    }
+    std::sort(m_dirtyQueue.begin(), m_dirtyQueue.begin() + count, nearer);
+    
+    // Move them out of the queue
+    dirtyChunks.assign(m_dirtyQueue.begin(), m_dirtyQueue.begin() + count);
+    m_dirtyQueue.erase(m_dirtyQueue.begin(), m_dirtyQueue.begin() + count);
+    
+    for (Chunk* chunk : dirtyChunks) {
+        chunk->clearQueued();
+    }
+    
+    s_dirtyQueueDepth.set(static_cast<double>(m_dirtyQueue.size()));
+}
+
+// Regenerate the meshes of chunks
+void World::meshChunks(const std::vector<Chunk*>& chunks, std::vector<uint32_t>& rebuiltSections) {
+    rebuiltSections.resize(chunks.size());
+    
+    // Meshing only reads blocks and light, each task writes the mesh of its own chunk
+    if (m_scheduler) {
+        m_scheduler->parallelFor(chunks.size(), 1, [&chunks, &rebuiltSections](size_t i) {
+            rebuiltSections[i] = chunks[i]->generateMesh();
+        }, TaskPriority::High);
+    } else {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            rebuiltSections[i] = chunks[i]->generateMesh();
+        }
+    }
 }
 
 // Convert world position to chunk position
@@ -118,25 +642,110 @@ ChunkPosition World::worldToChunkPosition(int x, int z) {
 void World::worldToLocalPosition(int worldX, int worldY, int worldZ, int& localX, int& localY, int& localZ) {
     ChunkPosition chunkPos = worldToChunkPosition(worldX, worldZ);
     
+    // Chunk position is floored, so this is already in [0, CHUNK_SIZE) for negative coordinates
     localX = worldX - chunkPos.x * CHUNK_SIZE;
     localY = worldY;
     localZ = worldZ - chunkPos.z * CHUNK_SIZE;
-    
-    // Handle negative coordinates
-    if (worldX < 0 && localX != 0) localX += CHUNK_SIZE;
-    if (worldZ < 0 && localZ != 0) localZ += CHUNK_SIZE;
 }
 
 // Create chunk at position
 Chunk* World::createChunk(int x, int z) {
+    // A prefetched chunk is already generated
     ChunkPosition position = {x, z};
+    if (addPrefetchedChunk(position)) {
+        return m_chunks[position];
+    }
     
-    // Create new chunk
+    // Generate terrain before the chunk joins the world
     Chunk* chunk = new Chunk(x, z);
-    m_chunks[position] = chunk;
+    generateChunkTerrain(chunk);
     
-    // Generate terrain
+    addChunk(chunk);
+    return chunk;
+}
+
+// Generate and light the terrain of a chunk that is not in the world yet
+void World::generateChunkTerrain(Chunk* chunk) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     chunk->generateTerrain();
+    s_generationSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
     
-    return chunk;
+    // Generation runs on worker threads, each with its own engine
+    static thread_local LightEngine lightEngine;
+    lightEngine.lightChunk(chunk);
+}
+
+// Add a generated chunk to the world
+void World::addChunk(Chunk* chunk) {
+    linkChunk(chunk);
+    chunk->setDirty(true);
+    
+    // The chunk is lit already, only its borders are left
+    m_lightEngine.linkChunk(chunk);
+    m_generatedChunkCount++;
+    
+    s_chunksGenerated.add();
+    s_chunksLoaded.add(1.0);
+    
+    // Faces along the shared borders of neighbors changed (the first four faces are horizontal)
+    for (int i = 0; i < 4; i++) {
+        Chunk* neighbor = chunk->getNeighbor(static_cast<BlockFace>(i));
+        if (neighbor) {
+            neighbor->setDirty(true);
+        }
+    }
+    
+    // Diagonal chunks sample the corner columns for ambient occlusion
+    const BlockFace sideFaces[2] = {BlockFace::Left, BlockFace::Right};
+    const BlockFace depthFaces[2] = {BlockFace::Back, BlockFace::Front};
+    for (BlockFace sideFace : sideFaces) {
+        for (BlockFace depthFace : depthFaces) {
+            Chunk* side = chunk->getNeighbor(sideFace);
+            Chunk* depth = chunk->getNeighbor(depthFace);
+            Chunk* diagonal = side ? side->getNeighbor(depthFace) : (depth ? depth->getNeighbor(sideFace) : nullptr);
+            if (diagonal) {
+                diagonal->setDirty(true);
+            }
+        }
+    }
+}
+
+// Add a chunk restored with its light (and meshes) from a snapshot
+void World::addRestoredChunk(Chunk* chunk) {
+    if (m_chunks.find(chunk->getPosition()) != m_chunks.end()) {
+        delete chunk;
+        return;
+    }
+    
+    // Light and meshes already account for the neighbors it was saved with
+    linkChunk(chunk);
+    if (chunk->isDirty()) {
+        chunk->setDirty(true);
+    }
+    m_restoredChunkCount++;
+    
+    s_chunksRestored.add();
+    s_chunksLoaded.add(1.0);
+}
+
+// Insert a chunk into the chunk map and link it with its loaded neighbors
+void World::linkChunk(Chunk* chunk) {
+    ChunkPosition position = chunk->getPosition();
+    m_chunks[position] = chunk;
+    
+    // Chunk queues itself for meshing whenever it becomes dirty
+    chunk->setDirtyQueue(&m_dirtyQueue);
+    
+    // Link loaded neighbors in both directions
+    static const BlockFace faces[4] = {BlockFace::Front, BlockFace::Back, BlockFace::Left, BlockFace::Right};
+    static const BlockFace opposite[4] = {BlockFace::Back, BlockFace::Front, BlockFace::Right, BlockFace::Left};
+    static const int offsets[4][2] = {{0, 1}, {0, -1}, {-1, 0}, {1, 0}};
+    
+    for (int i = 0; i < 4; i++) {
+        auto it = m_chunks.find({position.x + offsets[i][0], position.z + offsets[i][1]});
+        if (it != m_chunks.end()) {
+            chunk->setNeighbor(faces[i], it->second);
+            it->second->setNeighbor(opposite[i], chunk);
+        }
+    }
 } 
\ No newline at end of file
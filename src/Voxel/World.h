@@ -1,10 +1,32 @@
 #pragma once
 
 #include "Chunk.h"
+#include "LightEngine.h"
+#include "../Core/TaskScheduler.h"
+#include "../Core/TimingStats.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <unordered_map>
 #include <vector>
 #include <glm/glm.hpp>
 
+// Ray for voxel picking
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float maxDistance;
+};
+
+// Result of a voxel raycast
+struct RaycastHit {
+    bool hit;
+    glm::ivec3 block;   // World position of the hit block
+    BlockFace face;     // Face the ray entered through (Count if the ray started inside the block)
+    BlockType type;
+    float distance;     // Distance along the normalized direction
+};
+
 // World class
 class World {
 public:
@@ -14,20 +36,96 @@ public:
     // Get chunk at position
     Chunk* getChunk(int x, int z);
     
+    // Get chunk at position if it is loaded (never generates)
+    Chunk* findChunk(int x, int z) const;
+    
     // Get block at world position
     BlockType getBlock(int x, int y, int z);
     
     // Set block at world position
     void setBlock(int x, int y, int z, BlockType type);
     
-    // Update chunks around player
-    void updateChunks(const glm::vec3& playerPosition, int renderDistance);
+    // Find the first solid block along a ray within maxDistance (loaded chunks only)
+    RaycastHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+    
+    // Cast many rays, writing one hit per ray
+    void raycast(const Ray* rays, size_t count, RaycastHit* hits) const;
+    
+    // Set the scheduler used to generate chunks in parallel (nullptr to generate on the calling thread)
+    void setTaskScheduler(TaskScheduler* scheduler) { m_scheduler = scheduler; }
+    
+    // Update chunks around player, loading within renderDistance and unloading beyond it
+    //
+    // With a scheduler, missing chunks are generated on the workers and join the
+    // world in a later update. Chunks are requested nearest first, favoring those
+    // ahead along viewDirection; queued generation of chunks that left the range
+    // is cancelled.
+    void updateChunks(const glm::vec3& playerPosition, int renderDistance, const glm::vec3& viewDirection = glm::vec3(0.0f));
+    
+    // Load every chunk within renderDistance, waiting for generation to finish
+    void loadChunks(const glm::vec3& playerPosition, int renderDistance);
+    
+    // Add a chunk restored with its light (and meshes) from a snapshot, neither relighting nor remeshing it
+    //
+    // Restored chunks must come from a snapshot of the same world that was lit
+    // and meshed with the chunks around it, so only add them to an area without
+    // loaded chunks. Takes ownership; a chunk at a loaded position is deleted.
+    void addRestoredChunk(Chunk* chunk);
+    
+    // Generate chunks beyond the range of the last update ahead of time, in the given order
+    //
+    // Runs on the workers below range requests (no-op without a scheduler).
+    // positions replaces the previous request: queued chunks no longer in it
+    // are cancelled. Generated chunks wait outside the world and join it as
+    // soon as they come into range, without generation latency.
+    void prefetchChunks(const std::vector<ChunkPosition>& positions);
+    
+    // Extra chunks kept beyond the render distance before unloading (avoids reloading at the edge)
+    static const int UNLOAD_MARGIN = 1;
+    
+    // Chunks generated at once per worker (at least MIN_PENDING_CHUNKS), the rest wait for later updates
+    static const int PENDING_CHUNKS_PER_WORKER = 4;
+    static const int MIN_PENDING_CHUNKS = 8;
+    
+    // Generated chunks kept waiting to come into range, the furthest from the viewer are dropped beyond this
+    static const size_t MAX_PREFETCHED_CHUNKS = 256;
+    
+    // How much further away chunks behind the viewer count (0 = distance only)
+    static constexpr float VIEW_DIRECTION_WEIGHT = 2.0f;
+    
+    // Get number of chunks being generated
+    size_t getPendingChunkCount() const { return m_pendingChunks.size(); }
+    
+    // Get time (ms) from entering the range to joining the world of chunks that were ahead of the viewer
+    const TimingStats& getForwardChunkLatency() const { return m_forwardChunkLatency; }
+    
+    // Get number of chunks generated so far
+    uint64_t getGeneratedChunkCount() const { return m_generatedChunkCount; }
+    
+    // Get number of chunks restored from snapshots so far
+    uint64_t getRestoredChunkCount() const { return m_restoredChunkCount; }
+    
+    // Get number of prefetched chunks waiting to come into range
+    size_t getPrefetchedChunkCount() const { return m_prefetchedChunks.size(); }
+    
+    // Get number of chunks that came into range already prefetched
+    uint64_t getPrefetchHitCount() const { return m_prefetchHitCount; }
+    
+    // Get number of chunks unloaded so far (changes whenever chunk pointers become invalid)
+    uint64_t getUnloadedChunkCount() const { return m_unloadedChunkCount; }
     
     // Get all chunks
     const std::unordered_map<ChunkPosition, Chunk*, ChunkPosition::Hash>& getChunks() const { return m_chunks; }
     
-    // Get dirty chunks (need mesh update)
-    std::vector<Chunk*> getDirtyChunks();
+    // Take up to maxChunks dirty chunks (need mesh update) out of the dirty queue, nearest to viewerPosition first
+    // (weighted by the view direction of the last update)
+    void getDirtyChunks(const glm::vec3& viewerPosition, size_t maxChunks, std::vector<Chunk*>& dirtyChunks);
+    
+    // Regenerate the meshes of chunks (in parallel with a scheduler), writing the rebuilt section mask of each
+    void meshChunks(const std::vector<Chunk*>& chunks, std::vector<uint32_t>& rebuiltSections);
+    
+    // Get number of chunks waiting in the dirty queue
+    size_t getDirtyQueueSize() const { return m_dirtyQueue.size(); }
     
     // Convert world position to chunk position
     static ChunkPosition worldToChunkPosition(int x, int z);
@@ -39,6 +137,85 @@ private:
     // Chunks map
     std::unordered_map<ChunkPosition, Chunk*, ChunkPosition::Hash> m_chunks;
     
+    // Chunks that added themselves when becoming dirty
+    std::vector<Chunk*> m_dirtyQueue;
+    
+    // Sky and block light propagation
+    LightEngine m_lightEngine;
+    
+    // Worker threads for generation (not owned)
+    TaskScheduler* m_scheduler;
+    
+    // Chunk whose terrain is generated on a worker
+    struct PendingChunk {
+        Chunk* chunk;
+        TaskHandle task;
+        std::chrono::steady_clock::time_point requestTime;
+        bool forward;   // Ahead of the viewer when requested
+        bool prefetch;  // Requested beyond the range by prefetchChunks
+    };
+    
+    // Chunks being generated, not in m_chunks yet
+    std::unordered_map<ChunkPosition, PendingChunk, ChunkPosition::Hash> m_pendingChunks;
+    
+    // Missing chunk positions by priority, reused by updateChunks
+    std::vector<std::pair<float, ChunkPosition>> m_missingChunks;
+    
+    // Prefetched chunks generated before coming into range, not in m_chunks yet
+    std::unordered_map<ChunkPosition, Chunk*, ChunkPosition::Hash> m_prefetchedChunks;
+    
+    // Player chunk and unload distance of the last update
+    ChunkPosition m_playerChunk;
+    int m_unloadDistance;
+    
+    // Viewer of the last update, used to prioritize generation and meshing
+    glm::vec3 m_viewerPosition;
+    glm::vec3 m_viewDirection;
+    
+    // Latency of chunks requested ahead of the viewer
+    TimingStats m_forwardChunkLatency;
+    
+    // Chunk streaming counters
+    uint64_t m_generatedChunkCount;
+    uint64_t m_restoredChunkCount;
+    uint64_t m_unloadedChunkCount;
+    uint64_t m_prefetchHitCount;
+    
     // Create chunk at position
     Chunk* createChunk(int x, int z);
+    
+    // Generate and light the terrain of a chunk that is not in the world yet
+    void generateChunkTerrain(Chunk* chunk);
+    
+    // Add a generated chunk to the world: link neighbors, light it and queue meshing
+    void addChunk(Chunk* chunk);
+    
+    // Insert a chunk into the chunk map and link it with its loaded neighbors
+    void linkChunk(Chunk* chunk);
+    
+    // Add pending chunks whose generation finished, dropping those beyond unloadDistance of the player chunk
+    void addFinishedChunks(int playerChunkX, int playerChunkZ, int unloadDistance);
+    
+    // Add a generated pending chunk to the world and record its latency
+    void addPendingChunk(const PendingChunk& pending);
+    
+    // Add the prefetched chunk at position to the world if there is one, returns false if not
+    bool addPrefetchedChunk(const ChunkPosition& position);
+    
+    // Check if a chunk is beyond unloadDistance of the player chunk of the last update
+    bool isOutOfRange(const ChunkPosition& position) const {
+        return std::abs(position.x - m_playerChunk.x) > m_unloadDistance || std::abs(position.z - m_playerChunk.z) > m_unloadDistance;
+    }
+    
+    // Get generation and meshing priority of a chunk (lower is sooner)
+    float getChunkPriority(const ChunkPosition& position) const;
+    
+    // Check if a chunk is ahead of the viewer, within 45 degrees of the view direction
+    bool isForward(const ChunkPosition& position) const;
+    
+    // Unlink chunk from its neighbors and the dirty queue and delete it (caller removes it from the map)
+    void unloadChunk(Chunk* chunk);
+    
+    // Walk a ray through the blocks of loaded chunks starting in chunk
+    RaycastHit castRay(const Chunk* chunk, const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
 }; 
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "WorldMap.h"
+#include "TerrainGenerator.h"
+#include "World.h"
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
+#include "../Core/TaskScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+const int WorldMap::TILE_CHUNKS;
+const int WorldMap::TILE_SIZE;
+const size_t WorldMap::DEFAULT_MAX_TILES;
+
+static MetricCounter& s_tilesRendered = Metrics::counter("tomicz_map_tiles_rendered_total", "World map tiles rendered");
+static MetricCounter& s_tilesCached = Metrics::counter("tomicz_map_tiles_cached_total", "World map tiles reused from the cache");
+
+// Map colors by block type (red, green, blue)
+static const uint8_t BLOCK_COLORS[static_cast<size_t>(BlockType::Count)][3] = {
+    {24, 24, 32},       // Air (empty column)
+    {86, 160, 60},      // Grass
+    {134, 96, 67},      // Dirt
+    {128, 128, 128},    // Stone
+    {219, 207, 142},    // Sand
+    {52, 95, 218},      // Water
+    {102, 81, 51},      // Wood
+    {60, 120, 40},      // Leaves
+    {250, 220, 130},    // Glowstone
+};
+
+// Round down to a multiple of size and divide
+static int floorDiv(int value, int size) {
+    return value >= 0 ? value / size : -((-value + size - 1) / size);
+}
+
+// Constructor
+WorldMap::WorldMap(TaskScheduler* scheduler, size_t maxTiles)
+    : m_scheduler(scheduler),
+      m_maxTiles(maxTiles),
+      m_renderCount(0),
+      m_lastStats() {
+}
+
+// Render an area of chunks
+void WorldMap::render(const World* world, int minChunkX, int minChunkZ, int chunksX, int chunksZ, std::vector<uint32_t>& pixels) {
+    PROFILE_ZONE("WorldMap::render");
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_renderCount++;
+    WorldMapStats stats = WorldMapStats();
+
+    int firstTileX = floorDiv(minChunkX, TILE_CHUNKS);
+    int firstTileZ = floorDiv(minChunkZ, TILE_CHUNKS);
+    int lastTileX = floorDiv(minChunkX + chunksX - 1, TILE_CHUNKS);
+    int lastTileZ = floorDiv(minChunkZ + chunksZ - 1, TILE_CHUNKS);
+
+    // Find the loaded chunks of every tile and compare their edits with the cached tile
+    std::vector<TileJob> jobs;
+    for (int tileZ = firstTileZ; tileZ <= lastTileZ; tileZ++) {
+        for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+            TileJob job;
+            job.tile = {tileX, tileZ};
+            job.signature = 14695981039346656037ull;
+            job.columnsGenerated = 0;
+            job.columnsLoaded = 0;
+
+            for (int z = 0; z <= TILE_CHUNKS; z++) {
+                for (int x = 0; x <= TILE_CHUNKS; x++) {
+                    const Chunk* chunk = world ? world->findChunk(tileX * TILE_CHUNKS + x - 1, tileZ * TILE_CHUNKS + z - 1) : nullptr;
+                    job.chunks[z * (TILE_CHUNKS + 1) + x] = chunk;
+
+                    // Unedited chunks look like generated terrain, so only edits change the tile
+                    uint64_t edits = chunk ? chunk->getEditVersion() : 0;
+                    job.signature = (job.signature ^ edits) * 1099511628211ull;
+                }
+            }
+
+            stats.tiles++;
+            auto it = m_tiles.find(job.tile);
+            if (it != m_tiles.end() && it->second.signature == job.signature) {
+                it->second.lastUsed = m_renderCount;
+                continue;
+            }
+            jobs.push_back(job);
+        }
+    }
+
+    // Render changed tiles in parallel (map values keep their address while the map is not modified)
+    std::vector<uint32_t*> targets;
+    for (const TileJob& job : jobs) {
+        Tile& tile = m_tiles[job.tile];
+        tile.signature = job.signature;
+        tile.lastUsed = m_renderCount;
+        tile.pixels.resize(static_cast<size_t>(TILE_SIZE) * TILE_SIZE);
+        targets.push_back(tile.pixels.data());
+    }
+
+    auto renderJob = [&jobs, &targets](size_t i) {
+        renderTile(jobs[i], targets[i]);
+    };
+    if (m_scheduler) {
+        m_scheduler->parallelFor(jobs.size(), 1, renderJob);
+    } else {
+        for (size_t i = 0; i < jobs.size(); i++) {
+            renderJob(i);
+        }
+    }
+
+    for (const TileJob& job : jobs) {
+        stats.columnsGenerated += job.columnsGenerated;
+        stats.columnsLoaded += job.columnsLoaded;
+    }
+    stats.tilesRendered = static_cast<uint32_t>(jobs.size());
+
+    // Copy the covered part of every tile
+    int width = chunksX * CHUNK_SIZE;
+    int height = chunksZ * CHUNK_SIZE;
+    int originX = minChunkX * CHUNK_SIZE;
+    int originZ = minChunkZ * CHUNK_SIZE;
+    pixels.resize(static_cast<size_t>(width) * height);
+
+    for (int tileZ = firstTileZ; tileZ <= lastTileZ; tileZ++) {
+        for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+            const Tile& tile = m_tiles[ChunkPosition{tileX, tileZ}];
+            int beginX = std::max(tileX * TILE_SIZE, originX);
+            int endX = std::min((tileX + 1) * TILE_SIZE, originX + width);
+            int beginZ = std::max(tileZ * TILE_SIZE, originZ);
+            int endZ = std::min((tileZ + 1) * TILE_SIZE, originZ + height);
+
+            for (int z = beginZ; z < endZ; z++) {
+                const uint32_t* source = &tile.pixels[static_cast<size_t>(z - tileZ * TILE_SIZE) * TILE_SIZE + (beginX - tileX * TILE_SIZE)];
+                std::copy(source, source + (endX - beginX), &pixels[static_cast<size_t>(z - originZ) * width + (beginX - originX)]);
+            }
+        }
+    }
+
+    evictTiles();
+
+    s_tilesRendered.add(stats.tilesRendered);
+    s_tilesCached.add(stats.tiles - stats.tilesRendered);
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_lastStats = stats;
+}
+
+// Render the pixels of a tile
+void WorldMap::renderTile(TileJob& job, uint32_t* pixels) {
+    PROFILE_ZONE("WorldMap::renderTile");
+
+    // Heights and top blocks of the tile plus one column to the north and west (for slopes)
+    const int size = TILE_SIZE + 1;
+    std::vector<int> heights(static_cast<size_t>(size) * size);
+    std::vector<BlockType> tops(static_cast<size_t>(size) * size);
+    TerrainGenerator generator;
+
+    int originX = job.tile.x * TILE_SIZE - 1;
+    int originZ = job.tile.z * TILE_SIZE - 1;
+
+    for (int z = 0; z < size; z++) {
+        for (int x = 0; x < size; x++) {
+            int worldX = originX + x;
+            int worldZ = originZ + z;
+            int chunkX = floorDiv(worldX, CHUNK_SIZE);
+            int chunkZ = floorDiv(worldZ, CHUNK_SIZE);
+            const Chunk* chunk = job.chunks[(chunkZ - job.tile.z * TILE_CHUNKS + 1) * (TILE_CHUNKS + 1) + (chunkX - job.tile.x * TILE_CHUNKS + 1)];
+
+            int height = -1;
+            BlockType top = BlockType::Air;
+            if (chunk) {
+                // Highest non-air block of the loaded column
+                int localX = worldX - chunkX * CHUNK_SIZE;
+                int localZ = worldZ - chunkZ * CHUNK_SIZE;
+                for (int y = CHUNK_HEIGHT - 1; y >= 0; y--) {
+                    BlockType type = chunk->getBlockUnchecked(localX, y, localZ);
+                    if (type != BlockType::Air) {
+                        height = y;
+                        top = type;
+                        break;
+                    }
+                }
+                job.columnsLoaded++;
+            } else {
+                height = std::max(generator.getHeight(worldX, worldZ), -1);
+                top = height >= 0 ? TerrainGenerator::getBlockType(height, height) : BlockType::Air;
+                job.columnsGenerated++;
+            }
+
+            heights[z * size + x] = height;
+            tops[z * size + x] = top;
+        }
+    }
+
+    for (int z = 1; z < size; z++) {
+        for (int x = 1; x < size; x++) {
+            int height = heights[z * size + x];
+            const uint8_t* color = BLOCK_COLORS[static_cast<size_t>(tops[z * size + x])];
+
+            // Brighter when higher, lit from the north west
+            float shade = 1.0f;
+            if (height >= 0) {
+                int slope = height - std::max(heights[(z - 1) * size + (x - 1)], 0);
+                shade = (0.6f + 0.5f * height / CHUNK_HEIGHT) * (1.0f + std::min(std::max(slope * 0.08f, -0.35f), 0.35f));
+            }
+
+            uint32_t pixel = 0xFF000000;
+            for (int channel = 0; channel < 3; channel++) {
+                uint32_t value = static_cast<uint32_t>(std::min(color[channel] * shade, 255.0f));
+                pixel |= value << (channel * 8);
+            }
+            pixels[(z - 1) * TILE_SIZE + (x - 1)] = pixel;
+        }
+    }
+}
+
+// Drop least recently used tiles beyond the limit
+void WorldMap::evictTiles() {
+    if (m_tiles.size() <= m_maxTiles) {
+        return;
+    }
+
+    std::vector<std::pair<uint64_t, ChunkPosition>> candidates;
+    for (const auto& pair : m_tiles) {
+        if (pair.second.lastUsed != m_renderCount) {
+            candidates.push_back(std::make_pair(pair.second.lastUsed, pair.first));
+        }
+    }
+
+    size_t count = std::min(m_tiles.size() - m_maxTiles, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const std::pair<uint64_t, ChunkPosition>& a, const std::pair<uint64_t, ChunkPosition>& b) {
+                          return a.first < b.first;
+                      });
+    for (size_t i = 0; i < count; i++) {
+        m_tiles.erase(candidates[i].second);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Chunk.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+class TaskScheduler;
+class World;
+
+// World map counters of one render
+struct WorldMapStats {
+    uint32_t tiles;             // Tiles covering the area
+    uint32_t tilesRendered;     // Tiles missing from the cache or changed since cached
+    uint64_t columnsGenerated;  // Columns evaluated from terrain noise
+    uint64_t columnsLoaded;     // Columns read from loaded chunks
+    double ms;
+};
+
+// World map class
+//
+// Renders top-down maps at one pixel per block column: the color of the top
+// block, brightened with height and shaded by the slope towards the north
+// west. Columns of loaded chunks are read from their blocks, so edits show
+// up; all other columns come from TerrainGenerator heights without creating
+// chunks. The map is cut into tiles of TILE_CHUNKS x TILE_CHUNKS chunks on a
+// fixed grid. Missing tiles are rendered in parallel and cached, and a cached
+// tile is reused until a chunk in it or on its north and west border is
+// edited or an edited chunk is unloaded.
+class WorldMap {
+public:
+    // Chunks along each side of a tile
+    static const int TILE_CHUNKS = 8;
+
+    // Pixels along each side of a tile
+    static const int TILE_SIZE = TILE_CHUNKS * CHUNK_SIZE;
+
+    // Tiles kept by default (64 KB each)
+    static const size_t DEFAULT_MAX_TILES = 1024;
+
+    // Create a map rendering across the scheduler's workers if given, caching up to maxTiles tiles
+    explicit WorldMap(TaskScheduler* scheduler = nullptr, size_t maxTiles = DEFAULT_MAX_TILES);
+
+    // Render chunks [minChunkX, minChunkX + chunksX) x [minChunkZ, minChunkZ + chunksZ) as
+    // chunksX * CHUNK_SIZE pixels wide RGBA8 rows (R in the lowest byte, x east, rows south),
+    // reading the loaded chunks of world if given
+    void render(const World* world, int minChunkX, int minChunkZ, int chunksX, int chunksZ, std::vector<uint32_t>& pixels);
+
+    // Drop all cached tiles
+    void clear() { m_tiles.clear(); }
+
+    // Get number of cached tiles
+    size_t getCachedTileCount() const { return m_tiles.size(); }
+
+    // Get counters of the last render
+    const WorldMapStats& getLastStats() const { return m_lastStats; }
+
+private:
+    // Cached tile
+    struct Tile {
+        uint64_t signature;             // Edit versions of the chunks it was rendered from
+        uint64_t lastUsed;              // Render that last used the tile
+        std::vector<uint32_t> pixels;   // TILE_SIZE * TILE_SIZE
+    };
+
+    // Tile to render, with the loaded chunks it reads
+    struct TileJob {
+        ChunkPosition tile;
+        uint64_t signature;
+        const Chunk* chunks[(TILE_CHUNKS + 1) * (TILE_CHUNKS + 1)];   // Starting one chunk north west of the tile
+        uint64_t columnsGenerated;
+        uint64_t columnsLoaded;
+    };
+
+    // Workers rendering tiles (not owned, may be nullptr)
+    TaskScheduler* m_scheduler;
+
+    // Cached tiles by tile position
+    std::unordered_map<ChunkPosition, Tile, ChunkPosition::Hash> m_tiles;
+    size_t m_maxTiles;
+
+    // Renders so far
+    uint64_t m_renderCount;
+
+    // Counters of the last render
+    WorldMapStats m_lastStats;
+
+    // Render the pixels of a tile
+    static void renderTile(TileJob& job, uint32_t* pixels);
+
+    // Drop least recently used tiles beyond the limit, keeping those of the current render
+    void evictTiles();
+};
@@ -1,4 +1,5 @@
 #include "Window.h"
+#include "Camera.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
 
@@ -25,7 +26,8 @@ bool Window::initGLFW() {
 }
 
 Window::Window(int width, int height, const std::string& title)
-    : m_width(width), m_height(height), m_title(title), m_window(nullptr) {
+    : m_width(width), m_height(height), m_title(title), m_window(nullptr),
+      m_lastMouseX(0.0), m_lastMouseY(0.0), m_firstMouse(true), m_flyKeyDown(false) {
 }
 
 Window::~Window() {
@@ -70,6 +72,44 @@ void Window::update() {
     glfwPollEvents();
 }
 
+CameraInput Window::readCameraInput() {
+    CameraInput input;
+    input.forward = 0.0f;
+    input.strafe = 0.0f;
+    input.vertical = 0.0f;
+
+    // Movement keys
+    if (glfwGetKey(m_window, GLFW_KEY_W) == GLFW_PRESS) input.forward += 1.0f;
+    if (glfwGetKey(m_window, GLFW_KEY_S) == GLFW_PRESS) input.forward -= 1.0f;
+    if (glfwGetKey(m_window, GLFW_KEY_D) == GLFW_PRESS) input.strafe += 1.0f;
+    if (glfwGetKey(m_window, GLFW_KEY_A) == GLFW_PRESS) input.strafe -= 1.0f;
+    if (glfwGetKey(m_window, GLFW_KEY_SPACE) == GLFW_PRESS) input.vertical += 1.0f;
+    if (glfwGetKey(m_window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) input.vertical -= 1.0f;
+
+    // Fly toggle on F press
+    bool flyKeyDown = glfwGetKey(m_window, GLFW_KEY_F) == GLFW_PRESS;
+    input.toggleFlying = flyKeyDown && !m_flyKeyDown;
+    m_flyKeyDown = flyKeyDown;
+
+    // Mouse movement
+    double mouseX, mouseY;
+    glfwGetCursorPos(m_window, &mouseX, &mouseY);
+
+    if (m_firstMouse) {
+        m_lastMouseX = mouseX;
+        m_lastMouseY = mouseY;
+        m_firstMouse = false;
+    }
+
+    input.lookX = static_cast<float>(mouseX - m_lastMouseX);
+    input.lookY = static_cast<float>(m_lastMouseY - mouseY); // Reversed since y-coordinates range from bottom to top
+
+    m_lastMouseX = mouseX;
+    m_lastMouseY = mouseY;
+
+    return input;
+}
+
 void* Window::getNativeWindow() const {
 #if defined(__APPLE__)
     return (void*)glfwGetCocoaWindow(m_window);
@@ -5,6 +5,7 @@
 
 // Forward declarations
 struct GLFWwindow;
+struct CameraInput;
 
 class Window {
 public:
@@ -30,6 +31,9 @@ public:
     // Get GLFW window handle
     GLFWwindow* getGLFWWindow() const;
 
+    // Sample movement keys and mouse movement since the last call
+    CameraInput readCameraInput();
+
     // Get window dimensions
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
@@ -40,6 +44,12 @@ private:
     std::string m_title;
     GLFWwindow* m_window;
 
+    // Input sampling state
+    double m_lastMouseX;
+    double m_lastMouseY;
+    bool m_firstMouse;
+    bool m_flyKeyDown;
+
     // Initialize GLFW (static to ensure it's only done once)
     static bool initGLFW();
 }; 
\ No newline at end of file
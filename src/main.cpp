@@ -1,14 +1,80 @@
 #include "Window.h"
 #include "Camera.h"
 #include "Voxel/World.h"
+#include "Voxel/SpawnSnapshot.h"
+#include "Voxel/ChunkMesher.h"
+#include "Voxel/MeshCache.h"
 #include "Voxel/VoxelRenderer.h"
+#include "Renderer/MetalRenderBackend.h"
+#include "Physics/PhysicsWorld.h"
+#include "Core/SimulationLoop.h"
+#include "Core/TaskScheduler.h"
+#include "Core/Metrics.h"
+#include "Core/Profiler.h"
+#include "Replay/CameraRecording.h"
 
 #include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <memory>
-#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+
+// Chunks loaded around the camera in each direction
+static const int RENDER_DISTANCE = 3;
+
+// Snapshot of the generated and meshed spawn area, restored on the next start
+static const char* SPAWN_SNAPSHOT_FILE = "spawn.snapshot";
+
+// Seconds between metrics snapshots
+static const int METRICS_INTERVAL_SECONDS = 5;
 
 int main(int argc, char* argv[]) {
+    // Parse arguments
+    int tickRate = SimulationLoop::DEFAULT_TICK_RATE;
+    std::string recordFile;
+    std::string replayFile;
+    std::string profileFile;
+    std::string metricsFile;
+    std::string spawnSnapshotFile = SPAWN_SNAPSHOT_FILE;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            tickRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profileFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--spawn-snapshot") == 0 && i + 1 < argc) {
+            spawnSnapshotFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-spawn-snapshot") == 0) {
+            spawnSnapshotFile.clear();
+        }
+    }
+    
+    // Record profile zones for a Chrome trace written on exit
+    if (!profileFile.empty()) {
+        Profiler::setThreadName("Main");
+        Profiler::setEnabled(true);
+    }
+    
+    // Load the camera recording to replay, which runs at its own tick rate
+    CameraRecording replay;
+    if (!replayFile.empty()) {
+        if (!replay.load(replayFile)) {
+            std::cerr << "Failed to load recording: " << replayFile << std::endl;
+            return 1;
+        }
+        tickRate = replay.getTickRate();
+    }
+    
     // Create window
     std::unique_ptr<Window> window(new Window(800, 600, "Tomicz Engine - Voxel Game"));
     
@@ -21,11 +87,23 @@ int main(int argc, char* argv[]) {
     std::unique_ptr<Camera> camera(new Camera(70.0f, 800.0f / 600.0f, 0.1f, 1000.0f));
     camera->setPosition(glm::vec3(0.0f, 70.0f, 0.0f));
     
+    // Create worker threads shared by generation and meshing
+    std::unique_ptr<TaskScheduler> scheduler(new TaskScheduler());
+    
+    // Reuse meshes of chunk sections that did not change, e.g. when walking back into an area
+    std::unique_ptr<MeshCache> meshCache(new MeshCache());
+    ChunkMesher::setCache(meshCache.get());
+    
     // Create world
     std::unique_ptr<World> world(new World());
+    world->setTaskScheduler(scheduler.get());
+    
+    // Create physics and let the camera collide with terrain
+    std::unique_ptr<PhysicsWorld> physics(new PhysicsWorld(world.get()));
     
-    // Create voxel renderer
-    std::unique_ptr<VoxelRenderer> voxelRenderer(new VoxelRenderer(window.get()));
+    // Create voxel renderer drawing with Metal
+    std::unique_ptr<MetalRenderBackend> renderBackend(new MetalRenderBackend(window.get()));
+    std::unique_ptr<VoxelRenderer> voxelRenderer(new VoxelRenderer(renderBackend.get()));
     
     if (!voxelRenderer->init()) {
         std::cerr << "Failed to initialize voxel renderer!" << std::endl;
@@ -34,47 +112,113 @@ int main(int argc, char* argv[]) {
     
     std::cout << "Tomicz Engine initialized successfully!" << std::endl;
     
-    // Initialize chunks around player
-    world->updateChunks(camera->getPosition(), 3);
+    // Restore the starting area from the last run's snapshot, then generate whatever it did not cover
+    std::chrono::steady_clock::time_point startupStart = std::chrono::steady_clock::now();
+    ChunkPosition spawnChunk = World::worldToChunkPosition(static_cast<int>(std::floor(camera->getPosition().x)), static_cast<int>(std::floor(camera->getPosition().z)));
+    size_t restoredChunks = 0;
+    if (!spawnSnapshotFile.empty()) {
+        restoredChunks = SpawnSnapshot::load(spawnSnapshotFile, world.get(), spawnChunk, RENDER_DISTANCE, scheduler.get());
+    }
+    world->loadChunks(camera->getPosition(), RENDER_DISTANCE);
+    
+    // Camera body needs the starting chunks loaded
+    camera->setPhysics(physics.get());
+    
+    // Mesh the rest of the starting area before the first frame, and upload the restored meshes
+    voxelRenderer->updateChunkMeshes(world.get(), camera->getPosition(), std::numeric_limits<size_t>::max());
+    voxelRenderer->uploadChunkMeshes(world.get(), camera->getPosition());
     
-    // Update chunk meshes
-    voxelRenderer->updateChunkMeshes(world.get());
+    std::cout << "Starting area ready in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupStart).count()
+              << " ms (" << restoredChunks << " of " << world->getChunks().size() << " chunks from the spawn snapshot)" << std::endl;
     
-    // Set up timing
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    // Save the starting area for the next start when the snapshot was missing, stale or incomplete
+    if (!spawnSnapshotFile.empty() && restoredChunks < world->getChunks().size()) {
+        if (!SpawnSnapshot::save(spawnSnapshotFile, *world, spawnChunk, RENDER_DISTANCE)) {
+            std::cerr << "Failed to save spawn snapshot: " << spawnSnapshotFile << std::endl;
+        }
+    }
+    
+    // Run the world at a fixed tick rate on its own thread
+    std::unique_ptr<SimulationLoop> simulation(new SimulationLoop(world.get(), physics.get(), camera.get(), RENDER_DISTANCE, tickRate));
+    
+    // Record or replay the camera pose of every tick
+    CameraRecording recording(simulation->getTickRate());
+    if (!recordFile.empty()) {
+        simulation->setRecording(&recording);
+    }
+    if (!replayFile.empty()) {
+        simulation->setReplay(&replay);
+    }
+    
+    simulation->start();
+    
+    // Camera drawn from the interpolated simulation state
+    Camera renderCamera(70.0f, 800.0f / 600.0f, 0.1f, 1000.0f);
     
     // Capture mouse
     GLFWwindow* glfwWindow = window->getGLFWWindow();
     glfwSetInputMode(glfwWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     
+    // Metrics snapshots are written every few seconds
+    std::chrono::steady_clock::time_point nextMetrics = std::chrono::steady_clock::now();
+    
     // Main loop
     while (!window->shouldClose()) {
-        // Calculate delta time
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
-        lastTime = currentTime;
+        // Update window (poll events)
+        window->update();
         
-        // Update camera
-        camera->update(window->getGLFWWindow(), deltaTime);
+        // Hand input to the simulation
+        simulation->submitInput(window->readCameraInput());
         
-        // Update chunks around player
-        world->updateChunks(camera->getPosition(), 3);
+        // Follow the simulation between ticks
+        SimulationSnapshot snapshot = simulation->getInterpolatedSnapshot();
+        renderCamera.setPosition(snapshot.cameraPosition);
+        renderCamera.setRotation(snapshot.cameraYaw, snapshot.cameraPitch);
         
-        // Update chunk meshes
-        voxelRenderer->updateChunkMeshes(world.get());
+        {
+            std::lock_guard<std::mutex> lock(simulation->getWorldMutex());
+            
+            // Update chunk meshes
+            voxelRenderer->updateChunkMeshes(world.get(), renderCamera.getPosition());
+            
+            // Find what to draw
+            voxelRenderer->prepareFrame(world.get(), renderCamera);
+        }
         
-        // Render world
-        voxelRenderer->render(world.get(), *camera);
+        // Submit and present without the world lock, so ticks never wait for vsync or the GPU
+        voxelRenderer->submitFrame(renderCamera);
         
-        // Update window (poll events)
-        window->update();
+        // Write a metrics snapshot
+        if (!metricsFile.empty() && std::chrono::steady_clock::now() >= nextMetrics) {
+            Metrics::dump(metricsFile);
+            nextMetrics = std::chrono::steady_clock::now() + std::chrono::seconds(METRICS_INTERVAL_SECONDS);
+        }
         
-        // Handle escape key to exit
-        if (glfwGetKey(glfwWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        // Handle escape key to exit, replays exit when done
+        if (glfwGetKey(glfwWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS || simulation->isReplayFinished()) {
             glfwSetWindowShouldClose(glfwWindow, GLFW_TRUE);
         }
     }
     
+    simulation->stop();
+    
+    if (!recordFile.empty()) {
+        if (recording.save(recordFile)) {
+            std::cout << "Saved " << recording.getFrameCount() << " ticks to " << recordFile << std::endl;
+        } else {
+            std::cerr << "Failed to save recording: " << recordFile << std::endl;
+        }
+    }
+    
+    if (!profileFile.empty()) {
+        Profiler::setEnabled(false);
+        if (Profiler::writeChromeTrace(profileFile)) {
+            std::cout << "Wrote profile to " << profileFile << std::endl;
+        } else {
+            std::cerr << "Failed to write profile: " << profileFile << std::endl;
+        }
+    }
+    
     std::cout << "Shutting down Tomicz Engine..." << std::endl;
     
     return 0;